@@ -114,10 +114,9 @@ static void refresh_button_text(int index, bool hovering)
 
 int main(int argc, char** argv)
 {
-    TigInitInfo init_info;
+    TigInitInfo init_info = { 0 };
     init_info.texture_width = 1024;
     init_info.texture_height = 1024;
-    init_info.flags = 0;
 
     size_t cmd_line_len = 0;
     for (int i = 1; i < argc; i++) {
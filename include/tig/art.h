@@ -2,6 +2,7 @@
 #define TIG_ART_H_
 
 #include "tig/color.h"
+#include "tig/rect.h"
 #include "tig/types.h"
 
 #ifdef __cplusplus
@@ -38,6 +39,7 @@ typedef enum TigArtType {
     TIG_ART_TYPE_MONSTER,
     TIG_ART_TYPE_UNIQUE_NPC,
     TIG_ART_TYPE_EYE_CANDY,
+    TIG_ART_TYPE_COUNT,
 } TigArtType;
 
 typedef enum TigArtTileType {
@@ -286,8 +288,13 @@ typedef struct TigArtAnimData {
     int action_frame;
     int num_frames;
     unsigned int color_key;
-    void* palette1;
-    void* palette2;
+
+    // Palettes of the art (adjusted and as stored in the art file). They are
+    // shared palettes owned by the art cache (see `tig_palette_acquire`),
+    // they must not be modified and stay valid only until the art is evicted.
+    // Copy their entries into own palette to modify them.
+    const void* palette1;
+    const void* palette2;
 } TigArtAnimData;
 
 typedef struct TigArtFrameData {
@@ -297,6 +304,11 @@ typedef struct TigArtFrameData {
     /* 000C */ int hot_y;
     /* 0010 */ int offset_x;
     /* 0014 */ int offset_y;
+
+    // Bounding box of non-transparent pixels relative to the frame (as it
+    // appears on screen, that is with mirroring applied). Covers the entire
+    // frame when art cannot be loaded.
+    TigRect bounds;
 } TigArtFrameData;
 
 typedef unsigned int TigArtBlitFlags;
@@ -366,6 +378,10 @@ typedef unsigned int TigArtBlitFlags;
 
 #define TIG_ART_BLT_BLEND_COLOR_LERP 0x00020000u
 
+// Specifies `TigArtBlitInfo::scratch_video_buffer` is set.
+//
+// NOTE: Blends are applied directly to the destination video buffer, the
+// scratch buffer is no longer used. The flag is kept for compatibility.
 #define TIG_ART_BLT_SCRATCH_VALID 0x01000000u
 
 #define TIG_ART_BLT_BLEND_COLOR_ANY (TIG_ART_BLT_BLEND_COLOR_LERP \
@@ -407,6 +423,91 @@ typedef struct TigArtBlitInfo {
 
 typedef bool(TigArtBlitPaletteAdjustCallback)(tig_art_id_t art_id, TigPaletteModifyInfo* modify_info);
 
+// Allows blits of the blit list to be executed in any order, so that blits
+// of the same art are grouped together. Use it only when blits of the list
+// do not overlap, or when their order does not matter.
+#define TIG_ART_BLIT_LIST_UNORDERED 0x1u
+
+// Executes blits of the blit list in horizontal bands of the destination,
+// every band on its own thread. The result is the same as without it, but
+// every blit is clipped once per band, so it pays off on large video
+// buffers with a lot of blending.
+#define TIG_ART_BLIT_LIST_BANDED 0x2u
+
+// Art cache counters and memory usage, see `tig_art_cache_stats`.
+typedef struct TigArtCacheStats {
+    // Number of art cache lookups.
+    unsigned int lookups;
+
+    // Number of lookups answered by the most recently used entry, without
+    // searching the cache.
+    unsigned int mru_hits;
+
+    // Number of lookups which found art in the cache (including `mru_hits`
+    // and `prefetch_hits`).
+    unsigned int hits;
+
+    // Number of lookups which found art once it was prefetched.
+    unsigned int prefetch_hits;
+
+    // Number of lookups which had to load art from file.
+    unsigned int misses;
+
+    // Number of lookups for art which failed to load and is substituted with
+    // bad art.
+    unsigned int missing;
+
+    // Number of entries evicted to make room for new art.
+    unsigned int evictions;
+
+    // Number of entries loaded by prefetch threads.
+    unsigned int prefetched;
+
+    // Time spent loading art files on the main thread, in microseconds.
+    uint64_t load_time;
+
+    // Number of entries currently in the cache.
+    int entries;
+
+    int system_memory_usage;
+    int system_memory_max;
+    int video_memory_usage;
+    int video_memory_max;
+
+    // Number of atlases frame video buffers are packed into and video memory
+    // they take. Atlases are shared by art of all types, so their memory is
+    // included in `video_memory_usage`, but not in per type usage.
+    int atlases;
+    int atlas_video_memory_usage;
+
+    int entries_by_type[TIG_ART_TYPE_COUNT];
+    int system_memory_usage_by_type[TIG_ART_TYPE_COUNT];
+    int video_memory_usage_by_type[TIG_ART_TYPE_COUNT];
+} TigArtCacheStats;
+
+// Art cache entry description passed to `tig_art_cache_enumerate` callback.
+typedef struct TigArtCacheEntryInfo {
+    // Art id the entry was last accessed with.
+    tig_art_id_t art_id;
+    const char* path;
+
+    // Timestamp of the last access.
+    unsigned int time;
+
+    int system_memory_usage;
+    int video_memory_usage;
+
+    // Whether frames are kept run-length encoded (see
+    // `tig_art_cache_set_rle_enabled`).
+    bool rle;
+} TigArtCacheEntryInfo;
+
+// Signature of a callback used by `tig_art_cache_enumerate`.
+//
+// The callback should return `true` to continue enumeration, or `false` to
+// stop it.
+typedef bool(TigArtCacheEnumerateCallback)(const TigArtCacheEntryInfo* info, void* context);
+
 int tig_art_init(TigInitInfo* init_info);
 void tig_art_exit();
 void tig_art_ping();
@@ -418,6 +519,25 @@ void sub_5022B0(TigArtBlitPaletteAdjustCallback* callback);
 TigArtBlitPaletteAdjustCallback* sub_5022C0();
 void sub_5022D0();
 int tig_art_blit(TigArtBlitInfo* blit_info);
+
+// Starts recording art blits into `dst_video_buffer`. Recorded blits are
+// executed in bulk by `tig_art_blit_list_submit`, consecutive blits of the
+// same art (or all blits of the same art when `flags` has
+// `TIG_ART_BLIT_LIST_UNORDERED`) share one art cache lookup.
+int tig_art_blit_list_begin(TigVideoBuffer* dst_video_buffer, unsigned int flags);
+
+// Records art blit, destination video buffer of `blit_info` is ignored.
+// Blits which miss the destination are dropped.
+//
+// Rects and interpolated colors are copied, but the color array of
+// `TIG_ART_BLT_BLEND_COLOR_ARRAY` must stay valid until the list is
+// submitted.
+int tig_art_blit_list_add(const TigArtBlitInfo* blit_info);
+
+// Executes recorded blits and ends recording. Returns `TIG_ERR_IO` if some
+// art could not be loaded or `TIG_ERR_BLIT` if some blit failed, the rest
+// of the blits are executed anyway.
+int tig_art_blit_list_submit();
 int tig_art_type(tig_art_id_t art_id);
 unsigned int tig_art_num_get(tig_art_id_t art_id);
 tig_art_id_t tig_art_num_set(tig_art_id_t art_id, unsigned int value);
@@ -435,6 +555,14 @@ tig_art_id_t tig_art_id_palette_set(tig_art_id_t art_id, int value);
 int sub_502E00(tig_art_id_t art_id);
 int sub_502E50(tig_art_id_t art_id, int x, int y, unsigned int* color_ptr);
 int sub_502FD0(tig_art_id_t art_id, int x, int y);
+
+// Checks if the specified frame pixel is opaque (that is neither transparent
+// nor shadow). Returns `TIG_OK` if it is. Frames beyond the number of art
+// frames have no opaque pixels.
+//
+// Uses compact opacity masks which are built when art is loaded and kept after
+// it is evicted, so repeated hit tests do not need the art in the art cache.
+int tig_art_hit_test(tig_art_id_t art_id, int x, int y);
 int tig_art_anim_data(tig_art_id_t art_id, TigArtAnimData* data);
 int tig_art_frame_data(tig_art_id_t art_id, TigArtFrameData* data);
 int sub_503340(tig_art_id_t art_id, uint8_t* dst, int pitch);
@@ -519,6 +647,40 @@ tig_art_id_t tig_art_eye_candy_id_scale_set(tig_art_id_t art_id, int value);
 int tig_art_id_flags_get(tig_art_id_t art_id);
 void sub_505000(tig_art_id_t art_id, TigPalette src_palette, TigPalette dst_palette);
 void tig_art_cache_set_video_memory_fullness(int fullness);
+
+// Keeps frames of the specified art type run-length encoded in the art cache
+// (applies to art loaded afterwards). This saves memory for mostly
+// transparent art and speeds up blended blits, at the expense of slower
+// pixel access.
+void tig_art_cache_set_rle_enabled(int type, bool enabled);
+
+// Makes art blits resolve 8-bpp frames through the art palette at draw time
+// instead of baking every palette and rotation into video buffers. Palette
+// changes (see `sub_5022D0`) then only update palettes, which makes
+// frequent global palette changes cheap. Has no effect in 3D mode, which
+// requires textures.
+void tig_art_cache_set_palette_indirect(bool enabled);
+
+// Starts loading the specified art in the background, so that it is already
+// in the art cache when it is needed. Art which is already cached or being
+// loaded is skipped. Loaded art is added to the cache by `tig_art_ping` (or
+// on first use).
+int tig_art_prefetch(const tig_art_id_t* ids, int count);
+
+// Returns number of prefetched art which is not yet in the art cache.
+int tig_art_prefetch_pending();
+
+// Retrieves art cache counters (accumulated since `tig_art_init` or the last
+// `tig_art_cache_reset_stats`) and current memory usage.
+void tig_art_cache_stats(TigArtCacheStats* stats);
+
+// Resets art cache counters.
+void tig_art_cache_reset_stats();
+
+// Calls the callback for every art cache entry, from the most recently used
+// to the least recently used one. Returns `false` if enumeration was stopped
+// by the callback.
+bool tig_art_cache_enumerate(TigArtCacheEnumerateCallback* callback, void* context);
 tig_art_id_t tig_art_id_reset(tig_art_id_t art_id);
 
 #ifdef __cplusplus
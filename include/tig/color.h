@@ -67,12 +67,20 @@ int sub_52C540(tig_color_t color);
 unsigned int tig_color_index_of(tig_color_t color);
 unsigned int tig_color_to_24_bpp(int red, int green, int blue);
 
+// Batch versions of blending operators below, `dst[i]` is replaced with the
+// result of blending `src[i]` into it. Vectorized when supported by CPU and
+// current video mode, results are identical to scalar versions.
+void tig_color_add_n(tig_color_t* dst, const tig_color_t* src, int n);
+void tig_color_sub_n(tig_color_t* dst, const tig_color_t* src, int n);
+void tig_color_mul_n(tig_color_t* dst, const tig_color_t* src, int n);
+void tig_color_blend_alpha_n(tig_color_t* dst, const tig_color_t* src, int alpha, int n);
+
 // Creates platform-specific color from RGB components (0-255).
 static inline tig_color_t tig_color_make(int red, int green, int blue)
 {
-    return (tig_color_red_rgb_to_platform_table[red] << tig_color_red_shift)
-        | (tig_color_green_rgb_to_platform_table[green] << tig_color_green_shift)
-        | (tig_color_blue_rgb_to_platform_table[blue] << tig_color_blue_shift);
+    return ((unsigned int)tig_color_red_rgb_to_platform_table[red] << tig_color_red_shift)
+        | ((unsigned int)tig_color_green_rgb_to_platform_table[green] << tig_color_green_shift)
+        | ((unsigned int)tig_color_blue_rgb_to_platform_table[blue] << tig_color_blue_shift);
 }
 
 static inline unsigned int tig_color_16_to_32(uint32_t color)
@@ -97,9 +105,9 @@ static inline tig_color_t tig_color_mul(tig_color_t src, tig_color_t dst)
     unsigned int g2 = (dst & tig_color_green_mask) >> tig_color_green_shift;
     unsigned int b2 = (dst & tig_color_blue_mask) >> tig_color_blue_shift;
 
-    return (tig_color_red_mult_table[(tig_color_red_range + 1) * r1 + r2] << tig_color_red_shift)
-        | (tig_color_green_mult_table[(tig_color_green_range + 1) * g1 + g2] << tig_color_green_shift)
-        | (tig_color_blue_mult_table[(tig_color_blue_range + 1) * b1 + b2] << tig_color_blue_shift);
+    return ((unsigned int)tig_color_red_mult_table[(tig_color_red_range + 1) * r1 + r2] << tig_color_red_shift)
+        | ((unsigned int)tig_color_green_mult_table[(tig_color_green_range + 1) * g1 + g2] << tig_color_green_shift)
+        | ((unsigned int)tig_color_blue_mult_table[(tig_color_blue_range + 1) * b1 + b2] << tig_color_blue_shift);
 }
 
 // Sum the components of two platform-specific colors.
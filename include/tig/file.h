@@ -47,6 +47,7 @@ bool tig_file_repository_add(const char* path);
 bool tig_file_repository_remove(const char* path);
 bool tig_file_repository_remove_all();
 bool tig_file_repository_guid(const char* path, TigGuid* guid);
+unsigned int tig_file_repository_version();
 int tig_file_mkdir_ex(const char* path);
 int tig_file_rmdir_ex(const char* path);
 bool tig_file_extract(const char* filename, char* path);
@@ -57,6 +57,22 @@ void tig_palette_copy(TigPalette dst, const TigPalette src);
 // `src_palette` is copied into `dst_palette`.
 void tig_palette_modify(const TigPaletteModifyInfo* modify_info);
 
+// Returns shared palette with the same entries as `palette`.
+//
+// Shared palettes are reference counted, every call must be balanced with
+// `tig_palette_release`. Their entries must not be modified.
+TigPalette tig_palette_acquire(const TigPalette palette);
+
+// Returns shared palette with 256 RGB colors (as stored in art files)
+// converted to the current video mode. Identical colors are converted only
+// once.
+//
+// See `tig_palette_acquire` for details on shared palettes.
+TigPalette tig_palette_acquire_rgb(const uint32_t* colors);
+
+// Releases reference to the shared palette.
+void tig_palette_release(TigPalette palette);
+
 // Returns amount of system memory required for palette (including overhead).
 //
 // This value is used to calculate system memory usage in art cache.
@@ -21,6 +21,29 @@ typedef struct TigRectListNode {
     /* 0010 */ struct TigRectListNode* next;
 } TigRectListNode;
 
+// Maximum number of rects in `TigDirtyRects`, the whole bounds become dirty
+// when there are more.
+#define TIG_DIRTY_RECTS_MAX 32
+
+// Dirty areas within bounds, kept as a set of disjoint rects (see
+// `tig_dirty_rects_add`).
+typedef struct TigDirtyRects {
+    TigRect bounds;
+
+    // Dirty area (in percents of the bounds area) above which the whole
+    // bounds become dirty.
+    int full_coverage;
+
+    TigRect rects[TIG_DIRTY_RECTS_MAX];
+    int count;
+
+    // Sum of areas of `rects`.
+    int area;
+
+    // Set when the whole bounds are dirty, `rects` are irrelevant then.
+    bool full;
+} TigDirtyRects;
+
 // A 2D line whose coordinates are specified using points.
 typedef struct TigLine {
     /* 0000 */ int x1;
@@ -71,6 +94,18 @@ void sub_52D480(TigRectListNode** node_ptr, TigRect* rect);
 // Returns `TIG_OK` (its always possible to compute a union)
 int tig_rect_union(const TigRect* a, const TigRect* b, TigRect* r);
 
+// Initializes empty `TigDirtyRects` with the specified bounds and coverage
+// threshold (see `TigDirtyRects::full_coverage`).
+void tig_dirty_rects_init(TigDirtyRects* dirty_rects, const TigRect* bounds, int full_coverage);
+
+// Marks rect as dirty, `NULL` marks the whole bounds. The rect is clipped to
+// the bounds and merged with every dirty rect it overlaps (as well as rects
+// the merged rect overlaps in turn), so that dirty rects never overlap.
+void tig_dirty_rects_add(TigDirtyRects* dirty_rects, const TigRect* rect);
+
+// Marks everything clean.
+void tig_dirty_rects_clear(TigDirtyRects* dirty_rects);
+
 // Computes an intersection of a rectangle and a line.
 //
 // NOTE: I'm not really sure about this function, it's implementation is a
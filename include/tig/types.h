@@ -128,6 +128,18 @@ typedef struct TigInitInfo {
     unsigned int texture_width;
     unsigned int texture_height;
     const char* window_name;
+
+    // Optional memory budgets of art types in the art cache (indexed by
+    // `TIG_ART_TYPE_*`), in percents of the art cache memory. When art of a
+    // type exceeds its budget, only art of that type is evicted. Zero means
+    // the type is only limited by the art cache memory. Every budget must be
+    // in 0-100 range and their sum must not exceed 100.
+    const int* art_cache_budgets;
+
+    // Optional size of the art cache memory in bytes (applies to both system
+    // and video memory), at most a quarter of system memory. Zero means a
+    // quarter of system memory.
+    unsigned int art_cache_size;
 } TigInitInfo;
 
 #ifdef __cplusplus
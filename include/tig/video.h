@@ -33,19 +33,63 @@ typedef unsigned int TigVideoBufferFlags;
 
 typedef unsigned int TigVideoBufferBlitFlags;
 
+// Mirrors source video buffer before `TigVideoBufferBlitInfo::src_rect` is
+// applied (that is the source rect is relative to the mirrored buffer, like
+// in art blits).
 #define TIG_VIDEO_BUFFER_BLIT_FLIP_X 0x0001
 #define TIG_VIDEO_BUFFER_BLIT_FLIP_Y 0x0002
+
+// Sum the components of source and destination.
 #define TIG_VIDEO_BUFFER_BLIT_BLEND_ADD 0x0004
+
+// Subtract the components of source from destination.
+#define TIG_VIDEO_BUFFER_BLIT_BLEND_SUB 0x0008
+
+// Multiply the components of source and destination.
 #define TIG_VIDEO_BUFFER_BLIT_BLEND_MUL 0x0010
+
+// Blends source with destination using grayscale of source as alpha.
 #define TIG_VIDEO_BUFFER_BLIT_BLEND_ALPHA_AVG 0x0020
+
+// Blends source with destination using `TigVideoBufferBlitInfo::alpha[0]`.
 #define TIG_VIDEO_BUFFER_BLIT_BLEND_ALPHA_CONST 0x0040
+
+// Blends source with destination using alpha of source (see
+// `tig_color_alpha`).
 #define TIG_VIDEO_BUFFER_BLIT_BLEND_ALPHA_SRC 0x0080
+
+// Blends source with destination using alpha interpolated across destination
+// rect between its corners:
+//
+//  - `TigVideoBufferBlitInfo::alpha[0]` - top-left corner alpha,
+//  - `TigVideoBufferBlitInfo::alpha[1]` - top-right corner alpha,
+//  - `TigVideoBufferBlitInfo::alpha[2]` - bottom-right corner alpha,
+//  - `TigVideoBufferBlitInfo::alpha[3]` - bottom-left corner alpha.
 #define TIG_VIDEO_BUFFER_BLIT_BLEND_ALPHA_LERP 0x0100
+
+// Multiplies source by `TigVideoBufferBlitInfo::field_10` color before
+// blending. Combined with `TIG_VIDEO_BUFFER_BLIT_BLEND_ALPHA_SRC` the color
+// replaces source, only its alpha is used.
 #define TIG_VIDEO_BUFFER_BLIT_BLEND_COLOR_CONST 0x0200
+
+// NOTE: Not supported, `tig_video_buffer_blit` fails with this flag.
 #define TIG_VIDEO_BUFFER_BLIT_BLEND_COLOR_LERP 0x0400
 
+// Use bilinear filtering when source is stretched (otherwise the nearest
+// pixel is used). Ignored when source has color key.
+#define TIG_VIDEO_BUFFER_BLIT_SCALE_LINEAR 0x0800
+
 #define TIG_VIDEO_BUFFER_BLIT_FLIP_ANY (TIG_VIDEO_BUFFER_BLIT_FLIP_X | TIG_VIDEO_BUFFER_BLIT_FLIP_Y)
 
+#define TIG_VIDEO_BUFFER_BLIT_BLEND_ANY (TIG_VIDEO_BUFFER_BLIT_BLEND_ADD \
+    | TIG_VIDEO_BUFFER_BLIT_BLEND_SUB                                    \
+    | TIG_VIDEO_BUFFER_BLIT_BLEND_MUL                                    \
+    | TIG_VIDEO_BUFFER_BLIT_BLEND_ALPHA_AVG                              \
+    | TIG_VIDEO_BUFFER_BLIT_BLEND_ALPHA_CONST                            \
+    | TIG_VIDEO_BUFFER_BLIT_BLEND_ALPHA_SRC                              \
+    | TIG_VIDEO_BUFFER_BLIT_BLEND_ALPHA_LERP                             \
+    | TIG_VIDEO_BUFFER_BLIT_BLEND_COLOR_CONST)
+
 // Opaque handle.
 typedef struct TigVideoBuffer TigVideoBuffer;
 
@@ -114,6 +158,13 @@ int tig_video_renderer_get(SDL_Renderer** renderer_ptr);
 void tig_video_display_fps();
 int tig_video_blit(TigVideoBuffer* src_video_buffer, TigRect* src_rect, TigRect* dst_rect);
 int tig_video_fill(const TigRect* rect, tig_color_t color);
+
+// Marks area of the screen to be uploaded to the texture on the next
+// `tig_video_flip`, `NULL` marks the whole screen. `tig_video_blit` and
+// `tig_video_fill` do it on their own, this is only needed when the texture
+// loses its content.
+void tig_video_invalidate(const TigRect* rect);
+
 int tig_video_flip();
 int tig_video_screenshot_set_settings(TigVideoScreenshotSettings* settings);
 int tig_video_screenshot_make();
@@ -127,6 +178,7 @@ int tig_video_check_gamma_control();
 int tig_video_fade(tig_color_t color, int steps, float duration, TigFadeFlags flags);
 int tig_video_set_gamma(float gamma);
 int tig_video_buffer_create(TigVideoBufferCreateInfo* vb_create_info, TigVideoBuffer** video_buffer);
+int tig_video_buffer_create_view(TigVideoBufferCreateInfo* vb_create_info, TigVideoBuffer* parent, int x, int y, TigVideoBuffer** video_buffer_ptr);
 int tig_video_buffer_destroy(TigVideoBuffer* video_buffer);
 int tig_video_buffer_data(TigVideoBuffer* video_buffer, TigVideoBufferData* video_buffer_data);
 int tig_video_buffer_set_color_key(TigVideoBuffer* video_buffer, int color_key);
@@ -135,8 +187,16 @@ int tig_video_buffer_unlock(TigVideoBuffer* video_buffer);
 int tig_video_buffer_outline(TigVideoBuffer* video_buffer, TigRect* rect, int color);
 int tig_video_buffer_fill(TigVideoBuffer* video_buffer, TigRect* rect, int color);
 int tig_video_buffer_line(TigVideoBuffer* video_buffer, TigLine* line, TigRect* a3, unsigned int color);
+
+// Checks if `tig_video_buffer_blit` into `video_buffer` supports blit
+// `flags`.
 int sub_520FB0(TigVideoBuffer* video_buffer, unsigned int flags);
+
+// Blits source video buffer into destination video buffer. Unblended blits
+// are done by SDL, blended, flipped and linearly scaled blits are done by
+// batch color operators (see `tig_color_add_n`).
 int tig_video_buffer_blit(TigVideoBufferBlitInfo* blit_info);
+
 int tig_video_buffer_get_pixel_color(TigVideoBuffer* video_buffer, int x, int y, unsigned int* color);
 int tig_video_buffer_tint(TigVideoBuffer* video_buffer, TigRect* rect, tig_color_t tint_color, TigVideoBufferTintMode mode);
 int tig_video_buffer_save_to_bmp(TigVideoBufferSaveToBmpInfo* save_info);
@@ -13,6 +13,8 @@
 #include "tig/timer.h"
 #include "tig/video.h"
 
+#include "fixed.h"
+
 #define ART_ID_TYPE_SHIFT 28
 #define ART_ID_PALETTE_SHIFT 4
 #define ART_ID_ROTATION_SHIFT 11
@@ -141,8 +143,30 @@ typedef struct TigArtHeader {
     /* 0064 */ uint8_t* pixels_tbl[MAX_ROTATIONS];
 } TigArtHeader;
 
+// Opacity mask of a frame, a bit is set for pixels with palette index 2 and
+// above (0 is transparent and 1 is shadow, which are not considered for hit
+// testing).
+typedef struct TigArtFrameMask {
+    // Bounding box of opaque pixels, empty if frame is fully transparent.
+    TigRect bounds;
+
+    // Bits of `bounds` rows, each row takes `stride` bytes.
+    int stride;
+    uint8_t* bits;
+} TigArtFrameMask;
+
+#define TIG_ART_CACHE_ENTRY_LOADED 0x01
 #define TIG_ART_CACHE_ENTRY_MODIFIED 0x02
 
+// Denotes cache entry frames are stored in run-length representation (see
+// `art_runs_encode`) rather than plain 8-bpp pixels.
+#define TIG_ART_CACHE_ENTRY_RLE 0x04
+
+// Denotes cache entry which is referred to by blits collected for bands (see
+// `tig_art_blit_list_submit_banded`) and must not be evicted until they are
+// done.
+#define TIG_ART_CACHE_ENTRY_PINNED 0x08
+
 typedef struct TigArtCacheEntry {
     /* 0000 */ unsigned int flags;
     /* 0004 */ char path[TIG_MAX_PATH];
@@ -155,25 +179,352 @@ typedef struct TigArtCacheEntry {
     /* 0254 */ TigPalette palette_tbl[MAX_PALETTES];
     /* 0264 */ art_size_t system_memory_usage;
     /* 0268 */ art_size_t video_memory_usage;
+
+    // Art cache key (see `tig_art_cache_key`) this entry is indexed by in
+    // `tig_art_cache_buckets`.
+    tig_art_id_t key;
+
+    // Links in the LRU list of loaded entries (`prev` is towards the most
+    // recently used). When entry is not loaded `next` links free entries.
+    int prev;
+    int next;
+
+    // Opaque spans of every frame row (see `art_runs_encode`), available
+    // when frames are not run-length encoded.
+    uint8_t** spans_tbl[MAX_ROTATIONS];
+
+    // Bounding box of non-transparent pixels of every frame (see
+    // `tig_art_cache_entry_build_bounds`).
+    TigRect* bounds_tbl[MAX_ROTATIONS];
+
+    // Atlas placement of every frame video buffer (see
+    // `art_video_buffer_create`), allocated along with `video_buffers`.
+    struct TigArtAtlasSlot* atlas_slots[MAX_PALETTES][MAX_ROTATIONS];
+
+    // Whether palettes map opaque pixels to the color key of frame video
+    // buffers (see `art_palette_color_keyed`).
+    uint8_t color_keyed[MAX_PALETTES];
 } TigArtCacheEntry;
 
+// Values of `TigArtCacheEntry::color_keyed`.
+#define TIG_ART_PALETTE_UNCHECKED 0
+#define TIG_ART_PALETTE_UNKEYED 1
+#define TIG_ART_PALETTE_KEYED 2
+
+// Sentinel denoting empty bucket in `tig_art_cache_buckets` and the end of
+// the LRU and free entries lists.
+#define TIG_ART_CACHE_NONE -1
+
+// Art requested with `tig_art_prefetch`, loaded by a worker thread into
+// `entry` (except for palettes, which are created by the main thread).
+typedef struct TigArtPrefetchJob {
+    tig_art_id_t art_id;
+    tig_art_id_t key;
+    char path[TIG_MAX_PATH];
+
+    // Value of `tig_art_prefetch_generation` when the job was queued. Jobs
+    // queued before the cache was flushed are discarded.
+    unsigned int generation;
+
+    bool loaded;
+    TigArtCacheEntry entry;
+    struct TigArtPrefetchJob* next;
+} TigArtPrefetchJob;
+
+#define TIG_ART_PREFETCH_MAX_THREADS 4
+
+// Header and frames table of art which pixels are not necessarily loaded,
+// used to answer queries about art geometry (see `tig_art_meta_hdr`). Only
+// `flags`, `fps`, `action_frame`, `num_frames` and `frames_tbl` of `hdr` are
+// set, frames of all rotations share one allocation.
+typedef struct TigArtMetaEntry {
+    tig_art_id_t key;
+    TigArtHeader hdr;
+
+    // Bounding box of non-transparent pixels of every frame (see
+    // `art_frame_bounds`), bounds of all rotations share one allocation
+    // (`bounds`) the same way frames do.
+    TigRect* bounds_tbl[MAX_ROTATIONS];
+    TigRect* bounds;
+
+    // Opacity masks of every frame (see `art_frame_mask_build`) laid out the
+    // same way as bounds, their bits share one allocation (`masks_bits`).
+    TigArtFrameMask* masks_tbl[MAX_ROTATIONS];
+    TigArtFrameMask* masks;
+    uint8_t* masks_bits;
+
+    // Links in the LRU list of metadata entries.
+    int prev;
+    int next;
+} TigArtMetaEntry;
+
+// Cache key of bad art substituting missing art of the same type as
+// `art_id`.
+#define TIG_ART_BAD_ART_KEY(art_id) ((tig_art_id_t)((art_id) | ((1u << ART_ID_TYPE_SHIFT) - 1)))
+
+// Number of slots in `tig_art_missing_slots`.
+#define TIG_ART_MISSING_CAPACITY 256
+
+// Slot of missing art table. Every key (including `TIG_ART_ID_INVALID` and
+// bad art keys) is a valid art id, so empty slots are marked separately.
+typedef struct TigArtMissingSlot {
+    tig_art_id_t key;
+    bool occupied;
+} TigArtMissingSlot;
+
+// Maximum number of metadata entries, the least recently used entry is
+// replaced when all are taken.
+#define TIG_ART_META_CAPACITY 4096
+
+// Art blit recorded by `tig_art_blit_list_add`. Pointers of `blit_info`
+// are set to the copies below right before the blit is executed, since
+// items are moved when the list grows or is sorted.
+typedef struct TigArtBlitListItem {
+    TigArtBlitInfo blit_info;
+    TigRect src_rect;
+    TigRect dst_rect;
+    TigRect field_18;
+    uint32_t field_14[4];
+
+    // Art cache key of the art (see `tig_art_cache_key`).
+    tig_art_id_t key;
+
+    // Position of the blit in the list when it was recorded.
+    int order;
+
+    // Art cache entry of banded blit (see `tig_art_blit_list_submit_banded`),
+    // `TIG_ART_CACHE_NONE` if the blit is already done or failed.
+    int cache_entry_index;
+} TigArtBlitListItem;
+
+// Buffers `art_blit_rows` needs for the duration of one blit. The main thread
+// uses `tig_art_scratch`, every band worker has its own.
+typedef struct TigArtScratch {
+    // Frame expanded from run-length representation (see
+    // `art_frame_pixels`).
+    uint8_t* rle;
+    int rle_size;
+
+    // Per-column and per-row source steps of stretched blit (see
+    // `art_blit_stretch_steps`).
+    int* stretch_steps;
+    int stretch_steps_size;
+} TigArtScratch;
+
+// Maximum number of band worker threads, the calling thread blits one more
+// band (see `tig_art_blit_list_submit_banded`).
+#define TIG_ART_BAND_MAX_THREADS 15
+
+// Bands are not made smaller than this number of rows, so that per-blit
+// overhead does not outweigh the gain on small video buffers.
+#define TIG_ART_BAND_MIN_HEIGHT 32
+
+// Width and height of atlases (see `TigArtAtlas`).
+#define TIG_ART_ATLAS_SIZE 1024
+
+// Frames larger than this in either dimension get video buffers of their
+// own rather than being packed into atlas.
+#define TIG_ART_ATLAS_MAX_FRAME_SIZE 256
+
+// Sentinel of `TigArtAtlasSlot::atlas` denoting frame video buffer which is
+// not packed into atlas.
+#define TIG_ART_ATLAS_NONE -1
+
+// Horizontal strip of atlas, frames are placed on it left to right.
+typedef struct TigArtAtlasShelf {
+    int y;
+    int height;
+
+    // Width taken by frames placed on the shelf, space of freed frames is
+    // reclaimed only when the entire shelf is free.
+    int width;
+
+    // Number of frames on the shelf which are not freed yet.
+    int frames;
+} TigArtAtlasShelf;
+
+// Large video buffer which frame video buffers of cached art are packed into
+// (shelf packing), so that frames do not need separate pixel allocations.
+// Frame video buffers are views of `video_buffer` (see
+// `tig_video_buffer_create_view`).
+typedef struct TigArtAtlas {
+    // Video buffer creation flags of frames packed into this atlas. Atlas
+    // with `NULL` video buffer is unused.
+    unsigned int flags;
+    TigVideoBuffer* video_buffer;
+
+    // Shelves ordered by `y`, they cover top `height` rows without gaps.
+    TigArtAtlasShelf* shelves;
+    int shelves_count;
+    int shelves_capacity;
+    int height;
+
+    // Number of frames in the atlas which are not freed yet.
+    int frames;
+} TigArtAtlas;
+
+// Placement of frame video buffer in atlas. Shelves are identified by `y`
+// which stays the same while the shelf has frames.
+typedef struct TigArtAtlasSlot {
+    int atlas;
+    int y;
+} TigArtAtlasSlot;
+
+typedef void(ArtBlitSpanCopyFunc)(const uint8_t* src, int cnt, uint32_t* dst, int dst_step, const uint32_t* plt);
+
+// Source color modulation of blit (see `art_blit_mode`).
+#define ART_BLIT_COLOR_NONE 0
+#define ART_BLIT_COLOR_CONST 1
+#define ART_BLIT_COLOR_ARRAY 2
+#define ART_BLIT_COLOR_LERP 3
+#define ART_BLIT_COLOR_COUNT 4
+
+// Operation applied to (modulated) source color and destination color of
+// blit (see `art_blit_mode`).
+#define ART_BLIT_OP_COPY 0
+#define ART_BLIT_OP_ADD 1
+#define ART_BLIT_OP_SUB 2
+#define ART_BLIT_OP_MUL 3
+#define ART_BLIT_OP_ALPHA_AVG 4
+#define ART_BLIT_OP_ALPHA_CONST 5
+#define ART_BLIT_OP_ALPHA_SRC 6
+#define ART_BLIT_OP_ALPHA_LERP 7
+#define ART_BLIT_OP_STIPPLE_S 8
+#define ART_BLIT_OP_STIPPLE_D 9
+#define ART_BLIT_OP_COUNT 10
+
+// Parameters of per-pixel blit kernel, prepared by `art_blit`.
+typedef struct ArtBlitKernelArgs {
+    TigArtBlitInfo* blit_info;
+    const uint32_t* plt;
+
+    // Position of the first source pixel and how the source is walked (see
+    // flipping in `art_blit`).
+    uint8_t* src_pixels;
+    int src_pitch;
+    int src_step;
+
+    uint8_t* dst_pixels;
+    int dst_skip;
+
+    TigRect src_rect;
+    TigRect dst_rect;
+
+    // Rows of `dst_rect` to write (see `art_blit_rows`), `max_row` is
+    // exclusive.
+    int min_row;
+    int max_row;
+
+    // Source steps after every destination column and row, only set for
+    // stretched blits (see `art_blit_stretch_steps`).
+    int* col_steps;
+    int* row_steps;
+
+    // Alpha of the first row ends and their vertical steps, only set for
+    // `ART_BLIT_OP_ALPHA_LERP`.
+    float start_alpha;
+    float end_alpha;
+    float start_alpha_vertical_step;
+    float end_alpha_vertical_step;
+} ArtBlitKernelArgs;
+
+typedef void(ArtBlitKernel)(ArtBlitKernelArgs* args);
+
 static int art_get_video_buffer(int cache_entry_index, tig_art_id_t art_id, TigVideoBuffer** video_buffer_ptr);
 static int sub_505940(unsigned int art_blt_flags, unsigned int* vb_blt_flags_ptr);
 static int sub_5059F0(int cache_entry_index, TigArtBlitInfo* blit_info);
+static int art_blit_cached(int cache_entry_index, TigArtBlitInfo* blit_info);
+static void art_blit_adjust(TigArtBlitInfo* blit_info);
+static bool art_blit_video_buffer_get(int cache_entry_index, TigArtBlitInfo* blit_info, TigVideoBuffer** video_buffer_ptr, unsigned int* vb_flags_ptr);
+static bool art_palette_color_keyed(int cache_entry_index, int palette);
+static int art_blit_video_buffer(TigArtBlitInfo* blit_info, TigVideoBuffer* video_buffer, unsigned int vb_flags);
+static int art_blit_list_compare(const void* a, const void* b);
+static int tig_art_blit_list_submit_banded();
+static bool tig_art_band_start();
+static void tig_art_band_stop();
+static int SDLCALL tig_art_band_worker(void* userdata);
+static void tig_art_band_run(int start, int end);
+static void tig_art_band_blit(int band, TigArtScratch* scratch);
+static void tig_art_scratch_free(TigArtScratch* scratch);
 static int art_blit(int cache_entry_index, TigArtBlitInfo* blit_info);
+static void art_blit_rows(int cache_entry_index, TigArtBlitInfo* blit_info, TigVideoBufferData* video_buffer_data, int min_y, int max_y, TigArtScratch* scratch);
+static bool art_blit_spans(uint8_t* runs, uint8_t* pixels, int width, int height, TigRect* src_rect, TigRect* dst_rect, int min_row, int max_row, unsigned int flip, TigPalette plt, uint8_t* dst_pixels, int dst_pitch, TigArtBlitInfo* blit_info);
+static void art_blit_stretch_steps(int width_ratio, int width, int height_ratio, int height, TigArtScratch* scratch, int** col_steps_ptr, int** row_steps_ptr);
+static void art_blit_mode(unsigned int flags, int* color_ptr, int* op_ptr);
+static ArtBlitKernel* art_blit_kernel_find(bool stretched, int color, int op);
+static void art_blit_kernel_color_lerp(ArtBlitKernelArgs* args);
+static void art_blit_span(int op, const uint8_t* src, int cnt, uint32_t* dst, int dst_step, const uint32_t* plt, TigArtBlitInfo* blit_info);
+static void art_blit_span_copy(const uint8_t* src, int cnt, uint32_t* dst, int dst_step, const uint32_t* plt);
+#ifdef SDL_AVX2_INTRINSICS
+static void art_blit_span_copy_avx2(const uint8_t* src, int cnt, uint32_t* dst, int dst_step, const uint32_t* plt);
+#endif
 static int sub_51AA90(tig_art_id_t art_id);
 static void tig_art_cache_check_fullness();
-static int tig_art_cache_entry_compare_time(const void* a1, const void* a2);
-static int tig_art_cache_entry_compare_name(const void* a1, const void* a2);
+static void tig_art_cache_check_budgets();
+static void tig_art_cache_entry_account(int cache_entry_index, art_size_t system_memory_size, art_size_t video_memory_size);
 static int tig_art_build_path(unsigned int art_id, char* path);
-static bool tig_art_cache_find(const char* path, int* index);
+static tig_art_id_t tig_art_cache_key(tig_art_id_t art_id);
+static unsigned int tig_art_cache_hash(tig_art_id_t key);
+static bool tig_art_cache_find(tig_art_id_t key, int* index);
+static void tig_art_cache_buckets_insert(int cache_entry_index);
+static void tig_art_cache_buckets_remove(int cache_entry_index);
+static void tig_art_cache_buckets_reset(int capacity);
+static int tig_art_cache_entry_alloc();
+static void tig_art_cache_entry_free(int cache_entry_index);
+static void tig_art_cache_lru_link(int cache_entry_index);
+static void tig_art_cache_lru_unlink(int cache_entry_index);
+static void tig_art_cache_entry_compress(TigArtCacheEntry* art, int start, int num_rotations);
+static void tig_art_cache_entry_build_spans(TigArtCacheEntry* art, int start, int num_rotations);
+static void tig_art_cache_entry_build_bounds(TigArtCacheEntry* art, int start, int num_rotations);
+static void art_frame_mask_build(const uint8_t* pixels, int width, int height, TigArtFrameMask* mask, uint8_t** bits_ptr, size_t* size_ptr);
+static void art_frame_bounds(const uint8_t* pixels, int width, int height, TigRect* bounds);
+static bool tig_art_frame_bounds(tig_art_id_t art_id, int rotation, int frame, TigRect* bounds);
+static int art_runs_encode(const uint8_t* src, int width, int height, bool inline_pixels, uint8_t* dst);
+static void art_rle_decode(const uint8_t* rle, int width, int height, uint8_t* dst);
+static uint8_t* art_frame_pixels(TigArtCacheEntry* art, int rotation, int frame, TigArtScratch* scratch);
+static uint8_t art_frame_pixel(TigArtCacheEntry* art, int rotation, int frame, int x, int y);
 static bool tig_art_cache_entry_load(tig_art_id_t art_id, const char* path, int index);
+static bool tig_art_cache_entry_read(tig_art_id_t art_id, const char* path, TigArtCacheEntry* art, bool defer_palettes);
+static void tig_art_cache_entry_create_palettes(tig_art_id_t art_id, TigArtCacheEntry* art);
+static void tig_art_cache_entry_free_frames(TigArtCacheEntry* art);
 static void tig_art_cache_entry_unload(int cache_entry_index);
+static TigArtHeader* tig_art_meta_hdr(tig_art_id_t art_id);
+static int tig_art_meta_load(tig_art_id_t art_id);
+static bool tig_art_meta_read(const char* path, TigArtHeader* hdr, TigRect** bounds_ptr, TigArtFrameMask** masks_ptr, uint8_t** masks_bits_ptr);
+static void tig_art_meta_reserve();
+static int tig_art_meta_insert(tig_art_id_t key, TigArtHeader* hdr, TigRect* bounds, TigArtFrameMask* masks, uint8_t* masks_bits);
+static void tig_art_meta_free(int index);
+static bool tig_art_meta_find(tig_art_id_t key, int* index);
+static void tig_art_meta_buckets_insert(int index);
+static void tig_art_meta_buckets_remove(int index);
+static void tig_art_meta_lru_link(int index);
+static void tig_art_meta_lru_unlink(int index);
+static void tig_art_meta_flush();
+static bool tig_art_missing_find(tig_art_id_t key);
+static void tig_art_missing_add(tig_art_id_t key);
+static bool tig_art_prefetch_start();
+static void tig_art_prefetch_stop();
+static int SDLCALL tig_art_prefetch_worker(void* userdata);
+static bool tig_art_prefetch_find(tig_art_id_t key);
+static void tig_art_prefetch_publish();
+static bool tig_art_prefetch_sync(tig_art_id_t key);
+static void tig_art_prefetch_discard(TigArtPrefetchJob* job);
 static void art_invalidate(int cache_entry_index);
+static void art_release_video_buffers(int cache_entry_index);
 static void sub_51B650(int cache_entry_index);
+static int art_video_buffer_create(TigVideoBufferCreateInfo* vb_create_info, TigVideoBuffer** video_buffer_ptr, TigArtAtlasSlot* slot);
+static void art_video_buffer_destroy(TigVideoBuffer* video_buffer, TigArtAtlasSlot* slot);
+static bool tig_art_atlas_alloc(unsigned int flags, int width, int height, int* atlas_ptr, int* x_ptr, int* y_ptr);
+static void tig_art_atlas_free(int atlas_index, int y);
+static int tig_art_atlas_shelf_find(TigArtAtlas* atlas, int y);
+static void tig_art_atlas_shelf_insert(TigArtAtlas* atlas, int index, int y, int height);
+static void tig_art_atlas_shelf_remove(TigArtAtlas* atlas, int index);
+static void tig_art_atlas_destroy(TigArtAtlas* atlas);
 static int sub_51B710(tig_art_id_t art_id, const char* filename, TigArtHeader* hdr, void** palettes, int a5, art_size_t* size_ptr);
 static int sub_51BE30(TigArtHeader* hdr);
 static void sub_51BE50(TigFile* stream, TigArtHeader* hdr, TigPalette* palette_tbl);
+static TigPalette art_palette_adjust(tig_art_id_t art_id, TigPalette src_palette);
+static bool art_read_rle_decode(const uint8_t* src, int src_size, uint8_t* dst, int dst_size);
 static void sub_51BF20(TigArtHeader* hdr);
 static bool art_read_header(TigArtHeader* hdr, TigFile* stream);
 
@@ -368,19 +719,193 @@ static TigArtIdResetFunc* tig_art_id_reset_func;
 // 0x604754
 static int dword_604754;
 
+// Open-addressing hash index of loaded cache entries keyed by art cache key
+// (see `tig_art_cache_key`, which strips frame, palette and rotation when
+// there is no art id reset function). Each bucket holds cache entry index or
+// `TIG_ART_CACHE_NONE`. The capacity is always a power of two and is kept at
+// least twice the number of loaded entries.
+static int* tig_art_cache_buckets;
+
+// Number of buckets in `tig_art_cache_buckets`.
+static int tig_art_cache_buckets_capacity;
+
+// Number of loaded cache entries (`tig_art_cache_entries_length` also counts
+// free entries).
+static int tig_art_cache_entries_count;
+
+// Head of the free cache entries list (linked via `next`).
+static int tig_art_cache_entries_free_head;
+
+// Most recently used loaded cache entry.
+static int tig_art_cache_lru_head;
+
+// Least recently used loaded cache entry, this is where eviction starts.
+static int tig_art_cache_lru_tail;
+
+// Bitmask of art types (`1 << TIG_ART_TYPE_*`) which frames are kept
+// run-length encoded in the cache.
+static unsigned int tig_art_rle_types;
+
+// Reset ids of art which failed to load, so that it is substituted with bad
+// art without probing the file system again. This is a direct-mapped table
+// (a colliding id replaces the previous one).
+static TigArtMissingSlot tig_art_missing_slots[TIG_ART_MISSING_CAPACITY];
+
+// Repositories version (see `tig_file_repository_version`) the missing art
+// table is valid for.
+static unsigned int tig_art_missing_version;
+
+// Palette-indirect mode (see `tig_art_cache_set_palette_indirect`).
+static bool tig_art_palette_indirect;
+
+// Scratch buffers of blits and hit tests done on the calling thread.
+static TigArtScratch tig_art_scratch;
+
+// Background art loading (see `tig_art_prefetch`). Queued jobs are picked
+// up by worker threads (`tig_art_prefetch_running` holds jobs in progress),
+// loaded jobs are moved to the finished list which is consumed by the main
+// thread. All of this is guarded by `tig_art_prefetch_mutex`.
+static SDL_Mutex* tig_art_prefetch_mutex;
+
+// Signaled when a job is queued or workers should quit.
+static SDL_Condition* tig_art_prefetch_queued_cond;
+
+// Signaled when a job is finished.
+static SDL_Condition* tig_art_prefetch_finished_cond;
+
+static SDL_Thread* tig_art_prefetch_threads[TIG_ART_PREFETCH_MAX_THREADS];
+static TigArtPrefetchJob* tig_art_prefetch_running[TIG_ART_PREFETCH_MAX_THREADS];
+
+// Number of worker threads, they are only started on the first prefetch
+// request.
+static int tig_art_prefetch_threads_count;
+
+static TigArtPrefetchJob* tig_art_prefetch_queue_head;
+static TigArtPrefetchJob* tig_art_prefetch_queue_tail;
+static TigArtPrefetchJob* tig_art_prefetch_finished_head;
+static unsigned int tig_art_prefetch_generation;
+static bool tig_art_prefetch_quit;
+
+// Metadata entries (see `TigArtMetaEntry`), allocated on first use.
+static TigArtMetaEntry* tig_art_meta_entries;
+
+// Number of used metadata entries.
+static int tig_art_meta_entries_count;
+
+// Open-addressing hash index of metadata entries keyed by art cache key (see
+// `tig_art_cache_key`, which strips frame, palette and rotation when there is
+// no art id reset function), has `TIG_ART_META_CAPACITY * 2` buckets.
+static int* tig_art_meta_buckets;
+
+static int tig_art_meta_lru_head;
+static int tig_art_meta_lru_tail;
+
+// Memory budgets of art types in percents of the art cache memory (see
+// `TigInitInfo::art_cache_budgets`), zero means the type is only limited by
+// the art cache memory.
+static int tig_art_type_budgets[TIG_ART_TYPE_COUNT];
+
+// Memory used by loaded art of every type.
+static art_size_t tig_art_type_system_memory[TIG_ART_TYPE_COUNT];
+static art_size_t tig_art_type_video_memory[TIG_ART_TYPE_COUNT];
+
+// Art cache counters (see `tig_art_cache_stats`), memory usage is not kept
+// here.
+static TigArtCacheStats tig_art_cache_counters;
+
+// Blit list being recorded (see `tig_art_blit_list_begin`), items are kept
+// between lists to avoid reallocations.
+static bool tig_art_blit_list_active;
+static unsigned int tig_art_blit_list_flags;
+static TigVideoBuffer* tig_art_blit_list_dst_video_buffer;
+static TigRect tig_art_blit_list_dst_bounds;
+static TigArtBlitListItem* tig_art_blit_list_items;
+static int tig_art_blit_list_items_count;
+static int tig_art_blit_list_items_capacity;
+
+// Band workers of banded blit lists (see `tig_art_blit_list_submit_banded`).
+// Workers wait for `tig_art_band_generation` to change, blit their band of
+// `tig_art_band_items_start`..`tig_art_band_items_end` list items, and the
+// last one to finish signals `tig_art_band_done_cond`. All of this is guarded
+// by `tig_art_band_mutex`.
+static SDL_Mutex* tig_art_band_mutex;
+static SDL_Condition* tig_art_band_start_cond;
+static SDL_Condition* tig_art_band_done_cond;
+static SDL_Thread* tig_art_band_threads[TIG_ART_BAND_MAX_THREADS];
+static TigArtScratch tig_art_band_scratch[TIG_ART_BAND_MAX_THREADS];
+
+// Number of worker threads, they are only started on the first banded blit
+// list.
+static int tig_art_band_threads_count;
+
+static unsigned int tig_art_band_generation;
+static bool tig_art_band_quit;
+
+// Number of workers which have not finished their bands yet.
+static int tig_art_band_pending;
+
+// Work shared by all bands, read-only while workers are running.
+static TigVideoBufferData tig_art_band_video_buffer_data;
+static int tig_art_band_count;
+static int tig_art_band_items_start;
+static int tig_art_band_items_end;
+
+// Atlases frame video buffers are packed into (see `art_video_buffer_create`).
+static TigArtAtlas* tig_art_atlases;
+static int tig_art_atlases_count;
+
+// Video memory taken by atlases (see `tig_art_atlas_alloc`).
+static art_size_t tig_art_atlases_video_memory;
+
+// Palette lookup kernel used for unblended spans, selected at startup
+// according to CPU features.
+static ArtBlitSpanCopyFunc* art_blit_span_copy_func = art_blit_span_copy;
+
 // 0x500590
 int tig_art_init(TigInitInfo* init_info)
 {
     size_t total_memory;
     size_t available_memory;
+    size_t cache_size;
+    int index;
+    int total_budget;
 
     if (tig_art_initialized) {
         return TIG_ERR_ALREADY_INITIALIZED;
     }
 
+    // Budgets are percents of the art cache memory, they cannot add up to
+    // more than the whole cache.
+    if (init_info->art_cache_budgets != NULL) {
+        total_budget = 0;
+        for (index = 0; index < TIG_ART_TYPE_COUNT; index++) {
+            if (init_info->art_cache_budgets[index] < 0
+                || init_info->art_cache_budgets[index] > 100) {
+                return TIG_ERR_INVALID_PARAM;
+            }
+            total_budget += init_info->art_cache_budgets[index];
+        }
+
+        if (total_budget > 100) {
+            return TIG_ERR_INVALID_PARAM;
+        }
+    }
+
     tig_art_cache_entries_capacity = 512;
     tig_art_cache_entries_length = 0;
+    tig_art_cache_entries_count = 0;
+    tig_art_cache_entries_free_head = TIG_ART_CACHE_NONE;
+    tig_art_cache_lru_head = TIG_ART_CACHE_NONE;
+    tig_art_cache_lru_tail = TIG_ART_CACHE_NONE;
     tig_art_cache_entries = (TigArtCacheEntry*)MALLOC(sizeof(TigArtCacheEntry) * tig_art_cache_entries_capacity);
+    tig_art_cache_buckets_reset(tig_art_cache_entries_capacity * 2);
+    dword_604714 = TIG_ART_CACHE_NONE;
+    tig_art_cache_reset_stats();
+
+    for (index = 0; index < TIG_ART_MISSING_CAPACITY; index++) {
+        tig_art_missing_slots[index].occupied = false;
+    }
+    tig_art_missing_version = tig_file_repository_version();
 
     tig_memory_get_system_status(&total_memory, &available_memory);
 
@@ -389,18 +914,38 @@ int tig_art_init(TigInitInfo* init_info)
         total_memory = UINT_MAX;
     }
 
-    tig_art_available_system_memory = (art_size_t)(total_memory >> 2);
-    tig_art_total_system_memory = (art_size_t)(total_memory >> 2);
+    cache_size = total_memory >> 2;
+    if (init_info->art_cache_size != 0 && init_info->art_cache_size < cache_size) {
+        cache_size = init_info->art_cache_size;
+    }
+
+    tig_art_available_system_memory = (art_size_t)cache_size;
+    tig_art_total_system_memory = (art_size_t)cache_size;
 
     tig_art_available_video_memory = tig_art_available_system_memory;
     tig_art_total_video_memory = tig_art_total_system_memory;
     tig_debug_printf("Art mem vid avail is %d\n", tig_art_available_video_memory);
 
+    for (index = 0; index < TIG_ART_TYPE_COUNT; index++) {
+        tig_art_type_budgets[index] = init_info->art_cache_budgets != NULL
+            ? init_info->art_cache_budgets[index]
+            : 0;
+        tig_art_type_system_memory[index] = 0;
+        tig_art_type_video_memory[index] = 0;
+    }
+
     tig_art_bits_per_pixel = init_info->bpp;
     tig_art_bytes_per_pixel = tig_art_bits_per_pixel / 8;
     tig_art_file_path_resolver = init_info->art_file_path_resolver;
     tig_art_id_reset_func = init_info->art_id_reset_func;
 
+    art_blit_span_copy_func = art_blit_span_copy;
+#ifdef SDL_AVX2_INTRINSICS
+    if (SDL_HasAVX2()) {
+        art_blit_span_copy_func = art_blit_span_copy_avx2;
+    }
+#endif
+
     tig_art_initialized = true;
 
     dword_604718 = tig_video_3d_check_initialized() == TIG_OK;
@@ -411,7 +956,10 @@ int tig_art_init(TigInitInfo* init_info)
 // 0x500690
 void tig_art_exit()
 {
+    int index;
+
     if (tig_art_initialized) {
+        tig_art_prefetch_stop();
         tig_art_flush();
 
         if (tig_art_cache_entries != NULL) {
@@ -421,6 +969,46 @@ void tig_art_exit()
             tig_art_cache_entries_capacity = 0;
         }
 
+        if (tig_art_cache_buckets != NULL) {
+            FREE(tig_art_cache_buckets);
+            tig_art_cache_buckets = NULL;
+            tig_art_cache_buckets_capacity = 0;
+        }
+
+        if (tig_art_meta_entries != NULL) {
+            FREE(tig_art_meta_entries);
+            tig_art_meta_entries = NULL;
+        }
+
+        if (tig_art_meta_buckets != NULL) {
+            FREE(tig_art_meta_buckets);
+            tig_art_meta_buckets = NULL;
+        }
+
+        // Frame video buffers are destroyed by the flush above, so atlases
+        // are empty by now.
+        if (tig_art_atlases != NULL) {
+            for (index = 0; index < tig_art_atlases_count; index++) {
+                tig_art_atlas_destroy(&(tig_art_atlases[index]));
+            }
+
+            FREE(tig_art_atlases);
+            tig_art_atlases = NULL;
+            tig_art_atlases_count = 0;
+        }
+
+        if (tig_art_blit_list_items != NULL) {
+            FREE(tig_art_blit_list_items);
+            tig_art_blit_list_items = NULL;
+            tig_art_blit_list_items_count = 0;
+            tig_art_blit_list_items_capacity = 0;
+        }
+
+        tig_art_blit_list_active = false;
+
+        tig_art_band_stop();
+        tig_art_scratch_free(&tig_art_scratch);
+
         tig_art_initialized = false;
     }
 }
@@ -428,6 +1016,7 @@ void tig_art_exit()
 // 0x5006D0
 void tig_art_ping()
 {
+    tig_art_prefetch_publish();
 }
 
 // 0x501DD0
@@ -449,16 +1038,42 @@ int tig_art_misc_id_create(unsigned int num, unsigned int palette, tig_art_id_t*
 void tig_art_flush()
 {
     int index;
+    TigArtPrefetchJob* job;
 
     if (!tig_art_initialized) {
         return;
     }
 
+    // Art being prefetched might be loaded with outdated settings.
+    if (tig_art_prefetch_threads_count != 0) {
+        SDL_LockMutex(tig_art_prefetch_mutex);
+        tig_art_prefetch_generation++;
+        while (tig_art_prefetch_queue_head != NULL) {
+            job = tig_art_prefetch_queue_head;
+            tig_art_prefetch_queue_head = job->next;
+            FREE(job);
+        }
+        tig_art_prefetch_queue_tail = NULL;
+        SDL_UnlockMutex(tig_art_prefetch_mutex);
+
+        tig_art_prefetch_publish();
+    }
+
     for (index = 0; index < tig_art_cache_entries_length; index++) {
-        tig_art_cache_entry_unload(index);
+        if ((tig_art_cache_entries[index].flags & TIG_ART_CACHE_ENTRY_LOADED) != 0) {
+            tig_art_cache_entry_unload(index);
+        }
     }
 
     tig_art_cache_entries_length = 0;
+    tig_art_cache_entries_count = 0;
+    tig_art_cache_entries_free_head = TIG_ART_CACHE_NONE;
+    tig_art_cache_lru_head = TIG_ART_CACHE_NONE;
+    tig_art_cache_lru_tail = TIG_ART_CACHE_NONE;
+    tig_art_cache_buckets_reset(tig_art_cache_buckets_capacity);
+    dword_604714 = TIG_ART_CACHE_NONE;
+
+    tig_art_meta_flush();
 }
 
 // 0x502220
@@ -506,265 +1121,714 @@ void sub_5022D0()
 {
     int index;
     unsigned int palette;
+    TigArtCacheEntry* art;
+    TigPalette adjusted;
+    bool changed;
 
+    // Palettes are shared, so adjusted palette is the same object as the
+    // current one when it has not changed. Only video buffers of art which
+    // palette has actually changed are rebuilt.
     for (index = 0; index < tig_art_cache_entries_length; index++) {
+        art = &(tig_art_cache_entries[index]);
+        if ((art->flags & TIG_ART_CACHE_ENTRY_LOADED) == 0) {
+            continue;
+        }
+
+        changed = false;
         for (palette = 0; palette < MAX_PALETTES; palette++) {
-            if (tig_art_cache_entries[index].hdr.palette_tbl[palette] != NULL) {
-                sub_505000(tig_art_cache_entries[index].art_id,
-                    tig_art_cache_entries[index].hdr.palette_tbl[palette],
-                    tig_art_cache_entries[index].palette_tbl[palette]);
+            if (art->hdr.palette_tbl[palette] != NULL) {
+                adjusted = art_palette_adjust(art->art_id, art->hdr.palette_tbl[palette]);
+                tig_palette_release(art->palette_tbl[palette]);
+
+                if (adjusted != art->palette_tbl[palette]) {
+                    art->palette_tbl[palette] = adjusted;
+                    changed = true;
+                }
             }
         }
-        art_invalidate(index);
+
+        if (changed) {
+            art_invalidate(index);
+        }
     }
 }
 
 // 0x502360
 int tig_art_blit(TigArtBlitInfo* blit_info)
+{
+    int cache_entry_index;
+
+    cache_entry_index = sub_51AA90(blit_info->art_id);
+    if (cache_entry_index == -1) {
+        return TIG_ERR_IO;
+    }
+
+    return art_blit_cached(cache_entry_index, blit_info);
+}
+
+// Blits art which is already in the art cache, handles flipping of tiles and
+// mirrored critters, and chooses between video buffer and direct blits.
+int art_blit_cached(int cache_entry_index, TigArtBlitInfo* blit_info)
 {
     TigArtBlitInfo mut_art_blit_info;
     TigVideoBuffer* video_buffer;
-    TigVideoBufferData video_buffer_data;
-    TigVideoBufferBlitInfo vb_blit_info;
-    int rc;
-    int cache_entry_index;
-    unsigned int type;
+    unsigned int vb_flags;
 
     mut_art_blit_info = *blit_info;
+    art_blit_adjust(&mut_art_blit_info);
 
-    cache_entry_index = sub_51AA90(mut_art_blit_info.art_id);
-    if (cache_entry_index == -1) {
-        return TIG_ERR_IO;
+    if (art_blit_video_buffer_get(cache_entry_index, &mut_art_blit_info, &video_buffer, &vb_flags)) {
+        return art_blit_video_buffer(&mut_art_blit_info, video_buffer, vb_flags);
     }
 
-    type = tig_art_type(mut_art_blit_info.art_id);
+    // Blends are applied in place, every destination pixel is read and
+    // written once. Source pixels come from the art cache rather than a video
+    // buffer, so they never alias the destination and there is no need to
+    // compose blend in the scratch buffer first.
+    return art_blit(cache_entry_index, &mut_art_blit_info);
+}
+
+// Replaces flippable tiles and mirrored critters with the art they are
+// flipped from.
+void art_blit_adjust(TigArtBlitInfo* blit_info)
+{
+    unsigned int type;
+
+    type = tig_art_type(blit_info->art_id);
     if (type == TIG_ART_TYPE_TILE) {
-        if (tig_art_tile_id_flippable_get(mut_art_blit_info.art_id)) {
-            unsigned int flags = tig_art_id_flags_get(mut_art_blit_info.art_id);
+        if (tig_art_tile_id_flippable_get(blit_info->art_id)) {
+            unsigned int flags = tig_art_id_flags_get(blit_info->art_id);
             if ((flags & 0x1) != 0) {
-                if ((mut_art_blit_info.flags & TIG_ART_BLT_FLIP_X) != 0) {
-                    mut_art_blit_info.flags &= ~TIG_ART_BLT_FLIP_X;
+                if ((blit_info->flags & TIG_ART_BLT_FLIP_X) != 0) {
+                    blit_info->flags &= ~TIG_ART_BLT_FLIP_X;
                 } else {
-                    mut_art_blit_info.flags |= TIG_ART_BLT_FLIP_X;
+                    blit_info->flags |= TIG_ART_BLT_FLIP_X;
                 }
             }
-            mut_art_blit_info.art_id = tig_art_id_flags_set(mut_art_blit_info.art_id, flags & ~0x1);
+            blit_info->art_id = tig_art_id_flags_set(blit_info->art_id, flags & ~0x1);
         }
     } else {
         if (tig_art_mirroring_enabled
             && (type == TIG_ART_TYPE_CRITTER
                 || type == TIG_ART_TYPE_MONSTER
                 || type == TIG_ART_TYPE_UNIQUE_NPC)) {
-            int rotation = tig_art_id_rotation_get(mut_art_blit_info.art_id);
+            int rotation = tig_art_id_rotation_get(blit_info->art_id);
             if (rotation > 0 && rotation < 4) {
-                mut_art_blit_info.art_id = tig_art_id_rotation_set(mut_art_blit_info.art_id, MAX_ROTATIONS - rotation);
-                if ((mut_art_blit_info.flags & TIG_ART_BLT_FLIP_X) != 0) {
-                    mut_art_blit_info.flags &= ~TIG_ART_BLT_FLIP_X;
+                blit_info->art_id = tig_art_id_rotation_set(blit_info->art_id, MAX_ROTATIONS - rotation);
+                if ((blit_info->flags & TIG_ART_BLT_FLIP_X) != 0) {
+                    blit_info->flags &= ~TIG_ART_BLT_FLIP_X;
                 } else {
-                    mut_art_blit_info.flags |= TIG_ART_BLT_FLIP_X;
+                    blit_info->flags |= TIG_ART_BLT_FLIP_X;
                 }
             }
         }
     }
+}
 
-    if (sub_505940(mut_art_blit_info.flags, &(vb_blit_info.flags)) == TIG_OK
-        && sub_520FB0(mut_art_blit_info.dst_video_buffer, vb_blit_info.flags) == TIG_OK
-        && art_get_video_buffer(cache_entry_index, mut_art_blit_info.art_id, &video_buffer) == TIG_OK) {
-        if ((mut_art_blit_info.flags & TIG_ART_BLT_BLEND_COLOR_CONST) != 0) {
-            vb_blit_info.field_10 = mut_art_blit_info.color;
-        } else if ((mut_art_blit_info.flags & TIG_ART_BLT_BLEND_COLOR_LERP) != 0) {
-            vb_blit_info.field_10 = mut_art_blit_info.field_14[0];
-            vb_blit_info.field_14 = mut_art_blit_info.field_14[1];
-            vb_blit_info.field_18 = mut_art_blit_info.field_14[2];
-            vb_blit_info.field_1C = mut_art_blit_info.field_14[3];
-            vb_blit_info.field_20 = mut_art_blit_info.field_18;
-        } else if ((mut_art_blit_info.flags & TIG_ART_BLT_BLEND_COLOR_ARRAY) != 0) {
-            vb_blit_info.field_10 = mut_art_blit_info.field_14[0];
-            vb_blit_info.field_14 = mut_art_blit_info.field_14[1];
-            vb_blit_info.field_18 = mut_art_blit_info.field_14[1];
-            vb_blit_info.field_1C = mut_art_blit_info.field_14[0];
-            vb_blit_info.field_20 = 0;
-        }
-
-        if ((mut_art_blit_info.flags & TIG_ART_BLT_BLEND_ALPHA_CONST) != 0) {
-            vb_blit_info.alpha[0] = mut_art_blit_info.alpha[0];
-        } else if ((mut_art_blit_info.flags & TIG_ART_BLT_BLEND_ALPHA_LERP_X) != 0) {
-            vb_blit_info.alpha[0] = mut_art_blit_info.alpha[0];
-            vb_blit_info.alpha[1] = mut_art_blit_info.alpha[0];
-            vb_blit_info.alpha[2] = mut_art_blit_info.alpha[1];
-            vb_blit_info.alpha[3] = mut_art_blit_info.alpha[1];
-        } else if ((mut_art_blit_info.flags & TIG_ART_BLT_BLEND_ALPHA_LERP_Y) != 0) {
-            vb_blit_info.alpha[0] = mut_art_blit_info.alpha[0];
-            vb_blit_info.alpha[1] = mut_art_blit_info.alpha[0];
-            vb_blit_info.alpha[2] = mut_art_blit_info.alpha[3];
-            vb_blit_info.alpha[3] = mut_art_blit_info.alpha[3];
-        } else if ((mut_art_blit_info.flags & TIG_ART_BLT_BLEND_ALPHA_LERP_BOTH) != 0) {
-            vb_blit_info.alpha[0] = mut_art_blit_info.alpha[0];
-            vb_blit_info.alpha[1] = mut_art_blit_info.alpha[1];
-            vb_blit_info.alpha[2] = mut_art_blit_info.alpha[2];
-            vb_blit_info.alpha[3] = mut_art_blit_info.alpha[3];
-        }
-
-        vb_blit_info.src_rect = mut_art_blit_info.src_rect;
-        vb_blit_info.src_video_buffer = video_buffer;
-        vb_blit_info.dst_rect = mut_art_blit_info.dst_rect;
-        vb_blit_info.dst_video_buffer = mut_art_blit_info.dst_video_buffer;
-        return tig_video_buffer_blit(&vb_blit_info);
-    }
-
-    if ((mut_art_blit_info.flags & TIG_ART_BLT_BLEND_ANY) != 0) {
-        tig_video_buffer_data(mut_art_blit_info.dst_video_buffer, &video_buffer_data);
-
-        if ((video_buffer_data.flags & TIG_VIDEO_BUFFER_VIDEO_MEMORY) != 0
-            && (mut_art_blit_info.flags & TIG_ART_BLT_SCRATCH_VALID) != 0) {
-            rc = tig_video_buffer_data(mut_art_blit_info.scratch_video_buffer, &video_buffer_data);
-            if (rc != TIG_OK) {
-                return rc;
-            }
-
-            if ((mut_art_blit_info.flags & TIG_ART_BLT_BLEND_ALPHA_ANY) != 0) {
-                if ((video_buffer_data.flags & TIG_VIDEO_BUFFER_SYSTEM_MEMORY) == 0) {
-                    tig_debug_printf("Warning: using video memory surface as a scratch buffer.  This will cause slower performance.\n");
-                }
+// Checks if the (adjusted) blit is done by video buffer blit, in which case
+// retrieves frame video buffer and video buffer blit flags.
+//
+// Blends which depend on pixel position (and vertical flip, which is relative
+// to the source rect height in art blits) are left to art blits, so that the
+// result does not depend on the path taken. So are stretched blends, since
+// video buffer blits sample the source differently.
+bool art_blit_video_buffer_get(int cache_entry_index, TigArtBlitInfo* blit_info, TigVideoBuffer** video_buffer_ptr, unsigned int* vb_flags_ptr)
+{
+    return (!tig_art_palette_indirect || dword_604718)
+        && (blit_info->flags & (TIG_ART_BLT_FLIP_Y | TIG_ART_BLT_BLEND_ALPHA_LERP_ANY)) == 0
+        && ((blit_info->flags & TIG_ART_BLT_BLEND_ANY) == 0
+            || (blit_info->src_rect->width == blit_info->dst_rect->width
+                && blit_info->src_rect->height == blit_info->dst_rect->height))
+        && sub_505940(blit_info->flags, vb_flags_ptr) == TIG_OK
+        && sub_520FB0(blit_info->dst_video_buffer, *vb_flags_ptr) == TIG_OK
+        && art_get_video_buffer(cache_entry_index, blit_info->art_id, video_buffer_ptr) == TIG_OK;
+}
 
-                vb_blit_info.flags = 0;
-                vb_blit_info.src_rect = mut_art_blit_info.dst_rect;
-                vb_blit_info.dst_rect = mut_art_blit_info.dst_rect;
-                vb_blit_info.src_video_buffer = mut_art_blit_info.dst_video_buffer;
-                vb_blit_info.dst_video_buffer = mut_art_blit_info.scratch_video_buffer;
-                rc = tig_video_buffer_blit(&vb_blit_info);
-                if (rc != TIG_OK) {
-                    return rc;
-                }
-            } else {
-                tig_video_buffer_fill(mut_art_blit_info.scratch_video_buffer,
-                    mut_art_blit_info.dst_rect,
-                    video_buffer_data.color_key);
-            }
+// Blits frame video buffer (see `art_blit_video_buffer_get`).
+int art_blit_video_buffer(TigArtBlitInfo* blit_info, TigVideoBuffer* video_buffer, unsigned int vb_flags)
+{
+    TigVideoBufferBlitInfo vb_blit_info;
 
-            video_buffer = mut_art_blit_info.dst_video_buffer;
-            mut_art_blit_info.dst_video_buffer = mut_art_blit_info.scratch_video_buffer;
+    vb_blit_info.flags = vb_flags;
+
+    if ((blit_info->flags & TIG_ART_BLT_BLEND_COLOR_CONST) != 0) {
+        vb_blit_info.field_10 = blit_info->color;
+    } else if ((blit_info->flags & TIG_ART_BLT_BLEND_COLOR_LERP) != 0) {
+        vb_blit_info.field_10 = blit_info->field_14[0];
+        vb_blit_info.field_14 = blit_info->field_14[1];
+        vb_blit_info.field_18 = blit_info->field_14[2];
+        vb_blit_info.field_1C = blit_info->field_14[3];
+        vb_blit_info.field_20 = blit_info->field_18;
+    } else if ((blit_info->flags & TIG_ART_BLT_BLEND_COLOR_ARRAY) != 0) {
+        vb_blit_info.field_10 = blit_info->field_14[0];
+        vb_blit_info.field_14 = blit_info->field_14[1];
+        vb_blit_info.field_18 = blit_info->field_14[1];
+        vb_blit_info.field_1C = blit_info->field_14[0];
+        vb_blit_info.field_20 = 0;
+    }
+
+    if ((blit_info->flags & TIG_ART_BLT_BLEND_ALPHA_CONST) != 0) {
+        vb_blit_info.alpha[0] = blit_info->alpha[0];
+    } else if ((blit_info->flags & TIG_ART_BLT_BLEND_ALPHA_LERP_X) != 0) {
+        vb_blit_info.alpha[0] = blit_info->alpha[0];
+        vb_blit_info.alpha[1] = blit_info->alpha[1];
+        vb_blit_info.alpha[2] = blit_info->alpha[1];
+        vb_blit_info.alpha[3] = blit_info->alpha[0];
+    } else if ((blit_info->flags & TIG_ART_BLT_BLEND_ALPHA_LERP_Y) != 0) {
+        vb_blit_info.alpha[0] = blit_info->alpha[0];
+        vb_blit_info.alpha[1] = blit_info->alpha[0];
+        vb_blit_info.alpha[2] = blit_info->alpha[3];
+        vb_blit_info.alpha[3] = blit_info->alpha[3];
+    } else if ((blit_info->flags & TIG_ART_BLT_BLEND_ALPHA_LERP_BOTH) != 0) {
+        vb_blit_info.alpha[0] = blit_info->alpha[0];
+        vb_blit_info.alpha[1] = blit_info->alpha[1];
+        vb_blit_info.alpha[2] = blit_info->alpha[2];
+        vb_blit_info.alpha[3] = blit_info->alpha[3];
+    }
+
+    vb_blit_info.src_rect = blit_info->src_rect;
+    vb_blit_info.src_video_buffer = video_buffer;
+    vb_blit_info.dst_rect = blit_info->dst_rect;
+    vb_blit_info.dst_video_buffer = blit_info->dst_video_buffer;
+    return tig_video_buffer_blit(&vb_blit_info);
+}
+
+int tig_art_blit_list_begin(TigVideoBuffer* dst_video_buffer, unsigned int flags)
+{
+    TigVideoBufferData video_buffer_data;
+    int rc;
 
-            rc = art_blit(cache_entry_index, &mut_art_blit_info);
-            if (rc != TIG_OK) {
-                return rc;
-            }
+    if (!tig_art_initialized) {
+        return TIG_ERR_NOT_INITIALIZED;
+    }
 
-            mut_art_blit_info.dst_video_buffer = video_buffer;
+    if (tig_art_blit_list_active) {
+        return TIG_ERR_GENERIC;
+    }
 
-            vb_blit_info.flags = 0;
-            vb_blit_info.src_rect = mut_art_blit_info.dst_rect;
-            vb_blit_info.src_video_buffer = mut_art_blit_info.scratch_video_buffer;
-            vb_blit_info.dst_rect = mut_art_blit_info.dst_rect;
-            vb_blit_info.dst_video_buffer = mut_art_blit_info.dst_video_buffer;
-            return tig_video_buffer_blit(&vb_blit_info);
-        }
+    rc = tig_video_buffer_data(dst_video_buffer, &video_buffer_data);
+    if (rc != TIG_OK) {
+        return rc;
     }
 
-    return art_blit(cache_entry_index, &mut_art_blit_info);
-}
+    tig_art_blit_list_active = true;
+    tig_art_blit_list_flags = flags;
+    tig_art_blit_list_dst_video_buffer = dst_video_buffer;
+    tig_art_blit_list_dst_bounds.x = 0;
+    tig_art_blit_list_dst_bounds.y = 0;
+    tig_art_blit_list_dst_bounds.width = video_buffer_data.width;
+    tig_art_blit_list_dst_bounds.height = video_buffer_data.height;
+    tig_art_blit_list_items_count = 0;
 
-// 0x502700
-int tig_art_type(tig_art_id_t art_id)
-{
-    return art_id >> ART_ID_TYPE_SHIFT;
+    return TIG_OK;
 }
 
-// 0x502710
-unsigned int tig_art_num_get(tig_art_id_t art_id)
+int tig_art_blit_list_add(const TigArtBlitInfo* blit_info)
 {
-    switch (tig_art_type(art_id)) {
-    case TIG_ART_TYPE_TILE:
-    case TIG_ART_TYPE_WALL:
-    case TIG_ART_TYPE_CRITTER:
-    case TIG_ART_TYPE_MONSTER:
-        return 0;
-    case TIG_ART_TYPE_UNIQUE_NPC:
-        return (art_id >> UNIQUE_NPC_ID_NUM_SHIFT) & (UNIQUE_NPC_ID_MAX_NUM - 1);
-    case TIG_ART_TYPE_ITEM:
-        return (art_id >> 17) & 0x7FF;
-    case TIG_ART_TYPE_INTERFACE:
-        return (art_id >> INTERFACE_ID_NUM_SHIFT) & (INTERFACE_ID_MAX_NUM - 1);
-    default:
-        return (art_id >> ART_ID_NUM_SHIFT) & (ART_ID_MAX_NUM - 1);
+    TigArtBlitListItem* item;
+    TigRect rect;
+
+    if (!tig_art_blit_list_active) {
+        return TIG_ERR_GENERIC;
+    }
+
+    // Blits which miss the destination are dropped before they need art in
+    // the cache.
+    if (tig_rect_intersection(blit_info->dst_rect, &tig_art_blit_list_dst_bounds, &rect) != TIG_OK) {
+        return TIG_OK;
+    }
+
+    if (tig_art_blit_list_items_count == tig_art_blit_list_items_capacity) {
+        tig_art_blit_list_items_capacity = tig_art_blit_list_items_capacity != 0 ? tig_art_blit_list_items_capacity * 2 : 256;
+        tig_art_blit_list_items = (TigArtBlitListItem*)REALLOC(tig_art_blit_list_items, sizeof(*tig_art_blit_list_items) * tig_art_blit_list_items_capacity);
+    }
+
+    item = &(tig_art_blit_list_items[tig_art_blit_list_items_count]);
+    item->blit_info = *blit_info;
+    item->blit_info.dst_video_buffer = tig_art_blit_list_dst_video_buffer;
+    item->src_rect = *blit_info->src_rect;
+    item->dst_rect = *blit_info->dst_rect;
+
+    if ((blit_info->flags & TIG_ART_BLT_BLEND_COLOR_LERP) != 0) {
+        item->field_18 = *blit_info->field_18;
+        memcpy(item->field_14, blit_info->field_14, sizeof(item->field_14));
     }
+
+    item->key = tig_art_cache_key(blit_info->art_id);
+    item->order = tig_art_blit_list_items_count;
+
+    tig_art_blit_list_items_count++;
+
+    return TIG_OK;
 }
 
-// 0x502780
-tig_art_id_t tig_art_num_set(tig_art_id_t art_id, unsigned int value)
+int tig_art_blit_list_submit()
 {
-    unsigned int max;
-    unsigned int mask;
-    unsigned int shift;
+    TigArtBlitListItem* item;
+    int index;
+    int cache_entry_index = TIG_ART_CACHE_NONE;
+    tig_art_id_t key = 0;
+    int rc = TIG_OK;
 
-    switch (tig_art_type(art_id)) {
-    case TIG_ART_TYPE_TILE:
-    case TIG_ART_TYPE_WALL:
-    case TIG_ART_TYPE_CRITTER:
-    case TIG_ART_TYPE_MONSTER:
-        return 0;
-    case TIG_ART_TYPE_UNIQUE_NPC:
-        max = UNIQUE_NPC_ID_MAX_NUM;
-        mask = (UNIQUE_NPC_ID_MAX_NUM - 1) << UNIQUE_NPC_ID_NUM_SHIFT;
-        shift = UNIQUE_NPC_ID_NUM_SHIFT;
-        break;
-    case TIG_ART_TYPE_ITEM:
-        max = sub_502830(art_id);
-        mask = 0xFFE0000;
-        shift = 17;
-        break;
-    case TIG_ART_TYPE_INTERFACE:
-        max = INTERFACE_ID_MAX_NUM;
-        mask = (INTERFACE_ID_MAX_NUM - 1) << INTERFACE_ID_NUM_SHIFT;
-        shift = INTERFACE_ID_NUM_SHIFT;
-        break;
-    default:
-        max = ART_ID_MAX_NUM;
-        mask = (ART_ID_MAX_NUM - 1) << ART_ID_NUM_SHIFT;
-        shift = ART_ID_NUM_SHIFT;
-        break;
+    if (!tig_art_blit_list_active) {
+        return TIG_ERR_GENERIC;
     }
 
-    if (value < max) {
-        return (art_id & ~mask) | (value << shift);
+    tig_art_blit_list_active = false;
+
+    if ((tig_art_blit_list_flags & TIG_ART_BLIT_LIST_UNORDERED) != 0) {
+        qsort(tig_art_blit_list_items,
+            tig_art_blit_list_items_count,
+            sizeof(*tig_art_blit_list_items),
+            art_blit_list_compare);
     }
 
-    tig_debug_println("Range exceeded in art set.");
+    if ((tig_art_blit_list_flags & TIG_ART_BLIT_LIST_BANDED) != 0) {
+        rc = tig_art_blit_list_submit_banded();
+        tig_art_blit_list_items_count = 0;
+        return rc;
+    }
 
-    return art_id;
+    for (index = 0; index < tig_art_blit_list_items_count; index++) {
+        item = &(tig_art_blit_list_items[index]);
+
+        // Consecutive blits of the same art share one cache lookup. Nothing
+        // is evicted while the list is executed, other than by lookups.
+        if (cache_entry_index == TIG_ART_CACHE_NONE || item->key != key) {
+            key = item->key;
+            cache_entry_index = sub_51AA90(item->blit_info.art_id);
+            if (cache_entry_index == TIG_ART_CACHE_NONE) {
+                rc = TIG_ERR_IO;
+                continue;
+            }
+        }
+
+        item->blit_info.src_rect = &(item->src_rect);
+        item->blit_info.dst_rect = &(item->dst_rect);
+
+        if ((item->blit_info.flags & TIG_ART_BLT_BLEND_COLOR_LERP) != 0) {
+            item->blit_info.field_18 = &(item->field_18);
+            item->blit_info.field_14 = item->field_14;
+        }
+
+        if (art_blit_cached(cache_entry_index, &(item->blit_info)) != TIG_OK) {
+            rc = TIG_ERR_BLIT;
+        }
+    }
+
+    tig_art_blit_list_items_count = 0;
+
+    return rc;
 }
 
-// 0x502830
-unsigned int sub_502830(tig_art_id_t art_id)
+// Orders recorded blits by art, palette and blending mode (which selects
+// blit kernel), keeping blits of the same art in recording order.
+int art_blit_list_compare(const void* a, const void* b)
 {
-    unsigned int max;
-    int type;
+    const TigArtBlitListItem* item1 = (const TigArtBlitListItem*)a;
+    const TigArtBlitListItem* item2 = (const TigArtBlitListItem*)b;
 
-    if (tig_art_type(art_id) != TIG_ART_TYPE_ITEM) {
-        return 0;
+    if (item1->key != item2->key) {
+        return item1->key < item2->key ? -1 : 1;
     }
 
-    max = 1000;
+    if (tig_art_id_palette_get(item1->blit_info.art_id) != tig_art_id_palette_get(item2->blit_info.art_id)) {
+        return tig_art_id_palette_get(item1->blit_info.art_id) - tig_art_id_palette_get(item2->blit_info.art_id);
+    }
 
-    type = tig_art_item_id_type_get(art_id);
-    if (type == TIG_ART_ITEM_TYPE_WEAPON
-        || type == TIG_ART_ITEM_TYPE_AMMO
-        || (type == TIG_ART_ITEM_TYPE_ARMOR
-            && tig_art_item_id_armor_coverage_get(art_id) == TIG_ART_ARMOR_COVERAGE_TORSO)) {
-        max = 20;
+    if (item1->blit_info.flags != item2->blit_info.flags) {
+        return item1->blit_info.flags < item2->blit_info.flags ? -1 : 1;
     }
 
-    return max;
+    return item1->order - item2->order;
 }
 
-// 0x502880
-int tig_art_id_rotation_get(tig_art_id_t art_id)
+// Executes the blit list in horizontal bands of the destination, every band
+// but the first one on a worker thread. Every band executes all blits of the
+// list clipped to its rows in list order, so the result is the same as of
+// serial execution.
+//
+// Art cache lookups and video buffer blits are done on the calling thread.
+// Blits are collected until a video buffer blit, and then collected blits are
+// executed by all bands at once. Art of collected blits is pinned in the art
+// cache meanwhile.
+int tig_art_blit_list_submit_banded()
 {
-    switch (tig_art_type(art_id)) {
-    case TIG_ART_TYPE_TILE:
-    case TIG_ART_TYPE_INTERFACE:
-    case TIG_ART_TYPE_MISC:
-    case TIG_ART_TYPE_ROOF:
+    TigArtBlitListItem* item;
+    TigVideoBuffer* video_buffer;
+    unsigned int vb_flags;
+    int index;
+    int start;
+    int cache_entry_index = TIG_ART_CACHE_NONE;
+    tig_art_id_t key = 0;
+    int rc;
+
+    if (tig_art_band_mutex == NULL) {
+        tig_art_band_start();
+    }
+
+    rc = tig_video_buffer_lock(tig_art_blit_list_dst_video_buffer);
+    if (rc != TIG_OK) {
+        return rc;
+    }
+
+    rc = tig_video_buffer_data(tig_art_blit_list_dst_video_buffer, &tig_art_band_video_buffer_data);
+    if (rc != TIG_OK) {
+        tig_video_buffer_unlock(tig_art_blit_list_dst_video_buffer);
+        return rc;
+    }
+
+    tig_art_band_count = tig_art_band_threads_count + 1;
+    if (tig_art_band_count > tig_art_band_video_buffer_data.height / TIG_ART_BAND_MIN_HEIGHT) {
+        tig_art_band_count = tig_art_band_video_buffer_data.height / TIG_ART_BAND_MIN_HEIGHT;
+        if (tig_art_band_count < 1) {
+            tig_art_band_count = 1;
+        }
+    }
+
+    start = 0;
+    for (index = 0; index < tig_art_blit_list_items_count; index++) {
+        item = &(tig_art_blit_list_items[index]);
+        item->cache_entry_index = TIG_ART_CACHE_NONE;
+
+        if (cache_entry_index == TIG_ART_CACHE_NONE || item->key != key) {
+            key = item->key;
+            cache_entry_index = sub_51AA90(item->blit_info.art_id);
+            if (cache_entry_index == TIG_ART_CACHE_NONE) {
+                rc = TIG_ERR_IO;
+                continue;
+            }
+        }
+
+        item->blit_info.src_rect = &(item->src_rect);
+        item->blit_info.dst_rect = &(item->dst_rect);
+
+        if ((item->blit_info.flags & TIG_ART_BLT_BLEND_COLOR_LERP) != 0) {
+            item->blit_info.field_18 = &(item->field_18);
+            item->blit_info.field_14 = item->field_14;
+        }
+
+        art_blit_adjust(&(item->blit_info));
+
+        if (art_blit_video_buffer_get(cache_entry_index, &(item->blit_info), &video_buffer, &vb_flags)) {
+            tig_art_band_run(start, index);
+            start = index + 1;
+
+            // Video buffers cannot be blitted into locked video buffer.
+            tig_video_buffer_unlock(tig_art_blit_list_dst_video_buffer);
+
+            if (art_blit_video_buffer(&(item->blit_info), video_buffer, vb_flags) != TIG_OK) {
+                rc = TIG_ERR_BLIT;
+            }
+
+            tig_video_buffer_lock(tig_art_blit_list_dst_video_buffer);
+            tig_video_buffer_data(tig_art_blit_list_dst_video_buffer, &tig_art_band_video_buffer_data);
+            continue;
+        }
+
+        // Collected blits refer to the art cache entry, it is pinned so that
+        // lookups of the following blits (including prefetched art they
+        // publish) do not evict it.
+        item->cache_entry_index = cache_entry_index;
+        tig_art_cache_entries[cache_entry_index].flags |= TIG_ART_CACHE_ENTRY_PINNED;
+    }
+
+    tig_art_band_run(start, tig_art_blit_list_items_count);
+
+    tig_video_buffer_unlock(tig_art_blit_list_dst_video_buffer);
+
+    return rc;
+}
+
+// Starts band worker threads.
+bool tig_art_band_start()
+{
+    int count;
+    int index;
+
+    // There is no point in banding on single core.
+    count = SDL_GetNumLogicalCPUCores() - 1;
+    if (count < 1) {
+        return false;
+    } else if (count > TIG_ART_BAND_MAX_THREADS) {
+        count = TIG_ART_BAND_MAX_THREADS;
+    }
+
+    tig_art_band_mutex = SDL_CreateMutex();
+    tig_art_band_start_cond = SDL_CreateCondition();
+    tig_art_band_done_cond = SDL_CreateCondition();
+    tig_art_band_generation = 0;
+    tig_art_band_pending = 0;
+    tig_art_band_quit = false;
+
+    for (index = 0; index < count; index++) {
+        tig_art_band_threads[index] = SDL_CreateThread(tig_art_band_worker, "tig_art_band", (void*)(intptr_t)index);
+        if (tig_art_band_threads[index] == NULL) {
+            break;
+        }
+
+        tig_art_band_threads_count++;
+    }
+
+    if (tig_art_band_threads_count == 0) {
+        tig_debug_printf("Art: Error - unable to start band threads: %s\n", SDL_GetError());
+        tig_art_band_stop();
+        return false;
+    }
+
+    return true;
+}
+
+// Stops band worker threads.
+void tig_art_band_stop()
+{
+    int index;
+
+    if (tig_art_band_mutex == NULL) {
+        return;
+    }
+
+    SDL_LockMutex(tig_art_band_mutex);
+    tig_art_band_quit = true;
+    SDL_BroadcastCondition(tig_art_band_start_cond);
+    SDL_UnlockMutex(tig_art_band_mutex);
+
+    for (index = 0; index < tig_art_band_threads_count; index++) {
+        SDL_WaitThread(tig_art_band_threads[index], NULL);
+        tig_art_band_threads[index] = NULL;
+        tig_art_scratch_free(&(tig_art_band_scratch[index]));
+    }
+    tig_art_band_threads_count = 0;
+
+    SDL_DestroyCondition(tig_art_band_done_cond);
+    tig_art_band_done_cond = NULL;
+
+    SDL_DestroyCondition(tig_art_band_start_cond);
+    tig_art_band_start_cond = NULL;
+
+    SDL_DestroyMutex(tig_art_band_mutex);
+    tig_art_band_mutex = NULL;
+}
+
+int SDLCALL tig_art_band_worker(void* userdata)
+{
+    int slot;
+    unsigned int generation = 0;
+
+    slot = (int)(intptr_t)userdata;
+
+    SDL_LockMutex(tig_art_band_mutex);
+
+    while (!tig_art_band_quit) {
+        if (generation == tig_art_band_generation) {
+            SDL_WaitCondition(tig_art_band_start_cond, tig_art_band_mutex);
+            continue;
+        }
+
+        generation = tig_art_band_generation;
+
+        // Band zero is blitted by the calling thread, workers take the rest.
+        if (slot + 1 < tig_art_band_count) {
+            SDL_UnlockMutex(tig_art_band_mutex);
+
+            tig_art_band_blit(slot + 1, &(tig_art_band_scratch[slot]));
+
+            SDL_LockMutex(tig_art_band_mutex);
+
+            tig_art_band_pending--;
+            if (tig_art_band_pending == 0) {
+                SDL_SignalCondition(tig_art_band_done_cond);
+            }
+        }
+    }
+
+    SDL_UnlockMutex(tig_art_band_mutex);
+
+    return 0;
+}
+
+// Executes collected blits of the blit list in all bands and waits until
+// every band is done.
+void tig_art_band_run(int start, int end)
+{
+    int index;
+    int cache_entry_index;
+
+    if (start >= end) {
+        return;
+    }
+
+    tig_art_band_items_start = start;
+    tig_art_band_items_end = end;
+
+    if (tig_art_band_count > 1) {
+        SDL_LockMutex(tig_art_band_mutex);
+        tig_art_band_generation++;
+        tig_art_band_pending = tig_art_band_count - 1;
+        SDL_BroadcastCondition(tig_art_band_start_cond);
+        SDL_UnlockMutex(tig_art_band_mutex);
+    }
+
+    tig_art_band_blit(0, &tig_art_scratch);
+
+    if (tig_art_band_count > 1) {
+        SDL_LockMutex(tig_art_band_mutex);
+        while (tig_art_band_pending > 0) {
+            SDL_WaitCondition(tig_art_band_done_cond, tig_art_band_mutex);
+        }
+        SDL_UnlockMutex(tig_art_band_mutex);
+    }
+
+    for (index = start; index < end; index++) {
+        cache_entry_index = tig_art_blit_list_items[index].cache_entry_index;
+        if (cache_entry_index != TIG_ART_CACHE_NONE) {
+            tig_art_cache_entries[cache_entry_index].flags &= ~TIG_ART_CACHE_ENTRY_PINNED;
+        }
+    }
+}
+
+// Executes collected blits of the blit list clipped to the specified band.
+void tig_art_band_blit(int band, TigArtScratch* scratch)
+{
+    TigArtBlitListItem* item;
+    int min_y;
+    int max_y;
+    int index;
+
+    min_y = tig_art_band_video_buffer_data.height * band / tig_art_band_count;
+    max_y = tig_art_band_video_buffer_data.height * (band + 1) / tig_art_band_count;
+
+    for (index = tig_art_band_items_start; index < tig_art_band_items_end; index++) {
+        item = &(tig_art_blit_list_items[index]);
+        if (item->cache_entry_index == TIG_ART_CACHE_NONE) {
+            continue;
+        }
+
+        // Blitted rows never leave the recorded destination rect.
+        if (item->dst_rect.y >= max_y || item->dst_rect.y + item->dst_rect.height <= min_y) {
+            continue;
+        }
+
+        art_blit_rows(item->cache_entry_index, &(item->blit_info), &tig_art_band_video_buffer_data, min_y, max_y, scratch);
+    }
+}
+
+void tig_art_scratch_free(TigArtScratch* scratch)
+{
+    if (scratch->rle != NULL) {
+        FREE(scratch->rle);
+        scratch->rle = NULL;
+        scratch->rle_size = 0;
+    }
+
+    if (scratch->stretch_steps != NULL) {
+        FREE(scratch->stretch_steps);
+        scratch->stretch_steps = NULL;
+        scratch->stretch_steps_size = 0;
+    }
+}
+
+// 0x502700
+int tig_art_type(tig_art_id_t art_id)
+{
+    return art_id >> ART_ID_TYPE_SHIFT;
+}
+
+// 0x502710
+unsigned int tig_art_num_get(tig_art_id_t art_id)
+{
+    switch (tig_art_type(art_id)) {
+    case TIG_ART_TYPE_TILE:
+    case TIG_ART_TYPE_WALL:
+    case TIG_ART_TYPE_CRITTER:
+    case TIG_ART_TYPE_MONSTER:
+        return 0;
+    case TIG_ART_TYPE_UNIQUE_NPC:
+        return (art_id >> UNIQUE_NPC_ID_NUM_SHIFT) & (UNIQUE_NPC_ID_MAX_NUM - 1);
+    case TIG_ART_TYPE_ITEM:
+        return (art_id >> 17) & 0x7FF;
+    case TIG_ART_TYPE_INTERFACE:
+        return (art_id >> INTERFACE_ID_NUM_SHIFT) & (INTERFACE_ID_MAX_NUM - 1);
+    default:
+        return (art_id >> ART_ID_NUM_SHIFT) & (ART_ID_MAX_NUM - 1);
+    }
+}
+
+// 0x502780
+tig_art_id_t tig_art_num_set(tig_art_id_t art_id, unsigned int value)
+{
+    unsigned int max;
+    unsigned int mask;
+    unsigned int shift;
+
+    switch (tig_art_type(art_id)) {
+    case TIG_ART_TYPE_TILE:
+    case TIG_ART_TYPE_WALL:
+    case TIG_ART_TYPE_CRITTER:
+    case TIG_ART_TYPE_MONSTER:
+        return 0;
+    case TIG_ART_TYPE_UNIQUE_NPC:
+        max = UNIQUE_NPC_ID_MAX_NUM;
+        mask = (UNIQUE_NPC_ID_MAX_NUM - 1) << UNIQUE_NPC_ID_NUM_SHIFT;
+        shift = UNIQUE_NPC_ID_NUM_SHIFT;
+        break;
+    case TIG_ART_TYPE_ITEM:
+        max = sub_502830(art_id);
+        mask = 0xFFE0000;
+        shift = 17;
+        break;
+    case TIG_ART_TYPE_INTERFACE:
+        max = INTERFACE_ID_MAX_NUM;
+        mask = (INTERFACE_ID_MAX_NUM - 1) << INTERFACE_ID_NUM_SHIFT;
+        shift = INTERFACE_ID_NUM_SHIFT;
+        break;
+    default:
+        max = ART_ID_MAX_NUM;
+        mask = (ART_ID_MAX_NUM - 1) << ART_ID_NUM_SHIFT;
+        shift = ART_ID_NUM_SHIFT;
+        break;
+    }
+
+    if (value < max) {
+        return (art_id & ~mask) | (value << shift);
+    }
+
+    tig_debug_println("Range exceeded in art set.");
+
+    return art_id;
+}
+
+// 0x502830
+unsigned int sub_502830(tig_art_id_t art_id)
+{
+    unsigned int max;
+    int type;
+
+    if (tig_art_type(art_id) != TIG_ART_TYPE_ITEM) {
+        return 0;
+    }
+
+    max = 1000;
+
+    type = tig_art_item_id_type_get(art_id);
+    if (type == TIG_ART_ITEM_TYPE_WEAPON
+        || type == TIG_ART_ITEM_TYPE_AMMO
+        || (type == TIG_ART_ITEM_TYPE_ARMOR
+            && tig_art_item_id_armor_coverage_get(art_id) == TIG_ART_ARMOR_COVERAGE_TORSO)) {
+        max = 20;
+    }
+
+    return max;
+}
+
+// 0x502880
+int tig_art_id_rotation_get(tig_art_id_t art_id)
+{
+    switch (tig_art_type(art_id)) {
+    case TIG_ART_TYPE_TILE:
+    case TIG_ART_TYPE_INTERFACE:
+    case TIG_ART_TYPE_MISC:
+    case TIG_ART_TYPE_ROOF:
     case TIG_ART_TYPE_ITEM:
     case TIG_ART_TYPE_FACADE:
         return 0;
@@ -1107,7 +2171,7 @@ int sub_502E50(tig_art_id_t art_id, int x, int y, unsigned int* color_ptr)
         }
     }
 
-    byte = cache_entry->pixels_tbl[rotation][frame][y * cache_entry->hdr.frames_tbl[rotation][frame].width + x];
+    byte = art_frame_pixel(cache_entry, rotation, frame, x, y);
 
     palette = tig_art_id_palette_get(art_id);
     if (cache_entry->hdr.palette_tbl[palette] == NULL) {
@@ -1134,20 +2198,42 @@ int sub_502E50(tig_art_id_t art_id, int x, int y, unsigned int* color_ptr)
 // 0x502FD0
 int sub_502FD0(tig_art_id_t art_id, int x, int y)
 {
+    return tig_art_hit_test(art_id, x, y);
+}
+
+int tig_art_hit_test(tig_art_id_t art_id, int x, int y)
+{
+    int index;
     int cache_entry_index;
+    TigArtHeader* hdr;
+    TigArtFrameMask* mask;
     int rotation;
     int frame;
     int type;
-    int index;
 
-    cache_entry_index = sub_51AA90(art_id);
-    if (cache_entry_index == -1) {
-        return TIG_ERR_IO;
+    // Masks are built when art is read into the metadata index, so hit
+    // testing never loads art into the cache.
+    index = tig_art_meta_load(art_id);
+    if (index != TIG_ART_CACHE_NONE) {
+        hdr = &(tig_art_meta_entries[index].hdr);
+        cache_entry_index = TIG_ART_CACHE_NONE;
+    } else {
+        // Broken art is substituted by the regular loading.
+        cache_entry_index = sub_51AA90(art_id);
+        if (cache_entry_index == -1) {
+            return TIG_ERR_IO;
+        }
+
+        hdr = &(tig_art_cache_entries[cache_entry_index].hdr);
     }
 
     rotation = tig_art_id_rotation_get(art_id);
     frame = tig_art_id_frame_get(art_id);
 
+    if (frame >= hdr->num_frames) {
+        return TIG_ERR_GENERIC;
+    }
+
     if (tig_art_mirroring_enabled) {
         type = tig_art_type(art_id);
         if ((type == TIG_ART_TYPE_CRITTER
@@ -1156,12 +2242,29 @@ int sub_502FD0(tig_art_id_t art_id, int x, int y)
             && rotation > 0
             && rotation < 4) {
             rotation = MAX_ROTATIONS - rotation;
-            x = tig_art_cache_entries[cache_entry_index].hdr.frames_tbl[rotation][frame].width - x - 1;
+            x = hdr->frames_tbl[rotation][frame].width - x - 1;
+        }
+    }
+
+    if (cache_entry_index != TIG_ART_CACHE_NONE) {
+        if (x < 0 || x >= hdr->frames_tbl[rotation][frame].width
+            || y < 0 || y >= hdr->frames_tbl[rotation][frame].height
+            || art_frame_pixel(&(tig_art_cache_entries[cache_entry_index]), rotation, frame, x, y) < 2) {
+            return TIG_ERR_GENERIC;
         }
+
+        return TIG_OK;
+    }
+
+    mask = &(tig_art_meta_entries[index].masks_tbl[rotation][frame]);
+
+    x -= mask->bounds.x;
+    y -= mask->bounds.y;
+    if (x < 0 || x >= mask->bounds.width || y < 0 || y >= mask->bounds.height) {
+        return TIG_ERR_GENERIC;
     }
 
-    index = y * tig_art_cache_entries[cache_entry_index].hdr.frames_tbl[rotation][frame].width + x;
-    if (tig_art_cache_entries[cache_entry_index].pixels_tbl[rotation][frame][index] < 2) {
+    if ((mask->bits[y * mask->stride + x / 8] & (1 << (x % 8))) == 0) {
         return TIG_ERR_GENERIC;
     }
 
@@ -1202,16 +2305,16 @@ int tig_art_anim_data(tig_art_id_t art_id, TigArtAnimData* data)
 
     switch (tig_art_bits_per_pixel) {
     case 8:
-        data->color_key = ((uint8_t*)data->palette1)[0];
+        data->color_key = ((const uint8_t*)data->palette1)[0];
         break;
     case 16:
-        data->color_key = ((uint16_t*)data->palette1)[0];
+        data->color_key = ((const uint16_t*)data->palette1)[0];
         break;
     case 24:
-        data->color_key = ((uint32_t*)data->palette1)[0];
+        data->color_key = ((const uint32_t*)data->palette1)[0];
         break;
     case 32:
-        data->color_key = ((uint32_t*)data->palette1)[0];
+        data->color_key = ((const uint32_t*)data->palette1)[0];
         break;
     }
 
@@ -1221,15 +2324,15 @@ int tig_art_anim_data(tig_art_id_t art_id, TigArtAnimData* data)
 // 0x5031C0
 int tig_art_frame_data(tig_art_id_t art_id, TigArtFrameData* data)
 {
-    int cache_entry_index;
-    TigArtCacheEntry* cache_entry;
+    TigArtHeader* hdr;
+    TigArtFileFrameData* frm;
     int rotation;
     int frame;
     bool mirrored;
     int type;
 
-    cache_entry_index = sub_51AA90(art_id);
-    if (cache_entry_index == -1) {
+    hdr = tig_art_meta_hdr(art_id);
+    if (hdr == NULL) {
         return TIG_ERR_GENERIC;
     }
 
@@ -1248,14 +2351,14 @@ int tig_art_frame_data(tig_art_id_t art_id, TigArtFrameData* data)
         rotation = MAX_ROTATIONS - rotation;
     }
 
-    cache_entry = &(tig_art_cache_entries[cache_entry_index]);
+    frm = &(hdr->frames_tbl[rotation][frame]);
 
-    data->width = cache_entry->hdr.frames_tbl[rotation][frame].width;
-    data->height = cache_entry->hdr.frames_tbl[rotation][frame].height;
-    data->hot_x = cache_entry->hdr.frames_tbl[rotation][frame].hot_x;
-    data->hot_y = cache_entry->hdr.frames_tbl[rotation][frame].hot_y;
-    data->offset_x = cache_entry->hdr.frames_tbl[rotation][frame].offset_x;
-    data->offset_y = cache_entry->hdr.frames_tbl[rotation][frame].offset_y;
+    data->width = frm->width;
+    data->height = frm->height;
+    data->hot_x = frm->hot_x;
+    data->hot_y = frm->hot_y;
+    data->offset_x = frm->offset_x;
+    data->offset_y = frm->offset_y;
 
     if ((type == TIG_ART_TYPE_WALL || type == TIG_ART_TYPE_PORTAL)
         && (rotation < 2 || rotation > 5)) {
@@ -1273,13 +2376,67 @@ int tig_art_frame_data(tig_art_id_t art_id, TigArtFrameData* data)
             data->hot_x = 0;
             data->offset_x = 0;
         } else {
-            data->hot_x = cache_entry->hdr.frames_tbl[rotation][frame].width - data->hot_x - 2;
+            data->hot_x = frm->width - data->hot_x - 2;
             data->offset_x = -data->offset_x;
         }
+
+        // Art with this flag is blitted flipped (see `art_blit`), which
+        // cancels out mirroring.
+        mirrored = !mirrored;
     }
 
-    return TIG_OK;
-}
+    if (!tig_art_frame_bounds(art_id, rotation, frame, &(data->bounds))) {
+        data->bounds.x = 0;
+        data->bounds.y = 0;
+        data->bounds.width = frm->width;
+        data->bounds.height = frm->height;
+    }
+
+    if (mirrored) {
+        data->bounds.x = frm->width - data->bounds.x - data->bounds.width;
+    }
+
+    return TIG_OK;
+}
+
+// Retrieves bounds of non-transparent pixels of the specified frame (of
+// already resolved rotation). Bounds of art which is not loaded are kept in
+// the metadata index (see `tig_art_meta_hdr`), so the answer does not depend
+// on the art cache. Returns `false` if art could not be loaded at all.
+bool tig_art_frame_bounds(tig_art_id_t art_id, int rotation, int frame, TigRect* bounds)
+{
+    tig_art_id_t key;
+    int index;
+    TigArtCacheEntry* art;
+    TigArtMetaEntry* meta;
+
+    key = tig_art_cache_key(art_id);
+
+    if (tig_art_cache_find(key, &index)) {
+        art = &(tig_art_cache_entries[index]);
+        if (art->bounds_tbl[rotation] == NULL
+            || frame >= art->hdr.num_frames) {
+            return false;
+        }
+
+        *bounds = art->bounds_tbl[rotation][frame];
+        return true;
+    }
+
+    tig_art_meta_reserve();
+
+    if (tig_art_meta_find(key, &index)) {
+        meta = &(tig_art_meta_entries[index]);
+        if (frame >= meta->hdr.num_frames) {
+            return false;
+        }
+
+        *bounds = meta->bounds_tbl[rotation][frame];
+        return true;
+    }
+
+    return false;
+}
 
 // 0x503340
 int sub_503340(tig_art_id_t art_id, uint8_t* dst, int pitch)
@@ -1298,7 +2455,7 @@ int sub_503340(tig_art_id_t art_id, uint8_t* dst, int pitch)
 
     rotation = tig_art_id_rotation_get(art_id);
     v2 = tig_art_id_frame_get(art_id);
-    src = tig_art_cache_entries[cache_entry_index].pixels_tbl[rotation][v2];
+    src = art_frame_pixels(&(tig_art_cache_entries[cache_entry_index]), rotation, v2, &tig_art_scratch);
     width = tig_art_cache_entries[cache_entry_index].hdr.frames_tbl[rotation][v2].width;
     height = tig_art_cache_entries[cache_entry_index].hdr.frames_tbl[rotation][v2].height;
 
@@ -1397,9 +2554,8 @@ int sub_5033E0(tig_art_id_t art_id, int a2, int a3)
 // 0x503510
 int tig_art_size(tig_art_id_t art_id, int* width_ptr, int* height_ptr)
 {
-    TigArtCacheEntry* art;
+    TigArtHeader* hdr;
     TigArtFileFrameData* frm;
-    int cache_entry_index;
     int type;
     int rotation_offset;
     int num_rotations;
@@ -1408,15 +2564,14 @@ int tig_art_size(tig_art_id_t art_id, int* width_ptr, int* height_ptr)
     int width = 0;
     int height = 0;
 
-    cache_entry_index = sub_51AA90(art_id);
-    if (cache_entry_index == -1) {
+    hdr = tig_art_meta_hdr(art_id);
+    if (hdr == NULL) {
         return TIG_ERR_GENERIC;
     }
 
-    art = &(tig_art_cache_entries[cache_entry_index]);
     type = tig_art_type(art_id);
 
-    if ((art->hdr.flags & TIG_ART_0x01) != 0) {
+    if ((hdr->flags & TIG_ART_0x01) != 0) {
         rotation_offset = 0;
         num_rotations = 1;
     } else if (tig_art_mirroring_enabled
@@ -1430,9 +2585,9 @@ int tig_art_size(tig_art_id_t art_id, int* width_ptr, int* height_ptr)
         num_rotations = MAX_ROTATIONS;
     }
 
-    for (frame = 0; frame < art->hdr.num_frames; ++frame) {
+    for (frame = 0; frame < hdr->num_frames; ++frame) {
         for (rotation = 0; rotation < num_rotations; ++rotation) {
-            frm = &(art->hdr.frames_tbl[(rotation + rotation_offset) % MAX_ROTATIONS][frame]);
+            frm = &(hdr->frames_tbl[(rotation + rotation_offset) % MAX_ROTATIONS][frame]);
             if (width < frm->width) {
                 width = frm->width;
             }
@@ -2673,6 +3828,20 @@ void sub_505000(tig_art_id_t art_id, TigPalette src_palette, TigPalette dst_pale
     }
 }
 
+// Returns shared palette adjusted for the specified art (see `sub_505000`).
+TigPalette art_palette_adjust(tig_art_id_t art_id, TigPalette src_palette)
+{
+    TigPalette palette;
+    TigPalette adjusted;
+
+    palette = tig_palette_create();
+    sub_505000(art_id, src_palette, palette);
+    adjusted = tig_palette_acquire(palette);
+    tig_palette_destroy(palette);
+
+    return adjusted;
+}
+
 // 0x505060
 int art_get_video_buffer(int cache_entry_index, tig_art_id_t art_id, TigVideoBuffer** video_buffer_ptr)
 {
@@ -2717,9 +3886,15 @@ int art_get_video_buffer(int cache_entry_index, tig_art_id_t art_id, TigVideoBuf
     if (type == TIG_ART_TYPE_ROOF) {
         palette = 0;
         rotation = 0;
+
+        if (!dword_604718 && art_palette_color_keyed(cache_entry_index, palette)) {
+            return TIG_ERR_GENERIC;
+        }
+
         if (tig_art_cache_entries[cache_entry_index].video_buffers[palette][rotation] == NULL) {
-            system_memory_size = sizeof(TigVideoBuffer*) * 13;
-            tig_art_cache_entries[cache_entry_index].video_buffers[palette][rotation] = (TigVideoBuffer**)MALLOC(system_memory_size);
+            system_memory_size = (sizeof(TigVideoBuffer*) + sizeof(TigArtAtlasSlot)) * 13;
+            tig_art_cache_entries[cache_entry_index].video_buffers[palette][rotation] = (TigVideoBuffer**)MALLOC(sizeof(TigVideoBuffer*) * 13);
+            tig_art_cache_entries[cache_entry_index].atlas_slots[palette][rotation] = (TigArtAtlasSlot*)MALLOC(sizeof(TigArtAtlasSlot) * 13);
 
             vb_create_info.color_key = tig_color_make(0, 255, 0);
             vb_create_info.background_color = vb_create_info.color_key;
@@ -2733,33 +3908,42 @@ int art_get_video_buffer(int cache_entry_index, tig_art_id_t art_id, TigVideoBuf
             for (frame = 0; frame < tig_art_cache_entries[cache_entry_index].hdr.num_frames; frame++) {
                 vb_create_info.width = tig_art_cache_entries[cache_entry_index].hdr.frames_tbl[0][frame].width;
                 vb_create_info.height = tig_art_cache_entries[cache_entry_index].hdr.frames_tbl[0][frame].height;
-                video_memory_size += vb_create_info.width * vb_create_info.height * tig_art_bits_per_pixel;
-
-                rc = tig_video_buffer_create(&vb_create_info, &(tig_art_cache_entries[cache_entry_index].video_buffers[palette][rotation][frame]));
+                rc = art_video_buffer_create(&vb_create_info, &(tig_art_cache_entries[cache_entry_index].video_buffers[palette][rotation][frame]), &(tig_art_cache_entries[cache_entry_index].atlas_slots[palette][rotation][frame]));
                 if (rc != TIG_OK) {
                     while (--frame >= 0) {
-                        tig_video_buffer_destroy(tig_art_cache_entries[cache_entry_index].video_buffers[palette][rotation][frame]);
+                        art_video_buffer_destroy(tig_art_cache_entries[cache_entry_index].video_buffers[palette][rotation][frame], &(tig_art_cache_entries[cache_entry_index].atlas_slots[palette][rotation][frame]));
                     }
                     FREE(tig_art_cache_entries[cache_entry_index].video_buffers[palette][rotation]);
                     tig_art_cache_entries[cache_entry_index].video_buffers[palette][rotation] = NULL;
+                    FREE(tig_art_cache_entries[cache_entry_index].atlas_slots[palette][rotation]);
+                    tig_art_cache_entries[cache_entry_index].atlas_slots[palette][rotation] = NULL;
                     return rc;
                 }
+
+                // Atlases are accounted as a whole (see `tig_art_atlas_alloc`).
+                if (tig_art_cache_entries[cache_entry_index].atlas_slots[palette][rotation][frame].atlas == TIG_ART_ATLAS_NONE) {
+                    video_memory_size += vb_create_info.width * vb_create_info.height * tig_art_bits_per_pixel;
+                }
             }
 
             for (; frame < 13; frame++) {
                 vb_create_info.width = tig_art_cache_entries[cache_entry_index].hdr.frames_tbl[0][frame - 9].width;
                 vb_create_info.height = tig_art_cache_entries[cache_entry_index].hdr.frames_tbl[0][frame - 9].height;
-                video_memory_size += vb_create_info.width * vb_create_info.height * tig_art_bits_per_pixel;
-
-                rc = tig_video_buffer_create(&vb_create_info, &(tig_art_cache_entries[cache_entry_index].video_buffers[palette][rotation][frame]));
+                rc = art_video_buffer_create(&vb_create_info, &(tig_art_cache_entries[cache_entry_index].video_buffers[palette][rotation][frame]), &(tig_art_cache_entries[cache_entry_index].atlas_slots[palette][rotation][frame]));
                 if (rc != TIG_OK) {
                     while (--frame >= 0) {
-                        tig_video_buffer_destroy(tig_art_cache_entries[cache_entry_index].video_buffers[palette][rotation][frame]);
+                        art_video_buffer_destroy(tig_art_cache_entries[cache_entry_index].video_buffers[palette][rotation][frame], &(tig_art_cache_entries[cache_entry_index].atlas_slots[palette][rotation][frame]));
                     }
                     FREE(tig_art_cache_entries[cache_entry_index].video_buffers[palette][rotation]);
                     tig_art_cache_entries[cache_entry_index].video_buffers[palette][rotation] = NULL;
+                    FREE(tig_art_cache_entries[cache_entry_index].atlas_slots[palette][rotation]);
+                    tig_art_cache_entries[cache_entry_index].atlas_slots[palette][rotation] = NULL;
                     return rc;
                 }
+
+                if (tig_art_cache_entries[cache_entry_index].atlas_slots[palette][rotation][frame].atlas == TIG_ART_ATLAS_NONE) {
+                    video_memory_size += vb_create_info.width * vb_create_info.height * tig_art_bits_per_pixel;
+                }
             }
 
             tig_art_cache_entries[cache_entry_index].dirty[palette][rotation] = 1;
@@ -2836,9 +4020,14 @@ int art_get_video_buffer(int cache_entry_index, tig_art_id_t art_id, TigVideoBuf
             art_id = tig_art_id_palette_set(art_id, 0);
         }
 
+        if (!dword_604718 && art_palette_color_keyed(cache_entry_index, palette)) {
+            return TIG_ERR_GENERIC;
+        }
+
         if (tig_art_cache_entries[cache_entry_index].video_buffers[palette][rotation] == NULL) {
-            system_memory_size = sizeof(TigVideoBuffer*) * tig_art_cache_entries[cache_entry_index].hdr.num_frames;
-            tig_art_cache_entries[cache_entry_index].video_buffers[palette][rotation] = (TigVideoBuffer**)MALLOC(system_memory_size);
+            system_memory_size = (sizeof(TigVideoBuffer*) + sizeof(TigArtAtlasSlot)) * tig_art_cache_entries[cache_entry_index].hdr.num_frames;
+            tig_art_cache_entries[cache_entry_index].video_buffers[palette][rotation] = (TigVideoBuffer**)MALLOC(sizeof(TigVideoBuffer*) * tig_art_cache_entries[cache_entry_index].hdr.num_frames);
+            tig_art_cache_entries[cache_entry_index].atlas_slots[palette][rotation] = (TigArtAtlasSlot*)MALLOC(sizeof(TigArtAtlasSlot) * tig_art_cache_entries[cache_entry_index].hdr.num_frames);
 
             vb_create_info.color_key = tig_color_make(0, 255, 0);
             vb_create_info.background_color = vb_create_info.color_key;
@@ -2853,18 +4042,24 @@ int art_get_video_buffer(int cache_entry_index, tig_art_id_t art_id, TigVideoBuf
             for (frame = 0; frame < tig_art_cache_entries[cache_entry_index].hdr.num_frames; frame++) {
                 vb_create_info.width = tig_art_cache_entries[cache_entry_index].hdr.frames_tbl[rotation][frame].width;
                 vb_create_info.height = tig_art_cache_entries[cache_entry_index].hdr.frames_tbl[rotation][frame].height;
-                video_memory_size += vb_create_info.width * vb_create_info.height * tig_art_bytes_per_pixel;
-                rc = tig_video_buffer_create(&vb_create_info, &(tig_art_cache_entries[cache_entry_index].video_buffers[palette][rotation][frame]));
+                rc = art_video_buffer_create(&vb_create_info, &(tig_art_cache_entries[cache_entry_index].video_buffers[palette][rotation][frame]), &(tig_art_cache_entries[cache_entry_index].atlas_slots[palette][rotation][frame]));
                 if (rc != TIG_OK) {
                     while (--frame >= 0) {
-                        tig_video_buffer_destroy(tig_art_cache_entries[cache_entry_index].video_buffers[palette][rotation][frame]);
+                        art_video_buffer_destroy(tig_art_cache_entries[cache_entry_index].video_buffers[palette][rotation][frame], &(tig_art_cache_entries[cache_entry_index].atlas_slots[palette][rotation][frame]));
                     }
 
                     FREE(tig_art_cache_entries[cache_entry_index].video_buffers[palette][rotation]);
                     tig_art_cache_entries[cache_entry_index].video_buffers[palette][rotation] = NULL;
+                    FREE(tig_art_cache_entries[cache_entry_index].atlas_slots[palette][rotation]);
+                    tig_art_cache_entries[cache_entry_index].atlas_slots[palette][rotation] = NULL;
 
                     return rc;
                 }
+
+                // Atlases are accounted as a whole (see `tig_art_atlas_alloc`).
+                if (tig_art_cache_entries[cache_entry_index].atlas_slots[palette][rotation][frame].atlas == TIG_ART_ATLAS_NONE) {
+                    video_memory_size += vb_create_info.width * vb_create_info.height * tig_art_bytes_per_pixel;
+                }
             }
 
             tig_art_cache_entries[cache_entry_index].dirty[palette][rotation] = 1;
@@ -2907,8 +4102,7 @@ int art_get_video_buffer(int cache_entry_index, tig_art_id_t art_id, TigVideoBuf
     tig_art_cache_entries[cache_entry_index].system_memory_usage += system_memory_size;
     tig_art_cache_entries[cache_entry_index].video_memory_usage += video_memory_size;
 
-    tig_art_available_system_memory -= system_memory_size;
-    tig_art_available_video_memory -= video_memory_size;
+    tig_art_cache_entry_account(cache_entry_index, system_memory_size, video_memory_size);
 
     return TIG_OK;
 }
@@ -2916,7 +4110,7 @@ int art_get_video_buffer(int cache_entry_index, tig_art_id_t art_id, TigVideoBuf
 // 0x505940
 int sub_505940(unsigned int art_blt_flags, unsigned int* vb_blt_flags_ptr)
 {
-    if ((art_blt_flags & 0x1802C) != 0) {
+    if ((art_blt_flags & 0x1800C) != 0) {
         return TIG_ERR_INVALID_PARAM;
     }
 
@@ -2934,6 +4128,10 @@ int sub_505940(unsigned int art_blt_flags, unsigned int* vb_blt_flags_ptr)
         *vb_blt_flags_ptr |= TIG_VIDEO_BUFFER_BLIT_BLEND_ADD;
     }
 
+    if ((art_blt_flags & TIG_ART_BLT_BLEND_SUB) != 0) {
+        *vb_blt_flags_ptr |= TIG_VIDEO_BUFFER_BLIT_BLEND_SUB;
+    }
+
     if ((art_blt_flags & TIG_ART_BLT_BLEND_MUL) != 0) {
         *vb_blt_flags_ptr |= TIG_VIDEO_BUFFER_BLIT_BLEND_MUL;
     }
@@ -3011,7 +4209,7 @@ int sub_5059F0(int cache_entry_index, TigArtBlitInfo* blit_info)
     frame = tig_art_id_frame_get(blit_info->art_id);
     palette = tig_art_id_palette_get(blit_info->art_id);
 
-    src_pixels = tig_art_cache_entries[cache_entry_index].pixels_tbl[rotation][frame];
+    src_pixels = art_frame_pixels(&(tig_art_cache_entries[cache_entry_index]), rotation, frame, &tig_art_scratch);
     width = tig_art_cache_entries[cache_entry_index].hdr.frames_tbl[rotation][frame].width;
     height = tig_art_cache_entries[cache_entry_index].hdr.frames_tbl[rotation][frame].height;
 
@@ -3109,6 +4307,36 @@ int sub_5059F0(int cache_entry_index, TigArtBlitInfo* blit_info)
 int art_blit(int cache_entry_index, TigArtBlitInfo* blit_info)
 {
     TigVideoBufferData video_buffer_data;
+    int rc;
+
+    rc = tig_video_buffer_lock(blit_info->dst_video_buffer);
+    if (rc != TIG_OK) {
+        return rc;
+    }
+
+    rc = tig_video_buffer_data(blit_info->dst_video_buffer, &video_buffer_data);
+    if (rc != TIG_OK) {
+        tig_video_buffer_unlock(blit_info->dst_video_buffer);
+        return rc;
+    }
+
+    art_blit_rows(cache_entry_index, blit_info, &video_buffer_data, 0, video_buffer_data.height, &tig_art_scratch);
+
+    tig_video_buffer_unlock(blit_info->dst_video_buffer);
+
+    return TIG_OK;
+}
+
+// Blits art into locked destination, only destination rows from `min_y` up
+// to (but not including) `max_y` are written. Source rows and blending
+// state advance over the rows which are not written exactly like they do
+// over written ones, so blitting all bands of the destination separately
+// gives the same result as blitting it at once.
+//
+// Does not touch shared state other than art cache entry, so that it can be
+// called by several threads simultaneously with different `scratch`.
+void art_blit_rows(int cache_entry_index, TigArtBlitInfo* blit_info, TigVideoBufferData* video_buffer_data, int min_y, int max_y, TigArtScratch* scratch)
+{
     TigArtCacheEntry* art;
     TigArtFileFrameData* frm;
     TigPalette plt;
@@ -3116,7 +4344,6 @@ int art_blit(int cache_entry_index, TigArtBlitInfo* blit_info)
     TigRect src_rect;
     TigRect dst_rect;
     TigRect tmp_rect;
-    int rc;
     int rotation;
     int frame;
     int palette;
@@ -3127,37 +4354,19 @@ int art_blit(int cache_entry_index, TigArtBlitInfo* blit_info)
     int height;
     uint8_t* dst_pixels;
     int dst_skip;
-    int x;
-    int y;
+    int min_row;
+    int max_row;
     bool stretched;
-    float width_ratio;
-    float height_ratio;
-    float start_alpha_vertical_step;
-    float end_alpha_vertical_step;
+    int width_ratio;
+    int height_ratio;
     float start_alpha_x;
     float end_alpha_x;
     float alpha_range;
-    float start_alpha;
-    float end_alpha;
-    float current_alpha;
-    float alpha_horizontal_step;
-    uint32_t* mask;
     unsigned int flip;
-    int src_checkerboard_cur_x;
-    int src_checkerboard_cur_y;
-    int dst_checkerboard_cur_x;
-    int dst_checkerboard_cur_y;
-
-    rc = tig_video_buffer_lock(blit_info->dst_video_buffer);
-    if (rc != TIG_OK) {
-        return rc;
-    }
-
-    rc = tig_video_buffer_data(blit_info->dst_video_buffer, &video_buffer_data);
-    if (rc != TIG_OK) {
-        tig_video_buffer_unlock(blit_info->dst_video_buffer);
-        return rc;
-    }
+    int color;
+    int op;
+    ArtBlitKernel* kernel;
+    ArtBlitKernelArgs args;
 
     rotation = tig_art_id_rotation_get(blit_info->art_id);
     frame = tig_art_id_frame_get(blit_info->art_id);
@@ -3171,8 +4380,8 @@ int art_blit(int cache_entry_index, TigArtBlitInfo* blit_info)
 
         // NOTE: Original code does not initialize these values, but we have
         // to keep compiler happy.
-        width_ratio = 1;
-        height_ratio = 1;
+        width_ratio = TIG_FIXED_ONE;
+        height_ratio = TIG_FIXED_ONE;
     } else {
         stretched = true;
 
@@ -3194,33 +4403,55 @@ int art_blit(int cache_entry_index, TigArtBlitInfo* blit_info)
             }
         }
 
-        width_ratio = (float)blit_info->src_rect->width / (float)blit_info->dst_rect->width;
-        height_ratio = (float)blit_info->src_rect->height / (float)blit_info->dst_rect->height;
+        // 16.16 fixed-point source to destination ratios.
+        width_ratio = tig_fixed_ratio(blit_info->src_rect->width, blit_info->dst_rect->width);
+        height_ratio = tig_fixed_ratio(blit_info->src_rect->height, blit_info->dst_rect->height);
+    }
+
+    flip = blit_info->flags & (TIG_ART_BLT_FLIP_X | TIG_ART_BLT_FLIP_Y);
+    if ((tig_art_id_flags_get(blit_info->art_id) & 1) != 0) {
+        if ((flip & TIG_ART_BLT_FLIP_X) != 0) {
+            flip &= ~TIG_ART_BLT_FLIP_X;
+        } else {
+            flip |= TIG_ART_BLT_FLIP_X;
+        }
     }
 
     src_pixels = art->pixels_tbl[rotation][frame];
     width = frm->width;
     height = frm->height;
 
-    bounds.x = 0;
-    bounds.y = 0;
-    bounds.width = width;
-    bounds.height = height;
+    // Transparent borders of the frame are not blitted at all. This is only
+    // done when source and destination rectangles are in one-to-one
+    // correspondence and the result does not depend on blitted area size.
+    if (!stretched
+        && (flip & TIG_ART_BLT_FLIP_Y) == 0
+        && (blit_info->flags & (TIG_ART_BLT_BLEND_ALPHA_LERP_X | TIG_ART_BLT_BLEND_ALPHA_LERP_Y | TIG_ART_BLT_BLEND_ALPHA_LERP_BOTH)) == 0
+        && art->bounds_tbl[rotation] != NULL) {
+        bounds = art->bounds_tbl[rotation][frame];
+        if ((flip & TIG_ART_BLT_FLIP_X) != 0) {
+            bounds.x = width - bounds.x - bounds.width;
+        }
+    } else {
+        bounds.x = 0;
+        bounds.y = 0;
+        bounds.width = width;
+        bounds.height = height;
+    }
 
     if (tig_rect_intersection(blit_info->src_rect, &bounds, &src_rect) != TIG_OK) {
-        // Specified source rectangle is out of bounds of the frame, there is
-        // nothing to blit.
-        tig_video_buffer_unlock(blit_info->dst_video_buffer);
-        return TIG_OK;
+        // Specified source rectangle is out of bounds of the frame (or its
+        // non-transparent area), there is nothing to blit.
+        return;
     }
 
     tmp_rect = *blit_info->dst_rect;
 
     if (stretched) {
-        tmp_rect.x += (int)((float)(src_rect.x - blit_info->src_rect->x) / width_ratio);
-        tmp_rect.y += (int)((float)(src_rect.y - blit_info->src_rect->y) / height_ratio);
-        tmp_rect.width -= (int)((float)(blit_info->src_rect->width - src_rect.width) / width_ratio);
-        tmp_rect.height -= (int)((float)(blit_info->src_rect->height - src_rect.height) / height_ratio);
+        tmp_rect.x += tig_fixed_div(src_rect.x - blit_info->src_rect->x, width_ratio);
+        tmp_rect.y += tig_fixed_div(src_rect.y - blit_info->src_rect->y, height_ratio);
+        tmp_rect.width -= tig_fixed_div(blit_info->src_rect->width - src_rect.width, width_ratio);
+        tmp_rect.height -= tig_fixed_div(blit_info->src_rect->height - src_rect.height, height_ratio);
     } else {
         tmp_rect.x += src_rect.x - blit_info->src_rect->x;
         tmp_rect.y += src_rect.y - blit_info->src_rect->y;
@@ -3230,21 +4461,20 @@ int art_blit(int cache_entry_index, TigArtBlitInfo* blit_info)
 
     bounds.x = 0;
     bounds.y = 0;
-    bounds.width = video_buffer_data.width;
-    bounds.height = video_buffer_data.height;
+    bounds.width = video_buffer_data->width;
+    bounds.height = video_buffer_data->height;
 
     if (tig_rect_intersection(&tmp_rect, &bounds, &dst_rect) != TIG_OK) {
         // Specified destination rectangle is out of bounds of destination
         // video buffer bounds, there is nothing to blit.
-        tig_video_buffer_unlock(blit_info->dst_video_buffer);
-        return TIG_OK;
+        return;
     }
 
     if (stretched) {
-        src_rect.x += (int)((float)(dst_rect.x - tmp_rect.x) / width_ratio);
-        src_rect.y += (int)((float)(dst_rect.y - tmp_rect.y) / height_ratio);
-        src_rect.width -= (int)((float)(tmp_rect.width - dst_rect.width) / width_ratio);
-        src_rect.height -= (int)((float)(tmp_rect.height - dst_rect.height) / height_ratio);
+        src_rect.x += tig_fixed_div(dst_rect.x - tmp_rect.x, width_ratio);
+        src_rect.y += tig_fixed_div(dst_rect.y - tmp_rect.y, height_ratio);
+        src_rect.width -= tig_fixed_div(tmp_rect.width - dst_rect.width, width_ratio);
+        src_rect.height -= tig_fixed_div(tmp_rect.height - dst_rect.height, height_ratio);
     } else {
         src_rect.x += dst_rect.x - tmp_rect.x;
         src_rect.y += dst_rect.y - tmp_rect.y;
@@ -3252,6 +4482,13 @@ int art_blit(int cache_entry_index, TigArtBlitInfo* blit_info)
         src_rect.height -= tmp_rect.height - dst_rect.height;
     }
 
+    // Rows of the destination rect within the band.
+    min_row = min_y > dst_rect.y ? min_y - dst_rect.y : 0;
+    max_row = max_y < dst_rect.y + dst_rect.height ? max_y - dst_rect.y : dst_rect.height;
+    if (min_row >= max_row) {
+        return;
+    }
+
     if ((blit_info->flags & TIG_ART_BLT_PALETTE_OVERRIDE) != 0) {
         plt = blit_info->palette;
     } else if ((blit_info->flags & TIG_ART_BLT_PALETTE_ORIGINAL) != 0) {
@@ -3270,34 +4507,44 @@ int art_blit(int cache_entry_index, TigArtBlitInfo* blit_info)
 
     switch (tig_art_bits_per_pixel) {
     case 16:
-        dst_pixels = (uint8_t*)video_buffer_data.surface_data.pixels + video_buffer_data.pitch * dst_rect.y + 2 * dst_rect.x;
-        dst_skip = video_buffer_data.pitch - dst_rect.width * 2;
+        dst_pixels = (uint8_t*)video_buffer_data->surface_data.pixels + video_buffer_data->pitch * dst_rect.y + 2 * dst_rect.x;
+        dst_skip = video_buffer_data->pitch - dst_rect.width * 2;
         break;
     case 24:
-        dst_pixels = (uint8_t*)video_buffer_data.surface_data.pixels + video_buffer_data.pitch * dst_rect.y + 3 * dst_rect.x;
-        dst_skip = video_buffer_data.pitch - dst_rect.width * 3;
+        dst_pixels = (uint8_t*)video_buffer_data->surface_data.pixels + video_buffer_data->pitch * dst_rect.y + 3 * dst_rect.x;
+        dst_skip = video_buffer_data->pitch - dst_rect.width * 3;
         break;
     case 32:
-        dst_pixels = (uint8_t*)video_buffer_data.surface_data.pixels + video_buffer_data.pitch * dst_rect.y + 4 * dst_rect.x;
-        dst_skip = video_buffer_data.pitch - dst_rect.width * 4;
+        dst_pixels = (uint8_t*)video_buffer_data->surface_data.pixels + video_buffer_data->pitch * dst_rect.y + 4 * dst_rect.x;
+        dst_skip = video_buffer_data->pitch - dst_rect.width * 4;
         break;
     default:
         // Should be unreachable.
         abort();
     }
 
-    src_checkerboard_cur_x = src_rect.x;
-    src_checkerboard_cur_y = src_rect.y;
-    dst_checkerboard_cur_x = dst_rect.x;
-    dst_checkerboard_cur_y = dst_rect.y;
+    // Unstretched frames are blitted span by span, so that transparent
+    // pixels are skipped entirely. Modes which depend on pixel position (and
+    // stretching) are handled by per-pixel blit kernels below.
+    if (!stretched
+        && art_blit_spans((art->flags & TIG_ART_CACHE_ENTRY_RLE) != 0 ? src_pixels : art->spans_tbl[rotation][frame],
+            (art->flags & TIG_ART_CACHE_ENTRY_RLE) != 0 ? NULL : src_pixels,
+            width,
+            height,
+            &src_rect,
+            &dst_rect,
+            min_row,
+            max_row,
+            flip,
+            plt,
+            dst_pixels,
+            video_buffer_data->pitch,
+            blit_info)) {
+        return;
+    }
 
-    flip = blit_info->flags & (TIG_ART_BLT_FLIP_X | TIG_ART_BLT_FLIP_Y);
-    if ((tig_art_id_flags_get(blit_info->art_id) & 1) != 0) {
-        if ((flip & TIG_ART_BLT_FLIP_X) != 0) {
-            flip &= ~TIG_ART_BLT_FLIP_X;
-        } else {
-            flip |= TIG_ART_BLT_FLIP_X;
-        }
+    if ((art->flags & TIG_ART_CACHE_ENTRY_RLE) != 0) {
+        src_pixels = art_frame_pixels(art, rotation, frame, scratch);
     }
 
     switch (flip) {
@@ -3339,2380 +4586,2758 @@ int art_blit(int cache_entry_index, TigArtBlitInfo* blit_info)
         break;
     }
 
-    if (stretched) {
-        float width_error;
-        float height_error;
-        uint8_t* prev_src_pixels = src_pixels;
-
-        if ((blit_info->flags & TIG_ART_BLT_BLEND_COLOR_CONST) != 0) {
-            if ((blit_info->flags & TIG_ART_BLT_BLEND_ADD) != 0) {
-                // 0x5126AA
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    height_error = 0.5f;
-                    for (y = 0; y < dst_rect.height; y++) {
-                        width_error = 0.5f;
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (*src_pixels != 0) {
-                                uint32_t color = tig_color_mul(((uint32_t*)plt)[*src_pixels], blit_info->color);
-                                *(uint32_t*)dst_pixels = tig_color_add(*(uint32_t*)dst_pixels, color);
-                            }
-
-                            width_error += width_ratio;
-                            while (width_error > 1.0f) {
-                                src_pixels += src_step;
-                                width_error -= 1.0f;
-                            }
-
-                            dst_pixels += 4;
-                        }
+    art_blit_mode(blit_info->flags, &color, &op);
+
+    kernel = art_blit_kernel_find(stretched, color, op);
+    if (kernel != NULL) {
+        args.blit_info = blit_info;
+        args.plt = (uint32_t*)plt;
+        args.src_pixels = src_pixels;
+        args.src_pitch = src_pitch;
+        args.src_step = src_step;
+        args.dst_pixels = dst_pixels;
+        args.dst_skip = dst_skip;
+        args.src_rect = src_rect;
+        args.dst_rect = dst_rect;
+        args.min_row = min_row;
+        args.max_row = max_row;
+
+        if (stretched) {
+            // Source steps are precomputed once, so that every row reuses
+            // them.
+            art_blit_stretch_steps(width_ratio, dst_rect.width, height_ratio, dst_rect.height, scratch, &(args.col_steps), &(args.row_steps));
+        } else {
+            args.col_steps = NULL;
+            args.row_steps = NULL;
+        }
 
-                        src_pixels = prev_src_pixels;
-                        height_error += height_ratio;
-                        while (height_error > 1.0f) {
-                            src_pixels += src_pitch;
-                            height_error -= 1.0f;
-                        }
-                        prev_src_pixels = src_pixels;
+        if (op == ART_BLIT_OP_ALPHA_LERP) {
+            switch (blit_info->flags & TIG_ART_BLT_BLEND_ALPHA_LERP_ANY) {
+            case TIG_ART_BLT_BLEND_ALPHA_LERP_X:
+                args.start_alpha_vertical_step = 0.0;
+                args.end_alpha_vertical_step = 0.0;
+                start_alpha_x = (float)src_rect.x;
+                end_alpha_x = (float)(width - src_rect.width - src_rect.x);
+                alpha_range = ((float)blit_info->alpha[1] - (float)blit_info->alpha[0]) / width;
+                args.start_alpha = (float)blit_info->alpha[0] + start_alpha_x * alpha_range;
+                args.end_alpha = (float)blit_info->alpha[1] - end_alpha_x * alpha_range;
+                break;
+            case TIG_ART_BLT_BLEND_ALPHA_LERP_Y:
+                args.start_alpha_vertical_step = ((float)blit_info->alpha[3] - (float)blit_info->alpha[0]) / height;
+                args.end_alpha_vertical_step = args.start_alpha_vertical_step;
+                args.start_alpha = src_rect.y * args.start_alpha_vertical_step + (float)blit_info->alpha[0];
+                args.end_alpha = args.start_alpha;
+                break;
+            default:
+                args.start_alpha_vertical_step = ((float)blit_info->alpha[3] - (float)blit_info->alpha[0]) / height;
+                args.end_alpha_vertical_step = ((float)(uint8_t)blit_info->alpha[2] - (float)blit_info->alpha[1]) / height;
+                start_alpha_x = (float)src_rect.x;
+                end_alpha_x = (float)(width - src_rect.width - src_rect.x);
+                alpha_range = ((src_rect.y * args.end_alpha_vertical_step + (float)blit_info->alpha[1]) - (src_rect.y * args.start_alpha_vertical_step + (float)blit_info->alpha[0])) / width;
+                args.start_alpha = (src_rect.y * args.start_alpha_vertical_step + (float)blit_info->alpha[0]) + start_alpha_x * alpha_range;
+                args.end_alpha = (src_rect.y * args.end_alpha_vertical_step + (float)blit_info->alpha[1]) - end_alpha_x * alpha_range;
+                break;
+            }
+        } else {
+            args.start_alpha = 0.0;
+            args.end_alpha = 0.0;
+            args.start_alpha_vertical_step = 0.0;
+            args.end_alpha_vertical_step = 0.0;
+        }
 
-                        dst_pixels += dst_skip;
-                    }
-                    break;
-                }
-            } else if ((blit_info->flags & TIG_ART_BLT_BLEND_SUB) != 0) {
-                // 0x512D13
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    height_error = 0.5f;
-                    for (y = 0; y < dst_rect.height; y++) {
-                        width_error = 0.5f;
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (*src_pixels != 0) {
-                                *(uint32_t*)dst_pixels = tig_color_sub(tig_color_mul(((uint32_t*)plt)[*src_pixels], blit_info->color),
-                                    *(uint32_t*)dst_pixels);
-                            }
-
-                            width_error += width_ratio;
-                            while (width_error > 1.0f) {
-                                src_pixels += src_step;
-                                width_error -= 1.0f;
-                            }
-
-                            dst_pixels += 4;
-                        }
+        kernel(&args);
+    }
 
-                        src_pixels = prev_src_pixels;
-                        height_error += height_ratio;
-                        while (height_error > 1.0f) {
-                            src_pixels += src_pitch;
-                            height_error -= 1.0f;
-                        }
-                        prev_src_pixels = src_pixels;
+}
 
-                        dst_pixels += dst_skip;
-                    }
-                    break;
-                }
-            } else if ((blit_info->flags & TIG_ART_BLT_BLEND_MUL) != 0) {
-                // 0x5133CE
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    height_error = 0.5f;
-                    for (y = 0; y < dst_rect.height; y++) {
-                        width_error = 0.5f;
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (*src_pixels != 0) {
-                                uint32_t color = tig_color_mul(((uint32_t*)plt)[*src_pixels], blit_info->color);
-                                *(uint32_t*)dst_pixels = tig_color_mul(color, *(uint32_t*)dst_pixels);
-                            }
-
-                            width_error += width_ratio;
-                            while (width_error > 1.0f) {
-                                src_pixels += src_step;
-                                width_error -= 1.0f;
-                            }
-
-                            dst_pixels += 4;
-                        }
+// Calculates number of source steps to take after every destination column
+// and row of stretched blit.
+//
+// Source positions are tracked with 16.16 fixed-point error which starts in
+// the middle of the first pixel, and the source advances when the error
+// crosses the pixel boundary.
+void art_blit_stretch_steps(int width_ratio, int width, int height_ratio, int height, TigArtScratch* scratch, int** col_steps_ptr, int** row_steps_ptr)
+{
+    int* steps;
+    int error;
+    int index;
 
-                        src_pixels = prev_src_pixels;
-                        height_error += height_ratio;
-                        while (height_error > 1.0f) {
-                            src_pixels += src_pitch;
-                            height_error -= 1.0f;
-                        }
-                        prev_src_pixels = src_pixels;
+    if (scratch->stretch_steps_size < width + height) {
+        scratch->stretch_steps = (int*)REALLOC(scratch->stretch_steps, sizeof(*scratch->stretch_steps) * (width + height));
+        scratch->stretch_steps_size = width + height;
+    }
 
-                        dst_pixels += dst_skip;
-                    }
-                    break;
-                }
-            } else if ((blit_info->flags & TIG_ART_BLT_BLEND_ALPHA_AVG) != 0) {
-                // 0x513B6C
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    height_error = 0.5f;
-                    for (y = 0; y < dst_rect.height; y++) {
-                        width_error = 0.5f;
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (*src_pixels != 0) {
-                                uint32_t color = tig_color_mul(((uint32_t*)plt)[*src_pixels], blit_info->color);
-                                *(uint32_t*)dst_pixels = tig_color_blend_alpha(color,
-                                    *(uint32_t*)dst_pixels,
-                                    tig_color_rgb_to_grayscale(color));
-                            }
-
-                            width_error += width_ratio;
-                            while (width_error > 1.0f) {
-                                src_pixels += src_step;
-                                width_error -= 1.0f;
-                            }
-
-                            dst_pixels += 4;
-                        }
+    steps = scratch->stretch_steps;
+    error = TIG_FIXED_ONE / 2;
+    for (index = 0; index < width; index++) {
+        error += width_ratio;
+        steps[index] = 0;
+        if (error > TIG_FIXED_ONE) {
+            steps[index] = (error - 1) >> 16;
+            error -= steps[index] << 16;
+        }
+    }
 
-                        src_pixels = prev_src_pixels;
-                        height_error += height_ratio;
-                        while (height_error > 1.0f) {
-                            src_pixels += src_pitch;
-                            height_error -= 1.0f;
-                        }
-                        prev_src_pixels = src_pixels;
+    steps = scratch->stretch_steps + width;
+    error = TIG_FIXED_ONE / 2;
+    for (index = 0; index < height; index++) {
+        error += height_ratio;
+        steps[index] = 0;
+        if (error > TIG_FIXED_ONE) {
+            steps[index] = (error - 1) >> 16;
+            error -= steps[index] << 16;
+        }
+    }
 
-                        dst_pixels += dst_skip;
-                    }
-                    break;
-                }
-            } else if ((blit_info->flags & TIG_ART_BLT_BLEND_ALPHA_CONST) != 0) {
-                // 0x5142F4
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    height_error = 0.5f;
-                    for (y = 0; y < dst_rect.height; y++) {
-                        width_error = 0.5f;
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (*src_pixels != 0) {
-                                *(uint32_t*)dst_pixels = tig_color_blend_alpha(tig_color_mul(((uint32_t*)plt)[*src_pixels], blit_info->color),
-                                    *(uint32_t*)dst_pixels,
-                                    blit_info->alpha[0]);
-                            }
-
-                            width_error += width_ratio;
-                            while (width_error > 1.0f) {
-                                src_pixels += src_step;
-                                width_error -= 1.0f;
-                            }
-
-                            dst_pixels += 4;
-                        }
+    *col_steps_ptr = scratch->stretch_steps;
+    *row_steps_ptr = scratch->stretch_steps + width;
+}
 
-                        src_pixels = prev_src_pixels;
-                        height_error += height_ratio;
-                        while (height_error > 1.0f) {
-                            src_pixels += src_pitch;
-                            height_error -= 1.0f;
-                        }
-                        prev_src_pixels = src_pixels;
+// Resolves blending flags of `TigArtBlitInfo` into source color modulation
+// (`ART_BLIT_COLOR_*`) and operation (`ART_BLIT_OP_*`). When several flags of
+// the same kind are set the first one in the order below wins.
+void art_blit_mode(unsigned int flags, int* color_ptr, int* op_ptr)
+{
+    if ((flags & TIG_ART_BLT_BLEND_COLOR_CONST) != 0) {
+        *color_ptr = ART_BLIT_COLOR_CONST;
+    } else if ((flags & TIG_ART_BLT_BLEND_COLOR_ARRAY) != 0) {
+        *color_ptr = ART_BLIT_COLOR_ARRAY;
+    } else if ((flags & TIG_ART_BLT_BLEND_COLOR_LERP) != 0) {
+        *color_ptr = ART_BLIT_COLOR_LERP;
+    } else {
+        *color_ptr = ART_BLIT_COLOR_NONE;
+    }
+
+    if ((flags & TIG_ART_BLT_BLEND_ADD) != 0) {
+        *op_ptr = ART_BLIT_OP_ADD;
+    } else if ((flags & TIG_ART_BLT_BLEND_SUB) != 0) {
+        *op_ptr = ART_BLIT_OP_SUB;
+    } else if ((flags & TIG_ART_BLT_BLEND_MUL) != 0) {
+        *op_ptr = ART_BLIT_OP_MUL;
+    } else if ((flags & TIG_ART_BLT_BLEND_ALPHA_AVG) != 0) {
+        *op_ptr = ART_BLIT_OP_ALPHA_AVG;
+    } else if ((flags & TIG_ART_BLT_BLEND_ALPHA_CONST) != 0) {
+        *op_ptr = ART_BLIT_OP_ALPHA_CONST;
+    } else if ((flags & TIG_ART_BLT_BLEND_ALPHA_SRC) != 0) {
+        *op_ptr = ART_BLIT_OP_ALPHA_SRC;
+    } else if ((flags & TIG_ART_BLT_BLEND_ALPHA_LERP_ANY) != 0) {
+        *op_ptr = ART_BLIT_OP_ALPHA_LERP;
+    } else if ((flags & TIG_ART_BLT_BLEND_ALPHA_STIPPLE_S) != 0) {
+        *op_ptr = ART_BLIT_OP_STIPPLE_S;
+    } else if ((flags & TIG_ART_BLT_BLEND_ALPHA_STIPPLE_D) != 0) {
+        *op_ptr = ART_BLIT_OP_STIPPLE_D;
+    } else {
+        *op_ptr = ART_BLIT_OP_COPY;
+    }
+}
 
-                        dst_pixels += dst_skip;
-                    }
-                    break;
-                }
-            } else if ((blit_info->flags & TIG_ART_BLT_BLEND_ALPHA_SRC) != 0) {
-                // 0x5154ED
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    height_error = 0.5f;
-                    for (y = 0; y < dst_rect.height; y++) {
-                        width_error = 0.5f;
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (*src_pixels != 0) {
-                                *(uint32_t*)dst_pixels = tig_color_blend_alpha(blit_info->color,
-                                    *(uint32_t*)dst_pixels,
-                                    tig_color_alpha(((uint32_t*)plt)[*src_pixels]));
-                            }
-
-                            width_error += width_ratio;
-                            while (width_error > 1.0f) {
-                                src_pixels += src_step;
-                                width_error -= 1.0f;
-                            }
-
-                            dst_pixels += 4;
-                        }
+// Generic per-pixel blit of 32 bpp destination. It is never called directly,
+// instead `ART_BLIT_KERNEL` instantiates it for every combination of
+// constant `stretched`, `color` and `op`, so that the compiler drops all
+// branches on them from the loops.
+//
+// NOTE: Stretched blits reset destination checkerboard of
+// `ART_BLIT_OP_STIPPLE_D` to the source rect at the end of every row, this
+// quirk is preserved.
+SDL_FORCE_INLINE void art_blit_kernel(ArtBlitKernelArgs* args, bool stretched, int color, int op)
+{
+    TigArtBlitInfo* blit_info = args->blit_info;
+    const uint32_t* plt = args->plt;
+    uint8_t* src_pixels = args->src_pixels;
+    uint8_t* prev_src_pixels = src_pixels;
+    uint8_t* dst_pixels = args->dst_pixels;
+    const uint32_t* mask = NULL;
+    float start_alpha = args->start_alpha;
+    float end_alpha = args->end_alpha;
+    float current_alpha = 0.0;
+    float alpha_horizontal_step = 0.0;
+    int src_checkerboard_cur_x = args->src_rect.x;
+    int src_checkerboard_cur_y = args->src_rect.y;
+    int dst_checkerboard_cur_x = args->dst_rect.x;
+    int dst_checkerboard_cur_y = args->dst_rect.y;
+    int col_step;
+    int row_step;
+    int x;
+    int y;
+    bool visible;
+    uint32_t src_color;
+    uint32_t dst_color;
 
-                        src_pixels = prev_src_pixels;
-                        height_error += height_ratio;
-                        while (height_error > 1.0f) {
-                            src_pixels += src_pitch;
-                            height_error -= 1.0f;
-                        }
-                        prev_src_pixels = src_pixels;
+    for (y = 0; y < args->max_row; y++) {
+        row_step = stretched ? args->row_steps[y] : 1;
 
-                        dst_pixels += dst_skip;
-                    }
-                    break;
-                }
-            } else if ((blit_info->flags & TIG_ART_BLT_BLEND_ALPHA_LERP_ANY) != 0) {
-                // 0x5159AA
-                switch (blit_info->flags & TIG_ART_BLT_BLEND_ALPHA_LERP_ANY) {
-                case TIG_ART_BLT_BLEND_ALPHA_LERP_X:
-                    start_alpha_vertical_step = 0.0;
-                    end_alpha_vertical_step = 0.0;
-                    start_alpha_x = (float)src_rect.x;
-                    end_alpha_x = (float)(width - src_rect.width - src_rect.x);
-                    alpha_range = ((float)blit_info->alpha[1] - (float)blit_info->alpha[0]) / width;
-                    start_alpha = (float)blit_info->alpha[0] + start_alpha_x * alpha_range;
-                    end_alpha = (float)blit_info->alpha[1] - end_alpha_x * alpha_range;
-                    break;
-                case TIG_ART_BLT_BLEND_ALPHA_LERP_Y:
-                    start_alpha_vertical_step = ((float)blit_info->alpha[3] - (float)blit_info->alpha[0]) / height;
-                    end_alpha_vertical_step = start_alpha_vertical_step;
-                    start_alpha = src_rect.y * start_alpha_vertical_step + (float)blit_info->alpha[0];
-                    end_alpha = start_alpha;
-                    break;
-                default:
-                    start_alpha_vertical_step = ((float)blit_info->alpha[3] - (float)blit_info->alpha[0]) / height;
-                    end_alpha_vertical_step = ((float)(uint8_t)blit_info->alpha[2] - (float)blit_info->alpha[1]) / height;
-                    start_alpha_x = (float)src_rect.x;
-                    end_alpha_x = (float)(width - src_rect.width - src_rect.x);
-                    alpha_range = ((src_rect.y * end_alpha_vertical_step + (float)blit_info->alpha[1]) - (src_rect.y * start_alpha_vertical_step + (float)blit_info->alpha[0])) / width;
-                    start_alpha = (src_rect.y * start_alpha_vertical_step + (float)blit_info->alpha[0]) + start_alpha_x * alpha_range;
-                    end_alpha = (src_rect.y * end_alpha_vertical_step + (float)blit_info->alpha[1]) - end_alpha_x * alpha_range;
-                    break;
-                }
+        if (color == ART_BLIT_COLOR_ARRAY) {
+            mask = &(blit_info->field_14[args->src_rect.x]);
+        }
 
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    height_error = 0.5f;
-                    for (y = 0; y < dst_rect.height; y++) {
-                        current_alpha = start_alpha;
-                        alpha_horizontal_step = (end_alpha - start_alpha) / src_rect.width;
-
-                        width_error = 0.5f;
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (*src_pixels != 0) {
-                                *(uint32_t*)dst_pixels = tig_color_blend_alpha(tig_color_mul(((uint32_t*)plt)[*src_pixels], blit_info->color),
-                                    *(uint32_t*)dst_pixels,
-                                    (int)current_alpha);
-                            }
-
-                            width_error += width_ratio;
-                            while (width_error > 1.0f) {
-                                src_pixels += src_step;
-                                current_alpha += alpha_horizontal_step;
-                                width_error -= 1.0f;
-                            }
-
-                            dst_pixels += 4;
-                        }
+        if (op == ART_BLIT_OP_ALPHA_LERP) {
+            current_alpha = start_alpha;
+            alpha_horizontal_step = (end_alpha - start_alpha) / args->src_rect.width;
+        }
 
-                        src_pixels = prev_src_pixels;
-                        height_error += height_ratio;
-                        while (height_error > 1.0f) {
-                            src_pixels += src_pitch;
-                            start_alpha += start_alpha_vertical_step;
-                            end_alpha += end_alpha_vertical_step;
-                            height_error -= 1.0f;
-                        }
-                        prev_src_pixels = src_pixels;
+        if (y < args->min_row) {
+            // Row above the band, only the source and destination move.
+            if (!stretched) {
+                src_pixels += args->src_step * args->dst_rect.width;
+            }
+            dst_pixels += 4 * args->dst_rect.width;
+        } else {
+            for (x = 0; x < args->dst_rect.width; x++) {
+                col_step = stretched ? args->col_steps[x] : 1;
 
-                        dst_pixels += dst_skip;
-                    }
-                    break;
+                if (op == ART_BLIT_OP_STIPPLE_S) {
+                    visible = ((src_checkerboard_cur_x ^ src_checkerboard_cur_y) & 1) != 0;
+                } else if (op == ART_BLIT_OP_STIPPLE_D) {
+                    visible = ((dst_checkerboard_cur_x ^ dst_checkerboard_cur_y) & 1) != 0;
+                } else {
+                    visible = true;
                 }
-            } else if ((blit_info->flags & TIG_ART_BLT_BLEND_ALPHA_STIPPLE_S) != 0) {
-                // 0x5149B1
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    height_error = 0.5f;
-                    for (y = 0; y < dst_rect.height; y++) {
-                        width_error = 0.5f;
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (((src_checkerboard_cur_x ^ src_checkerboard_cur_y) & 1) != 0) {
-                                if (*src_pixels != 0) {
-                                    *(uint32_t*)dst_pixels = tig_color_mul(((uint32_t*)plt)[*src_pixels], blit_info->color);
-                                }
-                            }
-
-                            width_error += width_ratio;
-                            while (width_error > 1.0f) {
-                                src_pixels += src_step;
-                                src_checkerboard_cur_x++;
-                                width_error -= 1.0f;
-                            }
-
-                            dst_pixels += 4;
-                        }
 
-                        src_pixels = prev_src_pixels;
-                        height_error += height_ratio;
-                        while (height_error > 1.0f) {
-                            src_pixels += src_pitch;
-                            src_checkerboard_cur_y++;
-                            height_error -= 1.0f;
-                        }
-                        prev_src_pixels = src_pixels;
-
-                        dst_pixels += dst_skip;
-                        src_checkerboard_cur_x = src_rect.x;
+                if (visible && *src_pixels != 0) {
+                    if (color == ART_BLIT_COLOR_CONST) {
+                        src_color = tig_color_mul(plt[*src_pixels], blit_info->color);
+                    } else if (color == ART_BLIT_COLOR_ARRAY) {
+                        src_color = tig_color_mul(plt[*src_pixels], *mask);
+                    } else {
+                        src_color = plt[*src_pixels];
                     }
-                    break;
-                }
-            } else if ((blit_info->flags & TIG_ART_BLT_BLEND_ALPHA_STIPPLE_D) != 0) {
-                // 0x514F50
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    height_error = 0.5f;
-                    for (y = 0; y < dst_rect.height; y++) {
-                        width_error = 0.5f;
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (((dst_checkerboard_cur_x ^ dst_checkerboard_cur_y) & 1) != 0) {
-                                if (*src_pixels != 0) {
-                                    *(uint32_t*)dst_pixels = tig_color_mul(((uint32_t*)plt)[*src_pixels], blit_info->color);
-                                }
-                            }
-
-                            width_error += width_ratio;
-                            while (width_error > 1.0f) {
-                                src_pixels += src_step;
-                                dst_checkerboard_cur_x++;
-                                width_error -= 1.0f;
-                            }
-
-                            dst_pixels += 4;
-                        }
 
-                        src_pixels = prev_src_pixels;
-                        height_error += height_ratio;
-                        while (height_error > 1.0f) {
-                            src_pixels += src_pitch;
-                            dst_checkerboard_cur_y++;
-                            height_error -= 1.0f;
+                    dst_color = *(uint32_t*)dst_pixels;
+
+                    switch (op) {
+                    case ART_BLIT_OP_ADD:
+                        dst_color = tig_color_add(src_color, dst_color);
+                        break;
+                    case ART_BLIT_OP_SUB:
+                        dst_color = tig_color_sub(src_color, dst_color);
+                        break;
+                    case ART_BLIT_OP_MUL:
+                        dst_color = tig_color_mul(src_color, dst_color);
+                        break;
+                    case ART_BLIT_OP_ALPHA_AVG:
+                        dst_color = tig_color_blend_alpha(src_color, dst_color, tig_color_rgb_to_grayscale(src_color));
+                        break;
+                    case ART_BLIT_OP_ALPHA_CONST:
+                        dst_color = tig_color_blend_alpha(src_color, dst_color, blit_info->alpha[0]);
+                        break;
+                    case ART_BLIT_OP_ALPHA_SRC:
+                        // Modulation color (rather than modulated source color)
+                        // is blended using source alpha.
+                        if (color == ART_BLIT_COLOR_CONST) {
+                            src_color = blit_info->color;
+                        } else if (color == ART_BLIT_COLOR_ARRAY) {
+                            src_color = *mask;
                         }
-                        prev_src_pixels = src_pixels;
-
-                        dst_pixels += dst_skip;
-                        dst_checkerboard_cur_x = src_rect.x;
+                        dst_color = tig_color_blend_alpha(src_color, dst_color, tig_color_alpha(plt[*src_pixels]));
+                        break;
+                    case ART_BLIT_OP_ALPHA_LERP:
+                        dst_color = tig_color_blend_alpha(src_color, dst_color, (int)current_alpha);
+                        break;
+                    default:
+                        dst_color = src_color;
+                        break;
                     }
-                    break;
-                }
-            } else {
-                // 0x516235
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    height_error = 0.5f;
-                    for (y = 0; y < dst_rect.height; y++) {
-                        width_error = 0.5f;
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (*src_pixels != 0) {
-                                *(uint32_t*)dst_pixels = tig_color_mul(((uint32_t*)plt)[*src_pixels], blit_info->color);
-                            }
-
-                            width_error += width_ratio;
-                            while (width_error > 1.0f) {
-                                src_pixels += src_step;
-                                width_error -= 1.0f;
-                            }
-
-                            dst_pixels += 4;
-                        }
-
-                        src_pixels = prev_src_pixels;
-                        height_error += height_ratio;
-                        while (height_error > 1.0f) {
-                            src_pixels += src_pitch;
-                            height_error -= 1.0f;
-                        }
-                        prev_src_pixels = src_pixels;
 
-                        dst_pixels += dst_skip;
-                    }
-                    break;
+                    *(uint32_t*)dst_pixels = dst_color;
                 }
-            }
-        } else if ((blit_info->flags & TIG_ART_BLT_BLEND_COLOR_ARRAY) != 0) {
-            if ((blit_info->flags & TIG_ART_BLT_BLEND_ADD) != 0) {
-                // 0x516765
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    height_error = 0.5f;
-                    for (y = 0; y < dst_rect.height; y++) {
-                        mask = &(blit_info->field_14[src_rect.x]);
-
-                        width_error = 0.5f;
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (*src_pixels != 0) {
-                                uint32_t color = tig_color_mul(((uint32_t*)plt)[*src_pixels], *mask);
-                                *(uint32_t*)dst_pixels = tig_color_add(*(uint32_t*)dst_pixels, color);
-                            }
-
-                            width_error += width_ratio;
-                            while (width_error > 1.0f) {
-                                mask++;
-                                src_pixels += src_step;
-                                width_error -= 1.0f;
-                            }
-
-                            dst_pixels += 4;
-                        }
-
-                        src_pixels = prev_src_pixels;
-                        height_error += height_ratio;
-                        while (height_error > 1.0f) {
-                            src_pixels += src_pitch;
-                            height_error -= 1.0f;
-                        }
-                        prev_src_pixels = src_pixels;
 
-                        dst_pixels += dst_skip;
-                    }
-                    break;
+                if (color == ART_BLIT_COLOR_ARRAY) {
+                    mask += col_step;
                 }
-            } else if ((blit_info->flags & TIG_ART_BLT_BLEND_SUB) != 0) {
-                // 0x516E0A
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    height_error = 0.5f;
-                    for (y = 0; y < dst_rect.height; y++) {
-                        mask = &(blit_info->field_14[src_rect.x]);
-
-                        width_error = 0.5f;
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (*src_pixels != 0) {
-                                *(uint32_t*)dst_pixels = tig_color_sub(tig_color_mul(((uint32_t*)plt)[*src_pixels], *mask),
-                                    *(uint32_t*)dst_pixels);
-                            }
-
-                            width_error += width_ratio;
-                            while (width_error > 1.0f) {
-                                mask++;
-                                src_pixels += src_step;
-                                width_error -= 1.0f;
-                            }
-
-                            dst_pixels += 4;
-                        }
-
-                        src_pixels = prev_src_pixels;
-                        height_error += height_ratio;
-                        while (height_error > 1.0f) {
-                            src_pixels += src_pitch;
-                            height_error -= 1.0f;
-                        }
-                        prev_src_pixels = src_pixels;
 
-                        dst_pixels += dst_skip;
-                    }
-                    break;
+                if (op == ART_BLIT_OP_ALPHA_LERP) {
+                    current_alpha += alpha_horizontal_step * col_step;
+                } else if (op == ART_BLIT_OP_STIPPLE_S) {
+                    src_checkerboard_cur_x += col_step;
+                } else if (op == ART_BLIT_OP_STIPPLE_D) {
+                    dst_checkerboard_cur_x += col_step;
                 }
-            } else if ((blit_info->flags & TIG_ART_BLT_BLEND_MUL) != 0) {
-                // 0x5174E0
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    height_error = 0.5f;
-                    for (y = 0; y < dst_rect.height; y++) {
-                        mask = &(blit_info->field_14[src_rect.x]);
-
-                        width_error = 0.5f;
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (*src_pixels != 0) {
-                                uint32_t color = tig_color_mul(((uint32_t*)plt)[*src_pixels], *mask);
-                                *(uint32_t*)dst_pixels = tig_color_mul(color, *(uint32_t*)dst_pixels);
-                            }
-
-                            width_error += width_ratio;
-                            while (width_error > 1.0f) {
-                                mask++;
-                                src_pixels += src_step;
-                                width_error -= 1.0f;
-                            }
-
-                            dst_pixels += 4;
-                        }
 
-                        src_pixels = prev_src_pixels;
-                        height_error += height_ratio;
-                        while (height_error > 1.0f) {
-                            src_pixels += src_pitch;
-                            height_error -= 1.0f;
-                        }
-                        prev_src_pixels = src_pixels;
+                src_pixels += args->src_step * col_step;
+                dst_pixels += 4;
+            }
+        }
 
-                        dst_pixels += dst_skip;
-                    }
-                    break;
-                }
-            } else if ((blit_info->flags & TIG_ART_BLT_BLEND_ALPHA_AVG) != 0) {
-                // 0x517CBE
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    height_error = 0.5f;
-                    for (y = 0; y < dst_rect.height; y++) {
-                        mask = &(blit_info->field_14[src_rect.x]);
-
-                        width_error = 0.5f;
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (*src_pixels != 0) {
-                                uint32_t color = tig_color_mul(((uint32_t*)plt)[*src_pixels], *mask);
-                                *(uint32_t*)dst_pixels = tig_color_blend_alpha(color,
-                                    *(uint32_t*)dst_pixels,
-                                    tig_color_rgb_to_grayscale(color));
-                            }
-
-                            width_error += width_ratio;
-                            while (width_error > 1.0f) {
-                                mask++;
-                                src_pixels += src_step;
-                                width_error -= 1.0f;
-                            }
-
-                            dst_pixels += 4;
-                        }
+        if (stretched) {
+            src_pixels = prev_src_pixels;
+            src_pixels += args->src_pitch * row_step;
+            prev_src_pixels = src_pixels;
+        } else {
+            src_pixels += args->src_pitch;
+        }
 
-                        src_pixels = prev_src_pixels;
-                        height_error += height_ratio;
-                        while (height_error > 1.0f) {
-                            src_pixels += src_pitch;
-                            height_error -= 1.0f;
-                        }
-                        prev_src_pixels = src_pixels;
+        dst_pixels += args->dst_skip;
+
+        if (op == ART_BLIT_OP_ALPHA_LERP) {
+            start_alpha += args->start_alpha_vertical_step * row_step;
+            end_alpha += args->end_alpha_vertical_step * row_step;
+        } else if (op == ART_BLIT_OP_STIPPLE_S) {
+            src_checkerboard_cur_x = args->src_rect.x;
+            src_checkerboard_cur_y += row_step;
+        } else if (op == ART_BLIT_OP_STIPPLE_D) {
+            dst_checkerboard_cur_x = stretched ? args->src_rect.x : args->dst_rect.x;
+            dst_checkerboard_cur_y += row_step;
+        }
+    }
+}
 
-                        dst_pixels += dst_skip;
-                    }
-                    break;
-                }
-            } else if ((blit_info->flags & TIG_ART_BLT_BLEND_ALPHA_CONST) != 0) {
-                // 0x518494
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    height_error = 0.5f;
-                    for (y = 0; y < dst_rect.height; y++) {
-                        mask = &(blit_info->field_14[src_rect.x]);
-
-                        width_error = 0.5f;
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (*src_pixels != 0) {
-                                uint32_t color = tig_color_mul(((uint32_t*)plt)[*src_pixels], *mask);
-                                *(uint32_t*)dst_pixels = tig_color_blend_alpha(color,
-                                    *(uint32_t*)dst_pixels,
-                                    blit_info->alpha[0]);
-                            }
-
-                            width_error += width_ratio;
-                            while (width_error > 1.0f) {
-                                mask++;
-                                src_pixels += src_step;
-                                width_error -= 1.0f;
-                            }
-
-                            dst_pixels += 4;
-                        }
+// Instantiates `art_blit_kernel` for constant arguments.
+#define ART_BLIT_KERNEL(name, stretched, color, op)  \
+    static void name(ArtBlitKernelArgs* args)        \
+    {                                                \
+        art_blit_kernel(args, stretched, color, op); \
+    }
+
+// Instantiates `art_blit_kernel` for every op, kernel names are `prefix`
+// followed by op name.
+#define ART_BLIT_KERNEL_OPS(prefix, stretched, color)                                \
+    ART_BLIT_KERNEL(prefix##_copy, stretched, color, ART_BLIT_OP_COPY)               \
+    ART_BLIT_KERNEL(prefix##_add, stretched, color, ART_BLIT_OP_ADD)                 \
+    ART_BLIT_KERNEL(prefix##_sub, stretched, color, ART_BLIT_OP_SUB)                 \
+    ART_BLIT_KERNEL(prefix##_mul, stretched, color, ART_BLIT_OP_MUL)                 \
+    ART_BLIT_KERNEL(prefix##_alpha_avg, stretched, color, ART_BLIT_OP_ALPHA_AVG)     \
+    ART_BLIT_KERNEL(prefix##_alpha_const, stretched, color, ART_BLIT_OP_ALPHA_CONST) \
+    ART_BLIT_KERNEL(prefix##_alpha_src, stretched, color, ART_BLIT_OP_ALPHA_SRC)     \
+    ART_BLIT_KERNEL(prefix##_alpha_lerp, stretched, color, ART_BLIT_OP_ALPHA_LERP)   \
+    ART_BLIT_KERNEL(prefix##_stipple_s, stretched, color, ART_BLIT_OP_STIPPLE_S)     \
+    ART_BLIT_KERNEL(prefix##_stipple_d, stretched, color, ART_BLIT_OP_STIPPLE_D)
+
+// Row of `art_blit_kernels` with kernels instantiated by
+// `ART_BLIT_KERNEL_OPS`, in `ART_BLIT_OP_*` order.
+#define ART_BLIT_KERNEL_OPS_ROW(prefix) \
+    {                                   \
+        prefix##_copy,                  \
+        prefix##_add,                   \
+        prefix##_sub,                   \
+        prefix##_mul,                   \
+        prefix##_alpha_avg,             \
+        prefix##_alpha_const,           \
+        prefix##_alpha_src,             \
+        prefix##_alpha_lerp,            \
+        prefix##_stipple_s,             \
+        prefix##_stipple_d,             \
+    }
+
+ART_BLIT_KERNEL_OPS(art_blit_kernel_none, false, ART_BLIT_COLOR_NONE)
+ART_BLIT_KERNEL_OPS(art_blit_kernel_color_const, false, ART_BLIT_COLOR_CONST)
+ART_BLIT_KERNEL_OPS(art_blit_kernel_color_array, false, ART_BLIT_COLOR_ARRAY)
+ART_BLIT_KERNEL_OPS(art_blit_kernel_stretched_none, true, ART_BLIT_COLOR_NONE)
+ART_BLIT_KERNEL_OPS(art_blit_kernel_stretched_color_const, true, ART_BLIT_COLOR_CONST)
+ART_BLIT_KERNEL_OPS(art_blit_kernel_stretched_color_array, true, ART_BLIT_COLOR_ARRAY)
+
+// Per-pixel blit kernels of 32 bpp destination indexed by stretching, color
+// modulation and op.
+//
+// Color interpolation ignores op. It is not implemented for stretched blits,
+// such blits draw nothing.
+static ArtBlitKernel* const art_blit_kernels[2][ART_BLIT_COLOR_COUNT][ART_BLIT_OP_COUNT] = {
+    {
+        ART_BLIT_KERNEL_OPS_ROW(art_blit_kernel_none),
+        ART_BLIT_KERNEL_OPS_ROW(art_blit_kernel_color_const),
+        ART_BLIT_KERNEL_OPS_ROW(art_blit_kernel_color_array),
+        {
+            art_blit_kernel_color_lerp,
+            art_blit_kernel_color_lerp,
+            art_blit_kernel_color_lerp,
+            art_blit_kernel_color_lerp,
+            art_blit_kernel_color_lerp,
+            art_blit_kernel_color_lerp,
+            art_blit_kernel_color_lerp,
+            art_blit_kernel_color_lerp,
+            art_blit_kernel_color_lerp,
+            art_blit_kernel_color_lerp,
+        },
+    },
+    {
+        ART_BLIT_KERNEL_OPS_ROW(art_blit_kernel_stretched_none),
+        ART_BLIT_KERNEL_OPS_ROW(art_blit_kernel_stretched_color_const),
+        ART_BLIT_KERNEL_OPS_ROW(art_blit_kernel_stretched_color_array),
+        { NULL },
+    },
+};
 
-                        src_pixels = prev_src_pixels;
-                        height_error += height_ratio;
-                        while (height_error > 1.0f) {
-                            src_pixels += src_pitch;
-                            height_error -= 1.0f;
-                        }
-                        prev_src_pixels = src_pixels;
+// Returns per-pixel blit kernel for the given blit mode (see
+// `art_blit_mode`), or `NULL` if the mode is not implemented for current
+// color depth.
+ArtBlitKernel* art_blit_kernel_find(bool stretched, int color, int op)
+{
+    if (tig_art_bits_per_pixel != 32) {
+        return NULL;
+    }
 
-                        dst_pixels += dst_skip;
-                    }
-                    break;
-                }
-            } else if ((blit_info->flags & TIG_ART_BLT_BLEND_ALPHA_SRC) != 0) {
-                // 0x51973D
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    height_error = 0.5f;
-                    for (y = 0; y < dst_rect.height; y++) {
-                        mask = &(blit_info->field_14[src_rect.x]);
-
-                        width_error = 0.5f;
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (*src_pixels != 0) {
-                                *(uint32_t*)dst_pixels = tig_color_blend_alpha(*mask,
-                                    *(uint32_t*)dst_pixels,
-                                    tig_color_alpha(((uint32_t*)plt)[*src_pixels]));
-                            }
-
-                            width_error += width_ratio;
-                            while (width_error > 1.0f) {
-                                mask++;
-                                src_pixels += src_step;
-                                width_error -= 1.0f;
-                            }
-
-                            dst_pixels += 4;
-                        }
+    return art_blit_kernels[stretched ? 1 : 0][color][op];
+}
 
-                        src_pixels = prev_src_pixels;
-                        height_error += height_ratio;
-                        while (height_error > 1.0f) {
-                            src_pixels += src_pitch;
-                            height_error -= 1.0f;
-                        }
-                        prev_src_pixels = src_pixels;
+// Blits unstretched frame modulating source colors by bilinear
+// interpolation of four corner colors (`field_14`) over `field_18` rect.
+//
+// 0x50F3B4
+void art_blit_kernel_color_lerp(ArtBlitKernelArgs* args)
+{
+    TigArtBlitInfo* blit_info = args->blit_info;
+    TigRect* src_rect = &(args->src_rect);
+    uint8_t* src_pixels = args->src_pixels;
+    uint8_t* dst_pixels = args->dst_pixels;
+    int x;
+    int y;
 
-                        dst_pixels += dst_skip;
-                    }
-                    break;
-                }
-            } else if ((blit_info->flags & TIG_ART_BLT_BLEND_ALPHA_LERP_ANY) != 0) {
-                // 0x519C38
-                switch (blit_info->flags & TIG_ART_BLT_BLEND_ALPHA_LERP_ANY) {
-                case TIG_ART_BLT_BLEND_ALPHA_LERP_X:
-                    start_alpha_vertical_step = 0.0;
-                    end_alpha_vertical_step = 0.0;
-                    start_alpha_x = (float)src_rect.x;
-                    end_alpha_x = (float)(width - src_rect.width - src_rect.x);
-                    alpha_range = ((float)blit_info->alpha[1] - (float)blit_info->alpha[0]) / width;
-                    start_alpha = (float)blit_info->alpha[0] + start_alpha_x * alpha_range;
-                    end_alpha = (float)blit_info->alpha[1] - end_alpha_x * alpha_range;
-                    break;
-                case TIG_ART_BLT_BLEND_ALPHA_LERP_Y:
-                    start_alpha_vertical_step = ((float)blit_info->alpha[3] - (float)blit_info->alpha[0]) / height;
-                    end_alpha_vertical_step = start_alpha_vertical_step;
-                    start_alpha = src_rect.y * start_alpha_vertical_step + (float)blit_info->alpha[0];
-                    end_alpha = start_alpha;
-                    break;
-                default:
-                    start_alpha_vertical_step = ((float)blit_info->alpha[3] - (float)blit_info->alpha[0]) / height;
-                    end_alpha_vertical_step = ((float)(uint8_t)blit_info->alpha[2] - (float)blit_info->alpha[1]) / height;
-                    start_alpha_x = (float)src_rect.x;
-                    end_alpha_x = (float)(width - src_rect.width - src_rect.x);
-                    alpha_range = ((src_rect.y * end_alpha_vertical_step + (float)blit_info->alpha[1]) - (src_rect.y * start_alpha_vertical_step + (float)blit_info->alpha[0])) / width;
-                    start_alpha = (src_rect.y * start_alpha_vertical_step + (float)blit_info->alpha[0]) + start_alpha_x * alpha_range;
-                    end_alpha = (src_rect.y * end_alpha_vertical_step + (float)blit_info->alpha[1]) - end_alpha_x * alpha_range;
-                    break;
+    int tl_r = tig_color_get_red(blit_info->field_14[0]);
+    int tl_g = tig_color_get_green(blit_info->field_14[0]);
+    int tl_b = tig_color_get_blue(blit_info->field_14[0]);
+
+    int tr_r = tig_color_get_red(blit_info->field_14[1]);
+    int tr_g = tig_color_get_green(blit_info->field_14[1]);
+    int tr_b = tig_color_get_blue(blit_info->field_14[1]);
+
+    int br_r = tig_color_get_red(blit_info->field_14[2]);
+    int br_g = tig_color_get_green(blit_info->field_14[2]);
+    int br_b = tig_color_get_blue(blit_info->field_14[2]);
+
+    int bl_r = tig_color_get_red(blit_info->field_14[3]);
+    int bl_g = tig_color_get_green(blit_info->field_14[3]);
+    int bl_b = tig_color_get_blue(blit_info->field_14[3]);
+
+    float vert_start_step_r = (float)(bl_r - tl_r) / blit_info->field_18->height;
+    float vert_start_r = vert_start_step_r * (src_rect->y - blit_info->field_18->y) + tl_r;
+    float vert_end_step_r = (float)(br_r - tr_r) / blit_info->field_18->height;
+    float vert_end_r = vert_end_step_r * (src_rect->y - blit_info->field_18->y) + tr_r;
+
+    float vert_start_step_g = (float)(bl_g - tl_g) / blit_info->field_18->height;
+    float vert_start_g = vert_start_step_g * (src_rect->y - blit_info->field_18->y) + tl_g;
+    float vert_end_step_g = (float)(br_g - tr_g) / blit_info->field_18->height;
+    float vert_end_g = vert_end_step_g * (src_rect->y - blit_info->field_18->y) + tr_g;
+
+    float vert_start_step_b = (float)(bl_b - tl_b) / blit_info->field_18->height;
+    float vert_start_b = vert_start_step_b * (src_rect->y - blit_info->field_18->y) + tl_b;
+    float vert_end_step_b = (float)(br_b - tr_b) / blit_info->field_18->height;
+    float vert_end_b = vert_end_step_b * (src_rect->y - blit_info->field_18->y) + tr_b;
+
+    for (y = 0; y < args->max_row; y++) {
+        float hor_step_r = (vert_end_r - vert_start_r) / blit_info->field_18->width;
+        float hor_step_g = (vert_end_g - vert_start_g) / blit_info->field_18->width;
+        float hor_step_b = (vert_end_b - vert_start_b) / blit_info->field_18->width;
+
+        float r = vert_start_r + hor_step_r * (src_rect->x - blit_info->field_18->x);
+        float g = vert_start_g + hor_step_g * (src_rect->x - blit_info->field_18->x);
+        float b = vert_start_b + hor_step_b * (src_rect->x - blit_info->field_18->x);
+
+        if (y < args->min_row) {
+            // Row above the band, only the source and destination move.
+            src_pixels += args->src_step * args->dst_rect.width;
+            dst_pixels += 4 * args->dst_rect.width;
+        } else {
+            for (x = 0; x < args->dst_rect.width; x++) {
+                if (*src_pixels != 0) {
+                    uint32_t color = tig_color_make((uint8_t)r, (uint8_t)g, (uint8_t)b);
+                    color = tig_color_mul(args->plt[*src_pixels], color);
+                    *(uint32_t*)dst_pixels = color;
                 }
+                src_pixels += args->src_step;
+                dst_pixels += 4;
 
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    height_error = 0.5f;
-                    for (y = 0; y < dst_rect.height; y++) {
-                        current_alpha = start_alpha;
-                        alpha_horizontal_step = (end_alpha - start_alpha) / src_rect.width;
-                        mask = &(blit_info->field_14[src_rect.x]);
-
-                        width_error = 0.5f;
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (*src_pixels != 0) {
-                                uint32_t color = tig_color_mul(((uint32_t*)plt)[*src_pixels], *mask);
-                                *(uint32_t*)dst_pixels = tig_color_blend_alpha(color,
-                                    *(uint32_t*)dst_pixels,
-                                    (int)current_alpha);
-                            }
-
-                            width_error += width_ratio;
-                            while (width_error > 1.0f) {
-                                mask++;
-                                src_pixels += src_step;
-                                current_alpha += alpha_horizontal_step;
-                                width_error -= 1.0f;
-                            }
-
-                            dst_pixels += 4;
-                        }
+                r += hor_step_r;
+                g += hor_step_g;
+                b += hor_step_b;
+            }
+        }
+        src_pixels += args->src_pitch;
+        dst_pixels += args->dst_skip;
 
-                        src_pixels = prev_src_pixels;
-                        height_error += height_ratio;
-                        while (height_error > 1.0f) {
-                            src_pixels += src_pitch;
-                            start_alpha += start_alpha_vertical_step;
-                            end_alpha += end_alpha_vertical_step;
-                            height_error -= 1.0f;
-                        }
-                        prev_src_pixels = src_pixels;
+        vert_start_r += vert_start_step_r;
+        vert_end_r += vert_end_step_r;
 
-                        dst_pixels += dst_skip;
-                    }
-                    break;
-                }
-            } else if ((blit_info->flags & TIG_ART_BLT_BLEND_ALPHA_STIPPLE_S) != 0) {
-                // 0x518B9E
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    height_error = 0.5f;
-                    for (y = 0; y < dst_rect.height; y++) {
-                        mask = &(blit_info->field_14[src_rect.x]);
-
-                        width_error = 0.5f;
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (((src_checkerboard_cur_x ^ src_checkerboard_cur_y) & 1) != 0) {
-                                if (*src_pixels != 0) {
-                                    *(uint32_t*)dst_pixels = tig_color_mul(((uint32_t*)plt)[*src_pixels], *mask);
-                                }
-                            }
-
-                            width_error += width_ratio;
-                            while (width_error > 1.0f) {
-                                mask++;
-                                src_pixels += src_step;
-                                src_checkerboard_cur_x++;
-                                width_error -= 1.0f;
-                            }
-
-                            dst_pixels += 4;
-                        }
+        vert_start_g += vert_start_step_g;
+        vert_end_g += vert_end_step_g;
 
-                        src_pixels = prev_src_pixels;
-                        height_error += height_ratio;
-                        while (height_error > 1.0f) {
-                            src_pixels += src_pitch;
-                            src_checkerboard_cur_y++;
-                            height_error -= 1.0f;
-                        }
-                        prev_src_pixels = src_pixels;
+        vert_start_b += vert_start_step_b;
+        vert_end_b += vert_end_step_b;
+    }
+}
 
-                        dst_pixels += dst_skip;
-                        src_checkerboard_cur_x = src_rect.x;
-                    }
-                    break;
-                }
-            } else if ((blit_info->flags & TIG_ART_BLT_BLEND_ALPHA_STIPPLE_D) != 0) {
-                // 0x519169
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    height_error = 0.5f;
-                    for (y = 0; y < dst_rect.height; y++) {
-                        mask = &(blit_info->field_14[src_rect.x]);
-
-                        width_error = 0.5f;
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (((dst_checkerboard_cur_x ^ dst_checkerboard_cur_y) & 1) != 0) {
-                                if (*src_pixels != 0) {
-                                    *(uint32_t*)dst_pixels = tig_color_mul(((uint32_t*)plt)[*src_pixels], *mask);
-                                }
-                            }
-
-                            width_error += width_ratio;
-                            while (width_error > 1.0f) {
-                                mask++;
-                                src_pixels += src_step;
-                                dst_checkerboard_cur_x++;
-                                width_error -= 1.0f;
-                            }
-
-                            dst_pixels += 4;
-                        }
+// Set when the span op is applied to source color modulated by constant
+// color.
+#define ART_BLIT_OP_COLOR_CONST 0x10
 
-                        src_pixels = prev_src_pixels;
-                        height_error += height_ratio;
-                        while (height_error > 1.0f) {
-                            src_pixels += src_pitch;
-                            dst_checkerboard_cur_y++;
-                            height_error -= 1.0f;
-                        }
-                        prev_src_pixels = src_pixels;
+// Blits unstretched frame using its runs (see `art_runs_encode`). When
+// `pixels` is `NULL` the runs contain opaque pixels inline (run-length
+// encoded frame), otherwise they only describe opaque spans of `pixels`.
+// Transparent runs are skipped, opaque runs are blended with
+// `art_blit_span`. Only rows `min_row` up to `max_row` of `dst_rect` are
+// blitted.
+//
+// Returns `false` if blit mode is not supported by this path, in which case
+// the caller should blit the frame pixel by pixel.
+bool art_blit_spans(uint8_t* runs, uint8_t* pixels, int width, int height, TigRect* src_rect, TigRect* dst_rect, int min_row, int max_row, unsigned int flip, TigPalette plt, uint8_t* dst_pixels, int dst_pitch, TigArtBlitInfo* blit_info)
+{
+    int color;
+    int op;
+    int row;
+    int row_step;
+    int col;
+    int col_step;
+    int col_min;
+    int col_max;
+    int y;
+    int x;
+    int skip;
+    int cnt;
+    int lo;
+    int hi;
+    uint32_t offset;
+    uint8_t* run;
+    uint8_t* src;
+    uint32_t* dst;
+    uint32_t tinted_plt[256];
+    int index;
 
-                        dst_pixels += dst_skip;
-                        dst_checkerboard_cur_x = src_rect.x;
-                    }
-                    break;
-                }
-            } else {
-                // 0x51A505
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    height_error = 0.5f;
-                    for (y = 0; y < dst_rect.height; y++) {
-                        mask = &(blit_info->field_14[src_rect.x]);
-
-                        width_error = 0.5f;
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (*src_pixels != 0) {
-                                *(uint32_t*)dst_pixels = tig_color_mul(((uint32_t*)plt)[*src_pixels], *mask);
-                            }
-
-                            width_error += width_ratio;
-                            while (width_error > 1.0f) {
-                                mask++;
-                                src_pixels += src_step;
-                                width_error -= 1.0f;
-                            }
-
-                            dst_pixels += 4;
-                        }
+    if (tig_art_bits_per_pixel != 32) {
+        return false;
+    }
 
-                        src_pixels = prev_src_pixels;
-                        height_error += height_ratio;
-                        while (height_error > 1.0f) {
-                            src_pixels += src_pitch;
-                            height_error -= 1.0f;
-                        }
-                        prev_src_pixels = src_pixels;
+    // Spans are only blended with ops which do not depend on pixel position.
+    art_blit_mode(blit_info->flags, &color, &op);
+    if (op > ART_BLIT_OP_ALPHA_SRC) {
+        return false;
+    }
+
+    switch (color) {
+    case ART_BLIT_COLOR_NONE:
+        break;
+    case ART_BLIT_COLOR_CONST:
+        op |= ART_BLIT_OP_COLOR_CONST;
+        break;
+    default:
+        return false;
+    }
+
+    // Modulating every palette color once is cheaper than modulating every
+    // pixel of large frame. The result is the same, and the unblended case
+    // becomes a plain palette lookup.
+    if ((op & ART_BLIT_OP_COLOR_CONST) != 0
+        && op != (ART_BLIT_OP_COLOR_CONST | ART_BLIT_OP_ALPHA_SRC)
+        && dst_rect->width * dst_rect->height > 256) {
+        for (index = 0; index < 256; index++) {
+            tinted_plt[index] = tig_color_mul(((uint32_t*)plt)[index], blit_info->color);
+        }
+
+        plt = tinted_plt;
+        op &= ~ART_BLIT_OP_COLOR_CONST;
+    }
+
+    // Source rows and columns are walked exactly like in `art_blit`
+    // (including vertical flip quirk which is relative to the source rect
+    // height).
+    if ((flip & TIG_ART_BLT_FLIP_Y) != 0) {
+        row = src_rect->height - src_rect->y - 1;
+        row_step = -1;
+    } else {
+        row = src_rect->y;
+        row_step = 1;
+    }
+
+    if ((flip & TIG_ART_BLT_FLIP_X) != 0) {
+        col = width - src_rect->x - 1;
+        col_step = -1;
+        col_min = col - dst_rect->width + 1;
+    } else {
+        col = src_rect->x;
+        col_step = 1;
+        col_min = col;
+    }
+    col_max = col_min + dst_rect->width;
+
+    // Rows above the band are skipped (see `art_blit_rows`).
+    row += row_step * min_row;
+    dst_pixels += dst_pitch * min_row;
+
+    for (y = min_row; y < max_row; y++) {
+        if (row >= 0 && row < height) {
+            memcpy(&offset, runs + sizeof(offset) * row, sizeof(offset));
+            run = runs + offset;
+
+            x = 0;
+            while (x < width && x < col_max) {
+                skip = run[0] | (run[1] << 8);
+                cnt = run[2] | (run[3] << 8);
+                run += 4;
+                x += skip;
+
+                if (pixels != NULL) {
+                    src = pixels + width * row + x;
+                } else {
+                    src = run;
+                    run += cnt;
+                }
 
-                        dst_pixels += dst_skip;
+                lo = x > col_min ? x : col_min;
+                hi = x + cnt < col_max ? x + cnt : col_max;
+                if (lo < hi) {
+                    if (col_step > 0) {
+                        dst = (uint32_t*)dst_pixels + (lo - col);
+                    } else {
+                        dst = (uint32_t*)dst_pixels + (col - lo);
                     }
-                    break;
+
+                    art_blit_span(op, src + (lo - x), hi - lo, dst, col_step, (uint32_t*)plt, blit_info);
                 }
+
+                x += cnt;
             }
-        } else if ((blit_info->flags & TIG_ART_BLT_BLEND_COLOR_LERP) != 0) {
-            // NOTE: It looks like this blend mode is not implemented for
-            // stretched blits.
-        } else {
-            if ((blit_info->flags & TIG_ART_BLT_BLEND_ADD) != 0) {
-                // 0x50FC61
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    height_error = 0.5f;
-                    for (y = 0; y < dst_rect.height; y++) {
-                        width_error = 0.5f;
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (*src_pixels != 0) {
-                                *(uint32_t*)dst_pixels = tig_color_add(((uint32_t*)plt)[*src_pixels],
-                                    *(uint32_t*)dst_pixels);
-                            }
-
-                            width_error += width_ratio;
-                            while (width_error > 1.0f) {
-                                src_pixels += src_step;
-                                width_error -= 1.0f;
-                            }
-
-                            dst_pixels += 4;
-                        }
+        }
 
-                        src_pixels = prev_src_pixels;
-                        height_error += height_ratio;
-                        while (height_error > 1.0f) {
-                            src_pixels += src_pitch;
-                            height_error -= 1.0f;
-                        }
-                        prev_src_pixels = src_pixels;
+        row += row_step;
+        dst_pixels += dst_pitch;
+    }
 
-                        dst_pixels += dst_skip;
-                    }
-                    break;
-                }
-            } else if ((blit_info->flags & TIG_ART_BLT_BLEND_SUB) != 0) {
-                // 0x51004E
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    height_error = 0.5f;
-                    for (y = 0; y < dst_rect.height; y++) {
-                        width_error = 0.5f;
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (*src_pixels != 0) {
-                                *(uint32_t*)dst_pixels = tig_color_sub(((uint32_t*)plt)[*src_pixels],
-                                    *(uint32_t*)dst_pixels);
-                            }
-
-                            width_error += width_ratio;
-                            while (width_error > 1.0f) {
-                                src_pixels += src_step;
-                                width_error -= 1.0f;
-                            }
-
-                            dst_pixels += 4;
-                        }
+    return true;
+}
 
-                        src_pixels = prev_src_pixels;
-                        height_error += height_ratio;
-                        while (height_error > 1.0f) {
-                            src_pixels += src_pitch;
-                            height_error -= 1.0f;
-                        }
-                        prev_src_pixels = src_pixels;
+// Blends `cnt` opaque source pixels into destination (which is walked in
+// `dst_step` direction).
+void art_blit_span(int op, const uint8_t* src, int cnt, uint32_t* dst, int dst_step, const uint32_t* plt, TigArtBlitInfo* blit_info)
+{
+    uint32_t color;
+    uint32_t colors[256];
+    uint32_t* chunk;
+    int n;
+
+    // Blends with uniform alpha are done by batch color operators on chunks
+    // of looked up source colors. Colors are looked up in the order of
+    // destination pixels, so that chunks are contiguous in both directions.
+    switch (op) {
+    case ART_BLIT_OP_ADD:
+    case ART_BLIT_OP_SUB:
+    case ART_BLIT_OP_MUL:
+    case ART_BLIT_OP_ALPHA_CONST:
+        for (; cnt > 0; cnt -= n, src += n, dst += n * dst_step) {
+            n = cnt < 256 ? cnt : 256;
+
+            if (dst_step > 0) {
+                art_blit_span_copy_func(src, n, colors, 1, plt);
+                chunk = dst;
+            } else {
+                art_blit_span_copy_func(src, n, colors + n - 1, -1, plt);
+                chunk = dst - n + 1;
+            }
 
-                        dst_pixels += dst_skip;
-                    }
-                    break;
-                }
-            } else if ((blit_info->flags & TIG_ART_BLT_BLEND_MUL) != 0) {
-                // 0x5104A6
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    height_error = 0.5f;
-                    for (y = 0; y < dst_rect.height; y++) {
-                        width_error = 0.5f;
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (*src_pixels != 0) {
-                                *(uint32_t*)dst_pixels = tig_color_mul(((uint32_t*)plt)[*src_pixels],
-                                    *(uint32_t*)dst_pixels);
-                            }
-
-                            width_error += width_ratio;
-                            while (width_error > 1.0f) {
-                                src_pixels += src_step;
-                                width_error -= 1.0f;
-                            }
-
-                            dst_pixels += 4;
-                        }
+            switch (op) {
+            case ART_BLIT_OP_ADD:
+                tig_color_add_n(chunk, colors, n);
+                break;
+            case ART_BLIT_OP_SUB:
+                tig_color_sub_n(chunk, colors, n);
+                break;
+            case ART_BLIT_OP_MUL:
+                tig_color_mul_n(chunk, colors, n);
+                break;
+            case ART_BLIT_OP_ALPHA_CONST:
+                tig_color_blend_alpha_n(chunk, colors, blit_info->alpha[0], n);
+                break;
+            }
+        }
+        return;
+    }
 
-                        src_pixels = prev_src_pixels;
-                        height_error += height_ratio;
-                        while (height_error > 1.0f) {
-                            src_pixels += src_pitch;
-                            height_error -= 1.0f;
-                        }
-                        prev_src_pixels = src_pixels;
+    switch (op) {
+    case ART_BLIT_OP_COPY:
+        art_blit_span_copy_func(src, cnt, dst, dst_step, plt);
+        break;
+    case ART_BLIT_OP_ALPHA_AVG:
+        for (; cnt > 0; cnt--, src++, dst += dst_step) {
+            *dst = tig_color_blend_alpha(plt[*src], *dst, tig_color_rgb_to_grayscale(plt[*src]));
+        }
+        break;
+    case ART_BLIT_OP_ALPHA_SRC:
+        for (; cnt > 0; cnt--, src++, dst += dst_step) {
+            *dst = tig_color_blend_alpha(plt[*src], *dst, tig_color_alpha(plt[*src]));
+        }
+        break;
+    case ART_BLIT_OP_COLOR_CONST | ART_BLIT_OP_COPY:
+        for (; cnt > 0; cnt--, src++, dst += dst_step) {
+            *dst = tig_color_mul(plt[*src], blit_info->color);
+        }
+        break;
+    case ART_BLIT_OP_COLOR_CONST | ART_BLIT_OP_ADD:
+        for (; cnt > 0; cnt--, src++, dst += dst_step) {
+            *dst = tig_color_add(*dst, tig_color_mul(plt[*src], blit_info->color));
+        }
+        break;
+    case ART_BLIT_OP_COLOR_CONST | ART_BLIT_OP_SUB:
+        for (; cnt > 0; cnt--, src++, dst += dst_step) {
+            *dst = tig_color_sub(tig_color_mul(plt[*src], blit_info->color), *dst);
+        }
+        break;
+    case ART_BLIT_OP_COLOR_CONST | ART_BLIT_OP_MUL:
+        for (; cnt > 0; cnt--, src++, dst += dst_step) {
+            *dst = tig_color_mul(tig_color_mul(plt[*src], blit_info->color), *dst);
+        }
+        break;
+    case ART_BLIT_OP_COLOR_CONST | ART_BLIT_OP_ALPHA_AVG:
+        for (; cnt > 0; cnt--, src++, dst += dst_step) {
+            color = tig_color_mul(plt[*src], blit_info->color);
+            *dst = tig_color_blend_alpha(color, *dst, tig_color_rgb_to_grayscale(color));
+        }
+        break;
+    case ART_BLIT_OP_COLOR_CONST | ART_BLIT_OP_ALPHA_CONST:
+        for (; cnt > 0; cnt--, src++, dst += dst_step) {
+            *dst = tig_color_blend_alpha(tig_color_mul(plt[*src], blit_info->color), *dst, blit_info->alpha[0]);
+        }
+        break;
+    case ART_BLIT_OP_COLOR_CONST | ART_BLIT_OP_ALPHA_SRC:
+        for (; cnt > 0; cnt--, src++, dst += dst_step) {
+            *dst = tig_color_blend_alpha(blit_info->color, *dst, tig_color_alpha(plt[*src]));
+        }
+        break;
+    }
+}
 
-                        dst_pixels += dst_skip;
-                    }
-                    break;
-                }
-            } else if ((blit_info->flags & TIG_ART_BLT_BLEND_ALPHA_AVG) != 0) {
-                // 0x5109EE
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    height_error = 0.5f;
-                    for (y = 0; y < dst_rect.height; y++) {
-                        width_error = 0.5f;
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (*src_pixels != 0) {
-                                *(uint32_t*)dst_pixels = tig_color_blend_alpha(((uint32_t*)plt)[*src_pixels],
-                                    *(uint32_t*)dst_pixels,
-                                    tig_color_rgb_to_grayscale(((uint32_t*)plt)[*src_pixels]));
-                            }
-
-                            width_error += width_ratio;
-                            while (width_error > 1.0f) {
-                                src_pixels += src_step;
-                                width_error -= 1.0f;
-                            }
-
-                            dst_pixels += 4;
-                        }
+// Palette lookup of `cnt` opaque source pixels.
+void art_blit_span_copy(const uint8_t* src, int cnt, uint32_t* dst, int dst_step, const uint32_t* plt)
+{
+    for (; cnt > 0; cnt--, src++, dst += dst_step) {
+        *dst = plt[*src];
+    }
+}
 
-                        src_pixels = prev_src_pixels;
-                        height_error += height_ratio;
-                        while (height_error > 1.0f) {
-                            src_pixels += src_pitch;
-                            height_error -= 1.0f;
-                        }
-                        prev_src_pixels = src_pixels;
+#ifdef SDL_AVX2_INTRINSICS
+// Eight source pixels are widened to indices and looked up with a single
+// gather (reversed when walking backwards).
+SDL_TARGETING("avx2") void art_blit_span_copy_avx2(const uint8_t* src, int cnt, uint32_t* dst, int dst_step, const uint32_t* plt)
+{
+    __m256i reverse;
+    __m256i indexes;
+    __m256i colors;
 
-                        dst_pixels += dst_skip;
-                    }
-                    break;
-                }
-            } else if ((blit_info->flags & TIG_ART_BLT_BLEND_ALPHA_CONST) != 0) {
-                // 0x510F44
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    height_error = 0.5f;
-                    for (y = 0; y < dst_rect.height; y++) {
-                        width_error = 0.5f;
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (*src_pixels != 0) {
-                                *(uint32_t*)dst_pixels = tig_color_blend_alpha(((uint32_t*)plt)[*src_pixels],
-                                    *(uint32_t*)dst_pixels,
-                                    blit_info->alpha[0]);
-                            }
-
-                            width_error += width_ratio;
-                            while (width_error > 1.0f) {
-                                src_pixels += src_step;
-                                width_error -= 1.0f;
-                            }
-
-                            dst_pixels += 4;
-                        }
+    if (dst_step > 0) {
+        for (; cnt >= 8; cnt -= 8, src += 8, dst += 8) {
+            indexes = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)src));
+            colors = _mm256_i32gather_epi32((const int*)plt, indexes, 4);
+            _mm256_storeu_si256((__m256i*)dst, colors);
+        }
+    } else {
+        reverse = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+        for (; cnt >= 8; cnt -= 8, src += 8, dst -= 8) {
+            indexes = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)src));
+            colors = _mm256_i32gather_epi32((const int*)plt, indexes, 4);
+            colors = _mm256_permutevar8x32_epi32(colors, reverse);
+            _mm256_storeu_si256((__m256i*)(dst - 7), colors);
+        }
+    }
 
-                        src_pixels = prev_src_pixels;
-                        height_error += height_ratio;
-                        while (height_error > 1.0f) {
-                            src_pixels += src_pitch;
-                            height_error -= 1.0f;
-                        }
-                        prev_src_pixels = src_pixels;
+    art_blit_span_copy(src, cnt, dst, dst_step, plt);
+}
+#endif
 
-                        dst_pixels += dst_skip;
-                    }
-                    break;
-                }
-            } else if ((blit_info->flags & TIG_ART_BLT_BLEND_ALPHA_SRC) != 0) {
-                // 0x511960
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    height_error = 0.5f;
-                    for (y = 0; y < dst_rect.height; y++) {
-                        width_error = 0.5f;
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (*src_pixels != 0) {
-                                *(uint32_t*)dst_pixels = tig_color_blend_alpha(((uint32_t*)plt)[*src_pixels],
-                                    *(uint32_t*)dst_pixels,
-                                    tig_color_alpha(((uint32_t*)plt)[*src_pixels]));
-                            }
-
-                            width_error += width_ratio;
-                            while (width_error > 1.0f) {
-                                src_pixels += src_step;
-                                width_error -= 1.0f;
-                            }
-
-                            dst_pixels += 4;
-                        }
+// 0x51AA90
+int sub_51AA90(tig_art_id_t art_id)
+{
+    char path[TIG_MAX_PATH];
+    tig_art_id_t key;
+    int cache_entry_index;
+    bool found;
+    bool loaded;
 
-                        src_pixels = prev_src_pixels;
-                        height_error += height_ratio;
-                        while (height_error > 1.0f) {
-                            src_pixels += src_pitch;
-                            height_error -= 1.0f;
-                        }
-                        prev_src_pixels = src_pixels;
+    // Cache entries are indexed by the key which identifies the underlying
+    // art file, so the lookup does not need to build the path.
+    key = tig_art_cache_key(art_id);
 
-                        dst_pixels += dst_skip;
-                    }
-                    break;
-                }
-            } else if ((blit_info->flags & TIG_ART_BLT_BLEND_ALPHA_LERP_ANY) != 0) {
-                // 0x511E0F
-                switch (blit_info->flags & TIG_ART_BLT_BLEND_ALPHA_LERP_ANY) {
-                case TIG_ART_BLT_BLEND_ALPHA_LERP_X:
-                    start_alpha_vertical_step = 0.0;
-                    end_alpha_vertical_step = 0.0;
-                    start_alpha_x = (float)src_rect.x;
-                    end_alpha_x = (float)(width - src_rect.width - src_rect.x);
-                    alpha_range = ((float)blit_info->alpha[1] - (float)blit_info->alpha[0]) / width;
-                    start_alpha = (float)blit_info->alpha[0] + start_alpha_x * alpha_range;
-                    end_alpha = (float)blit_info->alpha[1] - end_alpha_x * alpha_range;
-                    break;
-                case TIG_ART_BLT_BLEND_ALPHA_LERP_Y:
-                    start_alpha_vertical_step = ((float)blit_info->alpha[3] - (float)blit_info->alpha[0]) / height;
-                    end_alpha_vertical_step = start_alpha_vertical_step;
-                    start_alpha = src_rect.y * start_alpha_vertical_step + (float)blit_info->alpha[0];
-                    end_alpha = start_alpha;
-                    break;
-                default:
-                    start_alpha_vertical_step = ((float)blit_info->alpha[3] - (float)blit_info->alpha[0]) / height;
-                    end_alpha_vertical_step = ((float)(uint8_t)blit_info->alpha[2] - (float)blit_info->alpha[1]) / height;
-                    start_alpha_x = (float)src_rect.x;
-                    end_alpha_x = (float)(width - src_rect.width - src_rect.x);
-                    alpha_range = ((src_rect.y * end_alpha_vertical_step + (float)blit_info->alpha[1]) - (src_rect.y * start_alpha_vertical_step + (float)blit_info->alpha[0])) / width;
-                    start_alpha = (src_rect.y * start_alpha_vertical_step + (float)blit_info->alpha[0]) + start_alpha_x * alpha_range;
-                    end_alpha = (src_rect.y * end_alpha_vertical_step + (float)blit_info->alpha[1]) - end_alpha_x * alpha_range;
-                    break;
-                }
+    tig_art_cache_counters.lookups++;
 
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    height_error = 0.5f;
-                    for (y = 0; y < dst_rect.height; y++) {
-                        current_alpha = start_alpha;
-                        alpha_horizontal_step = (end_alpha - start_alpha) / src_rect.width;
-
-                        width_error = 0.5f;
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (*src_pixels != 0) {
-                                *(uint32_t*)dst_pixels = tig_color_blend_alpha(((uint32_t*)plt)[*src_pixels],
-                                    *(uint32_t*)dst_pixels,
-                                    (int)current_alpha);
-                            }
-
-                            width_error += width_ratio;
-                            while (width_error > 1.0f) {
-                                src_pixels += src_step;
-                                current_alpha += alpha_horizontal_step;
-                                width_error -= 1.0f;
-                            }
-
-                            dst_pixels += 4;
-                        }
+    // The last accessed entry is always at the head of the LRU list, so
+    // there is nothing to relink.
+    if (dword_604714 != TIG_ART_CACHE_NONE
+        && tig_art_cache_entries[dword_604714].key == key) {
+        tig_art_cache_entries[dword_604714].time = tig_ping_timestamp;
+        tig_art_cache_counters.mru_hits++;
+        tig_art_cache_counters.hits++;
+        return dword_604714;
+    }
 
-                        src_pixels = prev_src_pixels;
-                        height_error += height_ratio;
-                        while (height_error > 1.0f) {
-                            src_pixels += src_pitch;
-                            start_alpha += start_alpha_vertical_step;
-                            end_alpha += end_alpha_vertical_step;
-                            height_error -= 1.0f;
-                        }
-                        prev_src_pixels = src_pixels;
+    // Called twice to check both system and video memory.
+    tig_art_cache_check_fullness();
+    tig_art_cache_check_fullness();
+    tig_art_cache_check_budgets();
 
-                        dst_pixels += dst_skip;
-                    }
-                    break;
-                }
-            } else if ((blit_info->flags & TIG_ART_BLT_BLEND_ALPHA_STIPPLE_S) != 0) {
-                // 0x5113B7
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    height_error = 0.5f;
-                    for (y = 0; y < dst_rect.height; y++) {
-                        width_error = 0.5f;
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (((src_checkerboard_cur_x ^ src_checkerboard_cur_y) & 1) != 0) {
-                                if (*src_pixels != 0) {
-                                    *(uint32_t*)dst_pixels = ((uint32_t*)plt)[*src_pixels];
-                                }
-                            }
-
-                            width_error += width_ratio;
-                            while (width_error > 1.0f) {
-                                src_pixels += src_step;
-                                src_checkerboard_cur_x++;
-                                width_error -= 1.0f;
-                            }
-
-                            dst_pixels += 4;
-                        }
+    found = tig_art_cache_find(key, &cache_entry_index);
+    if (!found && tig_art_prefetch_sync(key)) {
+        found = tig_art_cache_find(key, &cache_entry_index);
+        if (found) {
+            tig_art_cache_counters.prefetch_hits++;
+        }
+    }
 
-                        src_pixels = prev_src_pixels;
-                        height_error += height_ratio;
-                        while (height_error > 1.0f) {
-                            src_pixels += src_pitch;
-                            src_checkerboard_cur_y++;
-                            height_error -= 1.0f;
-                        }
-                        prev_src_pixels = src_pixels;
+    if (found) {
+        tig_art_cache_counters.hits++;
+    }
 
-                        dst_pixels += dst_skip;
-                        src_checkerboard_cur_x = src_rect.x;
-                    }
-                    break;
-                }
-            } else if ((blit_info->flags & TIG_ART_BLT_BLEND_ALPHA_STIPPLE_D) != 0) {
-                // 0x51169B
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    height_error = 0.5f;
-                    for (y = 0; y < dst_rect.height; y++) {
-                        width_error = 0.5f;
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (((dst_checkerboard_cur_x ^ dst_checkerboard_cur_y) & 1) != 0) {
-                                if (*src_pixels != 0) {
-                                    *(uint32_t*)dst_pixels = ((uint32_t*)plt)[*src_pixels];
-                                }
-                            }
-
-                            width_error += width_ratio;
-                            while (width_error > 1.0f) {
-                                src_pixels += src_step;
-                                dst_checkerboard_cur_x++;
-                                width_error -= 1.0f;
-                            }
-
-                            dst_pixels += 4;
-                        }
+    loaded = false;
+    if (!found && !tig_art_missing_find(key)) {
+        if (tig_art_build_path(art_id, path) != TIG_OK) {
+            return -1;
+        }
 
-                        src_pixels = prev_src_pixels;
-                        height_error += height_ratio;
-                        while (height_error > 1.0f) {
-                            src_pixels += src_pitch;
-                            dst_checkerboard_cur_y++;
-                            height_error -= 1.0f;
-                        }
-                        prev_src_pixels = src_pixels;
+        tig_art_cache_counters.misses++;
 
-                        dst_pixels += dst_skip;
-                        dst_checkerboard_cur_x = src_rect.x;
-                    }
-                    break;
-                }
-            } else {
-                // 0x512433
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    height_error = 0.5f;
-                    for (y = 0; y < dst_rect.height; y++) {
-                        width_error = 0.5f;
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (*src_pixels != 0) {
-                                *(uint32_t*)dst_pixels = ((uint32_t*)plt)[*src_pixels];
-                            }
-
-                            width_error += width_ratio;
-                            while (width_error > 1.0f) {
-                                src_pixels += src_step;
-                                width_error -= 1.0f;
-                            }
-
-                            dst_pixels += 4;
-                        }
+        cache_entry_index = tig_art_cache_entry_alloc();
 
-                        src_pixels = prev_src_pixels;
-                        height_error += height_ratio;
-                        while (height_error > 1.0f) {
-                            src_pixels += src_pitch;
-                            height_error -= 1.0f;
-                        }
-                        prev_src_pixels = src_pixels;
+        if (tig_art_cache_entry_load(art_id, path, cache_entry_index)) {
+            tig_art_cache_entries[cache_entry_index].key = key;
+            tig_art_cache_buckets_insert(cache_entry_index);
+            loaded = true;
+        } else {
+            tig_debug_printf("ART LOAD FAILURE!!! Trying to load %s\n", path);
+            tig_art_cache_entry_free(cache_entry_index);
+            tig_art_missing_add(key);
+        }
+    }
 
-                        dst_pixels += dst_skip;
-                    }
-                    break;
-                }
+    // Missing art is substituted with bad art, which is shared by all missing
+    // art of the same type (frames layout depends on the type).
+    if (!found && !loaded) {
+        tig_art_cache_counters.missing++;
+
+        key = TIG_ART_BAD_ART_KEY(art_id);
+        found = tig_art_cache_find(key, &cache_entry_index);
+        if (!found) {
+            cache_entry_index = tig_art_cache_entry_alloc();
+
+            if (!tig_art_cache_entry_load(art_id, "art\\badart.art", cache_entry_index)) {
+                tig_debug_printf("ART LOAD FAILURE!!! Trying to load badart.art\n");
+                tig_art_cache_entry_free(cache_entry_index);
+                return -1;
             }
+
+            tig_art_cache_entries[cache_entry_index].key = key;
+            tig_art_cache_buckets_insert(cache_entry_index);
         }
-    } else {
-        if ((blit_info->flags & TIG_ART_BLT_BLEND_COLOR_CONST) != 0) {
-            // 0x5084E9
-            if ((blit_info->flags & TIG_ART_BLT_BLEND_ADD) != 0) {
-                // 0x5084F5
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    for (y = 0; y < dst_rect.height; y++) {
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (*src_pixels != 0) {
-                                uint32_t color = tig_color_mul(((uint32_t*)plt)[*src_pixels], blit_info->color);
-                                *(uint32_t*)dst_pixels = tig_color_add(*(uint32_t*)dst_pixels, color);
-                            }
-                            src_pixels += src_step;
-                            dst_pixels += 4;
-                        }
-                        src_pixels += src_pitch;
-                        dst_pixels += dst_skip;
-                    }
-                    break;
-                }
-            } else if ((blit_info->flags & TIG_ART_BLT_BLEND_SUB) != 0) {
-                // 0x508A1C
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    for (y = 0; y < dst_rect.height; y++) {
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (*src_pixels != 0) {
-                                *(uint32_t*)dst_pixels = tig_color_sub(tig_color_mul(((uint32_t*)plt)[*src_pixels], blit_info->color),
-                                    *(uint32_t*)dst_pixels);
-                            }
-                            src_pixels += src_step;
-                            dst_pixels += 4;
-                        }
-                        src_pixels += src_pitch;
-                        dst_pixels += dst_skip;
-                    }
-                    break;
-                }
-            } else if ((blit_info->flags & TIG_ART_BLT_BLEND_MUL) != 0) {
-                // 0x508FB6
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    for (y = 0; y < dst_rect.height; y++) {
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (*src_pixels != 0) {
-                                uint32_t color = tig_color_mul(((uint32_t*)plt)[*src_pixels], blit_info->color);
-                                *(uint32_t*)dst_pixels = tig_color_mul(color, *(uint32_t*)dst_pixels);
-                            }
-                            src_pixels += src_step;
-                            dst_pixels += 4;
-                        }
-                        src_pixels += src_pitch;
-                        dst_pixels += dst_skip;
-                    }
-                    break;
-                }
-            } else if ((blit_info->flags & TIG_ART_BLT_BLEND_ALPHA_AVG) != 0) {
-                // 0x50964F
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    for (y = 0; y < dst_rect.height; y++) {
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (*src_pixels != 0) {
-                                uint32_t color = tig_color_mul(((uint32_t*)plt)[*src_pixels], blit_info->color);
-                                *(uint32_t*)dst_pixels = tig_color_blend_alpha(color,
-                                    *(uint32_t*)dst_pixels,
-                                    tig_color_rgb_to_grayscale(color));
-                            }
-                            src_pixels += src_step;
-                            dst_pixels += 4;
-                        }
-                        src_pixels += src_pitch;
-                        dst_pixels += dst_skip;
-                    }
-                    break;
-                }
-            } else if ((blit_info->flags & TIG_ART_BLT_BLEND_ALPHA_CONST) != 0) {
-                // 0x509CD6
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    for (y = 0; y < dst_rect.height; y++) {
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (*src_pixels != 0) {
-                                *(uint32_t*)dst_pixels = tig_color_blend_alpha(tig_color_mul(((uint32_t*)plt)[*src_pixels], blit_info->color),
-                                    *(uint32_t*)dst_pixels,
-                                    blit_info->alpha[0]);
-                            }
-                            src_pixels += src_step;
-                            dst_pixels += 4;
-                        }
-                        src_pixels += src_pitch;
-                        dst_pixels += dst_skip;
-                    }
-                    break;
-                }
-            } else if ((blit_info->flags & TIG_ART_BLT_BLEND_ALPHA_SRC) != 0) {
-                // 0x50ABD1
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    for (y = 0; y < dst_rect.height; y++) {
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (*src_pixels != 0) {
-                                *(uint32_t*)dst_pixels = tig_color_blend_alpha(blit_info->color,
-                                    *(uint32_t*)dst_pixels,
-                                    tig_color_alpha(((uint32_t*)plt)[*src_pixels]));
-                            }
-                            src_pixels += src_step;
-                            dst_pixels += 4;
-                        }
-                        src_pixels += src_pitch;
-                        dst_pixels += dst_skip;
-                    }
-                    break;
-                }
-            } else if ((blit_info->flags & TIG_ART_BLT_BLEND_ALPHA_LERP_ANY) != 0) {
-                // 0x50AF93
-                switch (blit_info->flags & TIG_ART_BLT_BLEND_ALPHA_LERP_ANY) {
-                case TIG_ART_BLT_BLEND_ALPHA_LERP_X:
-                    start_alpha_vertical_step = 0.0;
-                    end_alpha_vertical_step = 0.0;
-                    start_alpha_x = (float)src_rect.x;
-                    end_alpha_x = (float)(width - src_rect.width - src_rect.x);
-                    alpha_range = ((float)blit_info->alpha[1] - (float)blit_info->alpha[0]) / width;
-                    start_alpha = (float)blit_info->alpha[0] + start_alpha_x * alpha_range;
-                    end_alpha = (float)blit_info->alpha[1] - end_alpha_x * alpha_range;
-                    break;
-                case TIG_ART_BLT_BLEND_ALPHA_LERP_Y:
-                    start_alpha_vertical_step = ((float)blit_info->alpha[3] - (float)blit_info->alpha[0]) / height;
-                    end_alpha_vertical_step = start_alpha_vertical_step;
-                    start_alpha = src_rect.y * start_alpha_vertical_step + (float)blit_info->alpha[0];
-                    end_alpha = start_alpha;
-                    break;
-                default:
-                    start_alpha_vertical_step = ((float)blit_info->alpha[3] - (float)blit_info->alpha[0]) / height;
-                    end_alpha_vertical_step = ((float)(uint8_t)blit_info->alpha[2] - (float)blit_info->alpha[1]) / height;
-                    start_alpha_x = (float)src_rect.x;
-                    end_alpha_x = (float)(width - src_rect.width - src_rect.x);
-                    alpha_range = ((src_rect.y * end_alpha_vertical_step + (float)blit_info->alpha[1]) - (src_rect.y * start_alpha_vertical_step + (float)blit_info->alpha[0])) / width;
-                    start_alpha = (src_rect.y * start_alpha_vertical_step + (float)blit_info->alpha[0]) + start_alpha_x * alpha_range;
-                    end_alpha = (src_rect.y * end_alpha_vertical_step + (float)blit_info->alpha[1]) - end_alpha_x * alpha_range;
-                    break;
-                }
+    }
 
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    for (y = 0; y < dst_rect.height; y++) {
-                        current_alpha = start_alpha;
-                        alpha_horizontal_step = (end_alpha - start_alpha) / src_rect.width;
-
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (*src_pixels != 0) {
-                                *(uint32_t*)dst_pixels = tig_color_blend_alpha(tig_color_mul(((uint32_t*)plt)[*src_pixels], blit_info->color),
-                                    *(uint32_t*)dst_pixels,
-                                    (int)current_alpha);
-                            }
-                            src_pixels += src_step;
-                            dst_pixels += 4;
-
-                            current_alpha += alpha_horizontal_step;
-                        }
-                        src_pixels += src_pitch;
-                        dst_pixels += dst_skip;
+    if (found) {
+        tig_art_cache_lru_unlink(cache_entry_index);
+    }
 
-                        start_alpha += start_alpha_vertical_step;
-                        end_alpha += end_alpha_vertical_step;
-                    }
-                    break;
-                }
-            } else if ((blit_info->flags & TIG_ART_BLT_BLEND_ALPHA_STIPPLE_S) != 0) {
-                // 0x50A2A6
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    for (y = 0; y < dst_rect.height; y++) {
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (((src_checkerboard_cur_x ^ src_checkerboard_cur_y) & 1) != 0) {
-                                if (*src_pixels != 0) {
-                                    *(uint32_t*)dst_pixels = tig_color_mul(((uint32_t*)plt)[*src_pixels], blit_info->color);
-                                }
-                            }
-                            src_pixels += src_step;
-                            dst_pixels += 4;
-
-                            src_checkerboard_cur_x++;
-                        }
-                        src_pixels += src_pitch;
-                        dst_pixels += dst_skip;
+    tig_art_cache_lru_link(cache_entry_index);
 
-                        src_checkerboard_cur_x = src_rect.x;
-                        src_checkerboard_cur_y++;
-                    }
-                    break;
-                }
-            } else if ((blit_info->flags & TIG_ART_BLT_BLEND_ALPHA_STIPPLE_D) != 0) {
-                // 0x50A739
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    for (y = 0; y < dst_rect.height; y++) {
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (((dst_checkerboard_cur_x ^ dst_checkerboard_cur_y) & 1) != 0) {
-                                if (*src_pixels != 0) {
-                                    *(uint32_t*)dst_pixels = tig_color_mul(((uint32_t*)plt)[*src_pixels], blit_info->color);
-                                }
-                            }
-                            src_pixels += src_step;
-                            dst_pixels += 4;
-
-                            dst_checkerboard_cur_x++;
-                        }
-                        src_pixels += src_pitch;
-                        dst_pixels += dst_skip;
+    tig_art_cache_entries[cache_entry_index].time = tig_ping_timestamp;
+    tig_art_cache_entries[cache_entry_index].art_id = art_id;
+    dword_604714 = cache_entry_index;
 
-                        dst_checkerboard_cur_x = dst_rect.x;
-                        dst_checkerboard_cur_y++;
-                    }
-                    break;
-                }
-            } else {
-                // 0x509647
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    for (y = 0; y < dst_rect.height; y++) {
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (*src_pixels != 0) {
-                                *(uint32_t*)dst_pixels = tig_color_mul(((uint32_t*)plt)[*src_pixels], blit_info->color);
-                            }
-                            src_pixels += src_step;
-                            dst_pixels += 4;
-                        }
-                        src_pixels += src_pitch;
-                        dst_pixels += dst_skip;
-                    }
-                    break;
-                }
-            }
-        } else if ((blit_info->flags & TIG_ART_BLT_BLEND_COLOR_ARRAY) != 0) {
-            // 0x50BAEF
-            if ((blit_info->flags & TIG_ART_BLT_BLEND_ADD) != 0) {
-                // 0x50BAFB
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    for (y = 0; y < dst_rect.height; y++) {
-                        mask = &(blit_info->field_14[src_rect.x]);
-
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (*src_pixels != 0) {
-                                uint32_t color = tig_color_mul(((uint32_t*)plt)[*src_pixels], *mask);
-                                *(uint32_t*)dst_pixels = tig_color_add(*(uint32_t*)dst_pixels, color);
-                            }
-                            src_pixels += src_step;
-                            dst_pixels += 4;
-
-                            mask++;
-                        }
-                        src_pixels += src_pitch;
-                        dst_pixels += dst_skip;
-                    }
-                    break;
-                }
-            } else if ((blit_info->flags & TIG_ART_BLT_BLEND_SUB) != 0) {
-                // 0x50C06F
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    for (y = 0; y < dst_rect.height; y++) {
-                        mask = &(blit_info->field_14[src_rect.x]);
-
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (*src_pixels != 0) {
-                                *(uint32_t*)dst_pixels = tig_color_sub(tig_color_mul(((uint32_t*)plt)[*src_pixels], *mask),
-                                    *(uint32_t*)dst_pixels);
-                            }
-                            src_pixels += src_step;
-                            dst_pixels += 4;
-
-                            mask++;
-                        }
-                        src_pixels += src_pitch;
-                        dst_pixels += dst_skip;
-                    }
-                    break;
-                }
-            } else if ((blit_info->flags & TIG_ART_BLT_BLEND_MUL) != 0) {
-                // 0x50C646
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    for (y = 0; y < dst_rect.height; y++) {
-                        mask = &(blit_info->field_14[src_rect.x]);
-
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (*src_pixels != 0) {
-                                uint32_t color = tig_color_mul(((uint32_t*)plt)[*src_pixels], *mask);
-                                *(uint32_t*)dst_pixels = tig_color_mul(color, *(uint32_t*)dst_pixels);
-                            }
-                            src_pixels += src_step;
-                            dst_pixels += 4;
-
-                            mask++;
-                        }
-                        src_pixels += src_pitch;
-                        dst_pixels += dst_skip;
-                    }
-                    break;
-                }
-            } else if ((blit_info->flags & TIG_ART_BLT_BLEND_ALPHA_AVG) != 0) {
-                // 0x50CD23
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    for (y = 0; y < dst_rect.height; y++) {
-                        mask = &(blit_info->field_14[src_rect.x]);
-
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (*src_pixels != 0) {
-                                uint32_t color = tig_color_mul(((uint32_t*)plt)[*src_pixels], *mask);
-                                *(uint32_t*)dst_pixels = tig_color_blend_alpha(color,
-                                    *(uint32_t*)dst_pixels,
-                                    tig_color_rgb_to_grayscale(color));
-                            }
-                            src_pixels += src_step;
-                            dst_pixels += 4;
-
-                            mask++;
-                        }
-                        src_pixels += src_pitch;
-                        dst_pixels += dst_skip;
-                    }
-                    break;
-                }
-            } else if ((blit_info->flags & TIG_ART_BLT_BLEND_ALPHA_CONST) != 0) {
-                // 0x50D3F9
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    for (y = 0; y < dst_rect.height; y++) {
-                        mask = &(blit_info->field_14[src_rect.x]);
-
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (*src_pixels != 0) {
-                                uint32_t color = tig_color_mul(((uint32_t*)plt)[*src_pixels], *mask);
-                                *(uint32_t*)dst_pixels = tig_color_blend_alpha(color,
-                                    *(uint32_t*)dst_pixels,
-                                    blit_info->alpha[0]);
-                            }
-                            src_pixels += src_step;
-                            dst_pixels += 4;
-
-                            mask++;
-                        }
-                        src_pixels += src_pitch;
-                        dst_pixels += dst_skip;
-                    }
-                    break;
-                }
-            } else if ((blit_info->flags & TIG_ART_BLT_BLEND_ALPHA_SRC) != 0) {
-                // 0x50E3C4
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    for (y = 0; y < dst_rect.height; y++) {
-                        mask = &(blit_info->field_14[src_rect.x]);
-
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (*src_pixels != 0) {
-                                // NOTE: This is somewhat different from
-                                // surrounding code which uses seemingly inlined
-                                // `tig_color_mul`.
-                                *(uint32_t*)dst_pixels = tig_color_blend_alpha(*mask,
-                                    *(uint32_t*)dst_pixels,
-                                    tig_color_alpha(((uint32_t*)plt)[*src_pixels]));
-                            }
-                            src_pixels += src_step;
-                            dst_pixels += 4;
-
-                            mask++;
-                        }
-                        src_pixels += src_pitch;
-                        dst_pixels += dst_skip;
-                    }
-                    break;
-                }
-            } else if ((blit_info->flags & TIG_ART_BLT_BLEND_ALPHA_LERP_ANY) != 0) {
-                // 0x50E7CB
-                switch (blit_info->flags & TIG_ART_BLT_BLEND_ALPHA_LERP_ANY) {
-                case TIG_ART_BLT_BLEND_ALPHA_LERP_X:
-                    start_alpha_vertical_step = 0.0;
-                    end_alpha_vertical_step = 0.0;
-                    start_alpha_x = (float)src_rect.x;
-                    end_alpha_x = (float)(width - src_rect.width - src_rect.x);
-                    alpha_range = ((float)blit_info->alpha[1] - (float)blit_info->alpha[0]) / width;
-                    start_alpha = (float)blit_info->alpha[0] + start_alpha_x * alpha_range;
-                    end_alpha = (float)blit_info->alpha[1] - end_alpha_x * alpha_range;
-                    break;
-                case TIG_ART_BLT_BLEND_ALPHA_LERP_Y:
-                    start_alpha_vertical_step = ((float)blit_info->alpha[3] - (float)blit_info->alpha[0]) / height;
-                    end_alpha_vertical_step = start_alpha_vertical_step;
-                    start_alpha = src_rect.y * start_alpha_vertical_step + (float)blit_info->alpha[0];
-                    end_alpha = start_alpha;
-                    break;
-                default:
-                    start_alpha_vertical_step = ((float)blit_info->alpha[3] - (float)blit_info->alpha[0]) / height;
-                    end_alpha_vertical_step = ((float)(uint8_t)blit_info->alpha[2] - (float)blit_info->alpha[1]) / height;
-                    start_alpha_x = (float)src_rect.x;
-                    end_alpha_x = (float)(width - src_rect.width - src_rect.x);
-                    alpha_range = ((src_rect.y * end_alpha_vertical_step + (float)blit_info->alpha[1]) - (src_rect.y * start_alpha_vertical_step + (float)blit_info->alpha[0])) / width;
-                    start_alpha = (src_rect.y * start_alpha_vertical_step + (float)blit_info->alpha[0]) + start_alpha_x * alpha_range;
-                    end_alpha = (src_rect.y * end_alpha_vertical_step + (float)blit_info->alpha[1]) - end_alpha_x * alpha_range;
-                    break;
-                }
+    return cache_entry_index;
+}
 
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    for (y = 0; y < dst_rect.height; y++) {
-                        current_alpha = start_alpha;
-                        alpha_horizontal_step = (end_alpha - start_alpha) / src_rect.width;
-                        mask = &(blit_info->field_14[src_rect.x]);
-
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (*src_pixels != 0) {
-                                uint32_t color = tig_color_mul(((uint32_t*)plt)[*src_pixels], *mask);
-                                *(uint32_t*)dst_pixels = tig_color_blend_alpha(color,
-                                    *(uint32_t*)dst_pixels,
-                                    (int)current_alpha);
-                            }
-                            src_pixels += src_step;
-                            dst_pixels += 4;
-
-                            current_alpha += alpha_horizontal_step;
-                            mask++;
-                        }
-                        src_pixels += src_pitch;
-                        dst_pixels += dst_skip;
+// 0x51AC00
+void tig_art_cache_set_video_memory_fullness(int fullness)
+{
+    tig_art_cache_video_memory_fullness = (float)fullness / 100.0f;
+}
 
-                        start_alpha += start_alpha_vertical_step;
-                        end_alpha += end_alpha_vertical_step;
-                    }
-                    break;
-                }
-            } else if ((blit_info->flags & TIG_ART_BLT_BLEND_ALPHA_STIPPLE_S) != 0) {
-                // 0x50DA0F
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    for (y = 0; y < dst_rect.height; y++) {
-                        mask = &(blit_info->field_14[src_rect.x]);
-
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (((src_checkerboard_cur_x ^ src_checkerboard_cur_y) & 1) != 0) {
-                                if (*src_pixels != 0) {
-                                    *(uint32_t*)dst_pixels = tig_color_mul(((uint32_t*)plt)[*src_pixels], *mask);
-                                }
-                            }
-                            src_pixels += src_step;
-                            dst_pixels += 4;
-
-                            src_checkerboard_cur_x++;
-                            mask++;
-                        }
-                        src_pixels += src_pitch;
-                        dst_pixels += dst_skip;
+void tig_art_cache_set_rle_enabled(int type, bool enabled)
+{
+    if (type < 0 || type >= 32) {
+        return;
+    }
 
-                        src_checkerboard_cur_x = src_rect.x;
-                        src_checkerboard_cur_y++;
-                    }
-                    break;
-                }
-            } else if ((blit_info->flags & TIG_ART_BLT_BLEND_ALPHA_STIPPLE_D) != 0) {
-                // 0x50DEE7
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    for (y = 0; y < dst_rect.height; y++) {
-                        mask = &(blit_info->field_14[src_rect.x]);
-
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (((dst_checkerboard_cur_x ^ dst_checkerboard_cur_y) & 1) != 0) {
-                                if (*src_pixels != 0) {
-                                    *(uint32_t*)dst_pixels = tig_color_mul(((uint32_t*)plt)[*src_pixels], *mask);
-                                }
-                            }
-                            src_pixels += src_step;
-                            dst_pixels += 4;
-
-                            dst_checkerboard_cur_x++;
-                            mask++;
-                        }
-                        src_pixels += src_pitch;
-                        dst_pixels += dst_skip;
+    if (enabled) {
+        tig_art_rle_types |= 1u << type;
+    } else {
+        tig_art_rle_types &= ~(1u << type);
+    }
+}
 
-                        dst_checkerboard_cur_x = dst_rect.x;
-                        dst_checkerboard_cur_y++;
-                    }
-                    break;
-                }
-            } else {
-                // 0x50CD1B
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    for (y = 0; y < dst_rect.height; y++) {
-                        mask = &(blit_info->field_14[src_rect.x]);
-
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (*src_pixels != 0) {
-                                *(uint32_t*)dst_pixels = tig_color_mul(((uint32_t*)plt)[*src_pixels], *mask);
-                            }
-                            src_pixels += src_step;
-                            dst_pixels += 4;
-
-                            mask++;
-                        }
-                        src_pixels += src_pitch;
-                        dst_pixels += dst_skip;
-                    }
-                    break;
-                }
+void tig_art_cache_set_palette_indirect(bool enabled)
+{
+    int index;
+
+    if (tig_art_palette_indirect == enabled) {
+        return;
+    }
+
+    tig_art_palette_indirect = enabled;
+
+    if (enabled && tig_art_initialized && !dword_604718) {
+        for (index = 0; index < tig_art_cache_entries_length; index++) {
+            if ((tig_art_cache_entries[index].flags & TIG_ART_CACHE_ENTRY_LOADED) != 0) {
+                art_release_video_buffers(index);
             }
-        } else if ((blit_info->flags & TIG_ART_BLT_BLEND_COLOR_LERP) != 0) {
-            // 0x50F3B4
-            int tl_r = tig_color_get_red(blit_info->field_14[0]);
-            int tl_g = tig_color_get_green(blit_info->field_14[0]);
-            int tl_b = tig_color_get_blue(blit_info->field_14[0]);
-
-            int tr_r = tig_color_get_red(blit_info->field_14[1]);
-            int tr_g = tig_color_get_green(blit_info->field_14[1]);
-            int tr_b = tig_color_get_blue(blit_info->field_14[1]);
-
-            int br_r = tig_color_get_red(blit_info->field_14[2]);
-            int br_g = tig_color_get_green(blit_info->field_14[2]);
-            int br_b = tig_color_get_blue(blit_info->field_14[2]);
-
-            int bl_r = tig_color_get_red(blit_info->field_14[3]);
-            int bl_g = tig_color_get_green(blit_info->field_14[3]);
-            int bl_b = tig_color_get_blue(blit_info->field_14[3]);
-
-            float vert_start_step_r = (float)(bl_r - tl_r) / blit_info->field_18->height;
-            float vert_start_r = vert_start_step_r * (src_rect.y - blit_info->field_18->y) + tl_r;
-            float vert_end_step_r = (float)(br_r - tr_r) / blit_info->field_18->height;
-            float vert_end_r = vert_end_step_r * (src_rect.y - blit_info->field_18->y) + tr_r;
-
-            float vert_start_step_g = (float)(bl_g - tl_g) / blit_info->field_18->height;
-            float vert_start_g = vert_start_step_g * (src_rect.y - blit_info->field_18->y) + tl_g;
-            float vert_end_step_g = (float)(br_g - tr_g) / blit_info->field_18->height;
-            float vert_end_g = vert_end_step_g * (src_rect.y - blit_info->field_18->y) + tr_g;
-
-            float vert_start_step_b = (float)(bl_b - tl_b) / blit_info->field_18->height;
-            float vert_start_b = vert_start_step_b * (src_rect.y - blit_info->field_18->y) + tl_b;
-            float vert_end_step_b = (float)(br_b - tr_b) / blit_info->field_18->height;
-            float vert_end_b = vert_end_step_b * (src_rect.y - blit_info->field_18->y) + tr_b;
-
-            switch (tig_art_bits_per_pixel) {
-            case 32:
-                for (y = 0; y < dst_rect.height; y++) {
-                    float hor_step_r = (vert_end_r - vert_start_r) / blit_info->field_18->width;
-                    float hor_step_g = (vert_end_g - vert_start_g) / blit_info->field_18->width;
-                    float hor_step_b = (vert_end_b - vert_start_b) / blit_info->field_18->width;
-
-                    float r = vert_start_r + hor_step_r * (src_rect.x - blit_info->field_18->x);
-                    float g = vert_start_g + hor_step_g * (src_rect.x - blit_info->field_18->x);
-                    float b = vert_start_b + hor_step_b * (src_rect.x - blit_info->field_18->x);
-
-                    for (x = 0; x < dst_rect.width; x++) {
-                        if (*src_pixels != 0) {
-                            uint32_t color = tig_color_make((uint8_t)r, (uint8_t)g, (uint8_t)b);
-                            color = tig_color_mul(((uint32_t*)plt)[*src_pixels], color);
-                            *(uint32_t*)dst_pixels = color;
-                        }
-                        src_pixels += src_step;
-                        dst_pixels += 4;
+        }
+    }
+}
 
-                        r += hor_step_r;
-                        g += hor_step_g;
-                        b += hor_step_b;
-                    }
-                    src_pixels += src_pitch;
-                    dst_pixels += dst_skip;
+void tig_art_cache_stats(TigArtCacheStats* stats)
+{
+    TigArtCacheEntry* art;
+    int index;
+    int type;
 
-                    vert_start_r += vert_start_step_r;
-                    vert_end_r += vert_end_step_r;
+    *stats = tig_art_cache_counters;
 
-                    vert_start_g += vert_start_step_g;
-                    vert_end_g += vert_end_step_g;
+    stats->entries = tig_art_cache_entries_count;
+    stats->system_memory_usage = tig_art_total_system_memory - tig_art_available_system_memory;
+    stats->system_memory_max = tig_art_total_system_memory;
+    stats->video_memory_usage = tig_art_total_video_memory - tig_art_available_video_memory;
+    stats->video_memory_max = tig_art_total_video_memory;
+    stats->atlas_video_memory_usage = tig_art_atlases_video_memory;
 
-                    vert_start_b += vert_start_step_b;
-                    vert_end_b += vert_end_step_b;
-                }
-                break;
-            }
-        } else {
-            // 0x50655B
-            if ((blit_info->flags & TIG_ART_BLT_BLEND_ADD) != 0) {
-                // 0x506566
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    for (y = 0; y < dst_rect.height; y++) {
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (*src_pixels != 0) {
-                                *(uint32_t*)dst_pixels = tig_color_add(((uint32_t*)plt)[*src_pixels],
-                                    *(uint32_t*)dst_pixels);
-                            }
-                            src_pixels += src_step;
-                            dst_pixels += 4;
-                        }
-                        src_pixels += src_pitch;
-                        dst_pixels += dst_skip;
-                    }
-                    break;
-                }
-            } else if ((blit_info->flags & TIG_ART_BLT_BLEND_SUB) != 0) {
-                // 0x506838
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    for (y = 0; y < dst_rect.height; y++) {
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (*src_pixels != 0) {
-                                *(uint32_t*)dst_pixels = tig_color_sub(((uint32_t*)plt)[*src_pixels],
-                                    *(uint32_t*)dst_pixels);
-                            }
-                            src_pixels += src_step;
-                            dst_pixels += 4;
-                        }
-                        src_pixels += src_pitch;
-                        dst_pixels += dst_skip;
-                    }
-                    break;
-                }
-            } else if ((blit_info->flags & TIG_ART_BLT_BLEND_MUL) != 0) {
-                // 0x506B87
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    for (y = 0; y < dst_rect.height; y++) {
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (*src_pixels != 0) {
-                                *(uint32_t*)dst_pixels = tig_color_mul(((uint32_t*)plt)[*src_pixels],
-                                    *(uint32_t*)dst_pixels);
-                            }
-                            src_pixels += src_step;
-                            dst_pixels += 4;
-                        }
-                        src_pixels += src_pitch;
-                        dst_pixels += dst_skip;
-                    }
-                    break;
-                }
-            } else if ((blit_info->flags & TIG_ART_BLT_BLEND_ALPHA_AVG) != 0) {
-                // 0x506FD0
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    for (y = 0; y < dst_rect.height; y++) {
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (*src_pixels != 0) {
-                                *(uint32_t*)dst_pixels = tig_color_blend_alpha(((uint32_t*)plt)[*src_pixels],
-                                    *(uint32_t*)dst_pixels,
-                                    tig_color_rgb_to_grayscale(((uint32_t*)plt)[*src_pixels]));
-                            }
-                            src_pixels += src_step;
-                            dst_pixels += 4;
-                        }
-                        src_pixels += src_pitch;
-                        dst_pixels += dst_skip;
-                    }
-                    break;
-                }
-            } else if ((blit_info->flags & TIG_ART_BLT_BLEND_ALPHA_CONST) != 0) {
-                // 0x50742A
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    for (y = 0; y < dst_rect.height; y++) {
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (*src_pixels != 0) {
-                                *(uint32_t*)dst_pixels = tig_color_blend_alpha(((uint32_t*)plt)[*src_pixels],
-                                    *(uint32_t*)dst_pixels,
-                                    blit_info->alpha[0]);
-                            }
-                            src_pixels += src_step;
-                            dst_pixels += 4;
-                        }
-                        src_pixels += src_pitch;
-                        dst_pixels += dst_skip;
-                    }
-                    break;
-                }
-            } else if ((blit_info->flags & TIG_ART_BLT_BLEND_ALPHA_SRC) != 0) {
-                // 0x507B0F
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    for (y = 0; y < dst_rect.height; y++) {
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (*src_pixels != 0) {
-                                *(uint32_t*)dst_pixels = tig_color_blend_alpha(((uint32_t*)plt)[*src_pixels],
-                                    *(uint32_t*)dst_pixels,
-                                    tig_color_alpha(((uint32_t*)plt)[*src_pixels]));
-                            }
-                            src_pixels += src_step;
-                            dst_pixels += 4;
-                        }
-                        src_pixels += src_pitch;
-                        dst_pixels += dst_skip;
-                    }
-                    break;
-                }
-            } else if ((blit_info->flags & TIG_ART_BLT_BLEND_ALPHA_LERP_ANY) != 0) {
-                // 0x507ECB
-                switch (blit_info->flags & TIG_ART_BLT_BLEND_ALPHA_LERP_ANY) {
-                case TIG_ART_BLT_BLEND_ALPHA_LERP_X:
-                    start_alpha_vertical_step = 0.0;
-                    end_alpha_vertical_step = 0.0;
-                    start_alpha_x = (float)src_rect.x;
-                    end_alpha_x = (float)(width - src_rect.width - src_rect.x);
-                    alpha_range = ((float)blit_info->alpha[1] - (float)blit_info->alpha[0]) / width;
-                    start_alpha = (float)blit_info->alpha[0] + start_alpha_x * alpha_range;
-                    end_alpha = (float)blit_info->alpha[1] - end_alpha_x * alpha_range;
-                    break;
-                case TIG_ART_BLT_BLEND_ALPHA_LERP_Y:
-                    start_alpha_vertical_step = ((float)blit_info->alpha[3] - (float)blit_info->alpha[0]) / height;
-                    end_alpha_vertical_step = start_alpha_vertical_step;
-                    start_alpha = src_rect.y * start_alpha_vertical_step + (float)blit_info->alpha[0];
-                    end_alpha = start_alpha;
-                    break;
-                default:
-                    start_alpha_vertical_step = ((float)blit_info->alpha[3] - (float)blit_info->alpha[0]) / height;
-                    end_alpha_vertical_step = ((float)(uint8_t)blit_info->alpha[2] - (float)blit_info->alpha[1]) / height;
-                    start_alpha_x = (float)src_rect.x;
-                    end_alpha_x = (float)(width - src_rect.width - src_rect.x);
-                    alpha_range = ((src_rect.y * end_alpha_vertical_step + (float)blit_info->alpha[1]) - (src_rect.y * start_alpha_vertical_step + (float)blit_info->alpha[0])) / width;
-                    start_alpha = (src_rect.y * start_alpha_vertical_step + (float)blit_info->alpha[0]) + start_alpha_x * alpha_range;
-                    end_alpha = (src_rect.y * end_alpha_vertical_step + (float)blit_info->alpha[1]) - end_alpha_x * alpha_range;
-                    break;
-                }
+    for (index = 0; index < tig_art_atlases_count; index++) {
+        if (tig_art_atlases[index].video_buffer != NULL) {
+            stats->atlases++;
+        }
+    }
+
+    for (index = tig_art_cache_lru_head; index != TIG_ART_CACHE_NONE; index = art->next) {
+        art = &(tig_art_cache_entries[index]);
+
+        type = tig_art_type(art->art_id);
+        if (type < TIG_ART_TYPE_COUNT) {
+            stats->entries_by_type[type]++;
+            stats->system_memory_usage_by_type[type] += art->system_memory_usage;
+            stats->video_memory_usage_by_type[type] += art->video_memory_usage;
+        }
+    }
+}
+
+void tig_art_cache_reset_stats()
+{
+    memset(&tig_art_cache_counters, 0, sizeof(tig_art_cache_counters));
+}
+
+bool tig_art_cache_enumerate(TigArtCacheEnumerateCallback* callback, void* context)
+{
+    TigArtCacheEntry* art;
+    TigArtCacheEntryInfo info;
+    int index;
+
+    for (index = tig_art_cache_lru_head; index != TIG_ART_CACHE_NONE; index = art->next) {
+        art = &(tig_art_cache_entries[index]);
+
+        info.art_id = art->art_id;
+        info.path = art->path;
+        info.time = art->time;
+        info.system_memory_usage = art->system_memory_usage;
+        info.video_memory_usage = art->video_memory_usage;
+        info.rle = (art->flags & TIG_ART_CACHE_ENTRY_RLE) != 0;
+
+        if (!callback(&info, context)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Destroys video buffers of the cache entry and returns their memory to the
+// cache budget.
+void art_release_video_buffers(int cache_entry_index)
+{
+    TigArtCacheEntry* art;
+    int num_frames;
+    int palette;
+    int rotation;
+    art_size_t system_memory_size = 0;
+
+    art = &(tig_art_cache_entries[cache_entry_index]);
+
+    if (tig_art_type(art->art_id) == TIG_ART_TYPE_ROOF) {
+        num_frames = 13;
+    } else {
+        num_frames = art->hdr.num_frames;
+    }
+
+    for (palette = 0; palette < MAX_PALETTES; palette++) {
+        for (rotation = 0; rotation < MAX_ROTATIONS; rotation++) {
+            if (art->video_buffers[palette][rotation] != NULL) {
+                system_memory_size += (sizeof(TigVideoBuffer*) + sizeof(TigArtAtlasSlot)) * num_frames;
+            }
+        }
+    }
+
+    sub_51B650(cache_entry_index);
+
+    art->system_memory_usage -= system_memory_size;
+    tig_art_cache_entry_account(cache_entry_index, -system_memory_size, -art->video_memory_usage);
+    art->video_memory_usage = 0;
+}
+
+int tig_art_prefetch(const tig_art_id_t* ids, int count)
+{
+    int index;
+    int cache_entry_index;
+    tig_art_id_t key;
+    TigArtPrefetchJob* job;
+    bool found;
+
+    if (!tig_art_initialized) {
+        return TIG_ERR_NOT_INITIALIZED;
+    }
+
+    if (ids == NULL || count < 0) {
+        return TIG_ERR_INVALID_PARAM;
+    }
+
+    if (tig_art_prefetch_threads_count == 0 && !tig_art_prefetch_start()) {
+        return TIG_ERR_GENERIC;
+    }
+
+    for (index = 0; index < count; index++) {
+        key = tig_art_cache_key(ids[index]);
+        if (tig_art_cache_find(key, &cache_entry_index)
+            || tig_art_missing_find(key)) {
+            continue;
+        }
+
+        SDL_LockMutex(tig_art_prefetch_mutex);
+        found = tig_art_prefetch_find(key);
+        SDL_UnlockMutex(tig_art_prefetch_mutex);
+
+        if (found) {
+            continue;
+        }
+
+        // Paths are resolved here since path resolver is not expected to be
+        // called from other threads.
+        job = (TigArtPrefetchJob*)MALLOC(sizeof(*job));
+        if (tig_art_build_path(ids[index], job->path) != TIG_OK) {
+            FREE(job);
+            continue;
+        }
+
+        job->art_id = ids[index];
+        job->key = key;
+        job->generation = tig_art_prefetch_generation;
+        job->loaded = false;
+        job->next = NULL;
+
+        SDL_LockMutex(tig_art_prefetch_mutex);
+        if (tig_art_prefetch_queue_tail != NULL) {
+            tig_art_prefetch_queue_tail->next = job;
+        } else {
+            tig_art_prefetch_queue_head = job;
+        }
+        tig_art_prefetch_queue_tail = job;
+        SDL_SignalCondition(tig_art_prefetch_queued_cond);
+        SDL_UnlockMutex(tig_art_prefetch_mutex);
+    }
+
+    return TIG_OK;
+}
+
+int tig_art_prefetch_pending()
+{
+    TigArtPrefetchJob* job;
+    int count;
+    int index;
+
+    if (tig_art_prefetch_threads_count == 0) {
+        return 0;
+    }
+
+    tig_art_prefetch_publish();
+
+    count = 0;
+
+    SDL_LockMutex(tig_art_prefetch_mutex);
+
+    for (job = tig_art_prefetch_queue_head; job != NULL; job = job->next) {
+        count++;
+    }
+
+    for (index = 0; index < tig_art_prefetch_threads_count; index++) {
+        if (tig_art_prefetch_running[index] != NULL) {
+            count++;
+        }
+    }
+
+    for (job = tig_art_prefetch_finished_head; job != NULL; job = job->next) {
+        count++;
+    }
+
+    SDL_UnlockMutex(tig_art_prefetch_mutex);
+
+    return count;
+}
+
+// Starts prefetch worker threads.
+bool tig_art_prefetch_start()
+{
+    int count;
+    int index;
+
+    count = SDL_GetNumLogicalCPUCores() - 1;
+    if (count < 1) {
+        count = 1;
+    } else if (count > TIG_ART_PREFETCH_MAX_THREADS) {
+        count = TIG_ART_PREFETCH_MAX_THREADS;
+    }
+
+    tig_art_prefetch_mutex = SDL_CreateMutex();
+    tig_art_prefetch_queued_cond = SDL_CreateCondition();
+    tig_art_prefetch_finished_cond = SDL_CreateCondition();
+    tig_art_prefetch_quit = false;
+
+    for (index = 0; index < count; index++) {
+        tig_art_prefetch_running[index] = NULL;
+        tig_art_prefetch_threads[index] = SDL_CreateThread(tig_art_prefetch_worker, "tig_art_prefetch", (void*)(intptr_t)index);
+        if (tig_art_prefetch_threads[index] == NULL) {
+            break;
+        }
+
+        tig_art_prefetch_threads_count++;
+    }
+
+    if (tig_art_prefetch_threads_count == 0) {
+        tig_debug_printf("Art: Error - unable to start prefetch threads: %s\n", SDL_GetError());
+        tig_art_prefetch_stop();
+        return false;
+    }
+
+    return true;
+}
+
+// Stops prefetch worker threads and discards unpublished art.
+void tig_art_prefetch_stop()
+{
+    TigArtPrefetchJob* job;
+    int index;
+
+    if (tig_art_prefetch_mutex == NULL) {
+        return;
+    }
+
+    SDL_LockMutex(tig_art_prefetch_mutex);
+    tig_art_prefetch_quit = true;
+    SDL_BroadcastCondition(tig_art_prefetch_queued_cond);
+    SDL_UnlockMutex(tig_art_prefetch_mutex);
+
+    for (index = 0; index < tig_art_prefetch_threads_count; index++) {
+        SDL_WaitThread(tig_art_prefetch_threads[index], NULL);
+        tig_art_prefetch_threads[index] = NULL;
+    }
+    tig_art_prefetch_threads_count = 0;
+
+    while (tig_art_prefetch_queue_head != NULL) {
+        job = tig_art_prefetch_queue_head;
+        tig_art_prefetch_queue_head = job->next;
+        FREE(job);
+    }
+    tig_art_prefetch_queue_tail = NULL;
+
+    while (tig_art_prefetch_finished_head != NULL) {
+        job = tig_art_prefetch_finished_head;
+        tig_art_prefetch_finished_head = job->next;
+        tig_art_prefetch_discard(job);
+    }
+
+    SDL_DestroyCondition(tig_art_prefetch_finished_cond);
+    tig_art_prefetch_finished_cond = NULL;
+
+    SDL_DestroyCondition(tig_art_prefetch_queued_cond);
+    tig_art_prefetch_queued_cond = NULL;
+
+    SDL_DestroyMutex(tig_art_prefetch_mutex);
+    tig_art_prefetch_mutex = NULL;
+}
+
+int SDLCALL tig_art_prefetch_worker(void* userdata)
+{
+    int slot;
+    TigArtPrefetchJob* job;
+
+    slot = (int)(intptr_t)userdata;
+
+    SDL_LockMutex(tig_art_prefetch_mutex);
+
+    while (!tig_art_prefetch_quit) {
+        job = tig_art_prefetch_queue_head;
+        if (job == NULL) {
+            SDL_WaitCondition(tig_art_prefetch_queued_cond, tig_art_prefetch_mutex);
+            continue;
+        }
+
+        tig_art_prefetch_queue_head = job->next;
+        if (tig_art_prefetch_queue_head == NULL) {
+            tig_art_prefetch_queue_tail = NULL;
+        }
+        tig_art_prefetch_running[slot] = job;
+
+        SDL_UnlockMutex(tig_art_prefetch_mutex);
+
+        job->loaded = tig_art_cache_entry_read(job->art_id, job->path, &(job->entry), true);
+
+        SDL_LockMutex(tig_art_prefetch_mutex);
+
+        tig_art_prefetch_running[slot] = NULL;
+        job->next = tig_art_prefetch_finished_head;
+        tig_art_prefetch_finished_head = job;
+        SDL_BroadcastCondition(tig_art_prefetch_finished_cond);
+    }
+
+    SDL_UnlockMutex(tig_art_prefetch_mutex);
+
+    return 0;
+}
+
+// Checks if the art is queued, being loaded or waiting to be published. The
+// caller is responsible for locking `tig_art_prefetch_mutex`.
+bool tig_art_prefetch_find(tig_art_id_t key)
+{
+    TigArtPrefetchJob* job;
+    int index;
+
+    for (job = tig_art_prefetch_queue_head; job != NULL; job = job->next) {
+        if (job->key == key) {
+            return true;
+        }
+    }
+
+    for (index = 0; index < tig_art_prefetch_threads_count; index++) {
+        if (tig_art_prefetch_running[index] != NULL
+            && tig_art_prefetch_running[index]->key == key) {
+            return true;
+        }
+    }
+
+    for (job = tig_art_prefetch_finished_head; job != NULL; job = job->next) {
+        if (job->key == key) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Adds art loaded by prefetch workers to the cache.
+void tig_art_prefetch_publish()
+{
+    TigArtPrefetchJob* job;
+    TigArtPrefetchJob* next;
+    TigArtCacheEntry* art;
+    int cache_entry_index;
+
+    if (tig_art_prefetch_threads_count == 0) {
+        return;
+    }
+
+    SDL_LockMutex(tig_art_prefetch_mutex);
+    job = tig_art_prefetch_finished_head;
+    tig_art_prefetch_finished_head = NULL;
+    SDL_UnlockMutex(tig_art_prefetch_mutex);
+
+    while (job != NULL) {
+        next = job->next;
+
+        // Failed art is left for the regular loading, which takes care of
+        // reporting and fallback art.
+        if (!job->loaded
+            || job->generation != tig_art_prefetch_generation
+            || tig_art_cache_find(job->key, &cache_entry_index)) {
+            tig_art_prefetch_discard(job);
+            job = next;
+            continue;
+        }
+
+        // Called twice to check both system and video memory.
+        tig_art_cache_check_fullness();
+        tig_art_cache_check_fullness();
+        tig_art_cache_check_budgets();
+
+        cache_entry_index = tig_art_cache_entry_alloc();
+        art = &(tig_art_cache_entries[cache_entry_index]);
+        *art = job->entry;
+        tig_art_cache_entry_create_palettes(job->art_id, art);
+
+        art->flags |= TIG_ART_CACHE_ENTRY_LOADED;
+        tig_art_cache_entries_count++;
+        tig_art_cache_entry_account(cache_entry_index, art->system_memory_usage, 0);
+
+        art->key = job->key;
+        art->time = tig_ping_timestamp;
+        tig_art_cache_buckets_insert(cache_entry_index);
+        tig_art_cache_lru_link(cache_entry_index);
+        tig_art_cache_counters.prefetched++;
+
+        FREE(job);
+        job = next;
+    }
+}
+
+// Makes sure the art is not being prefetched, so that the caller can load it
+// right away. Art which is still queued is cancelled, art which is being
+// loaded is waited for. Returns `true` if prefetched art was published.
+bool tig_art_prefetch_sync(tig_art_id_t key)
+{
+    TigArtPrefetchJob* job;
+    TigArtPrefetchJob* prev;
+    int index;
+    bool loading;
+    bool published;
+
+    if (tig_art_prefetch_threads_count == 0) {
+        return false;
+    }
+
+    SDL_LockMutex(tig_art_prefetch_mutex);
+
+    prev = NULL;
+    for (job = tig_art_prefetch_queue_head; job != NULL; job = job->next) {
+        if (job->key == key) {
+            if (prev != NULL) {
+                prev->next = job->next;
+            } else {
+                tig_art_prefetch_queue_head = job->next;
+            }
+
+            if (tig_art_prefetch_queue_tail == job) {
+                tig_art_prefetch_queue_tail = prev;
+            }
+
+            FREE(job);
+            break;
+        }
+        prev = job;
+    }
+
+    do {
+        loading = false;
+        for (index = 0; index < tig_art_prefetch_threads_count; index++) {
+            if (tig_art_prefetch_running[index] != NULL
+                && tig_art_prefetch_running[index]->key == key) {
+                loading = true;
+                SDL_WaitCondition(tig_art_prefetch_finished_cond, tig_art_prefetch_mutex);
+                break;
+            }
+        }
+    } while (loading);
+
+    published = tig_art_prefetch_finished_head != NULL;
+
+    SDL_UnlockMutex(tig_art_prefetch_mutex);
+
+    if (published) {
+        tig_art_prefetch_publish();
+    }
+
+    return published;
+}
+
+// Frees prefetch job along with the art loaded by it.
+void tig_art_prefetch_discard(TigArtPrefetchJob* job)
+{
+    int palette;
+
+    if (job->loaded) {
+        tig_art_cache_entry_free_frames(&(job->entry));
+
+        for (palette = 0; palette < MAX_PALETTES; palette++) {
+            if (job->entry.hdr.palette_tbl[palette] != NULL) {
+                FREE(job->entry.hdr.palette_tbl[palette]);
+            }
+        }
+    }
+
+    FREE(job);
+}
+
+// 0x51AC20
+void tig_art_cache_check_fullness()
+{
+    // Flag that denotes if we should check video memory (true) or system memory
+    // (false). This flag alternates on every call.
+    //
+    // 0x604728
+    static bool vid_vs_sys;
+
+    art_size_t acc = 0;
+    art_size_t tgt;
+    art_size_t available;
+    int index;
+    int prev;
+
+    if (vid_vs_sys) {
+        // NOTE: Signed compare.
+        if (tig_art_available_video_memory > 0) {
+            vid_vs_sys = !vid_vs_sys;
+            return;
+        }
+
+        tig_debug_printf("Art cache full (vid), making some room");
+
+        // Calculate target size we'd like to evict.
+        tgt = (art_size_t)((double)tig_art_total_video_memory * tig_art_cache_video_memory_fullness);
+    } else {
+        // NOTE: Signed compare.
+        if (tig_art_available_system_memory > 0) {
+            vid_vs_sys = !vid_vs_sys;
+            return;
+        }
+
+        tig_debug_printf("Art cache full (sys), making some room");
+
+        // Calculate target size we'd like to evict (30% of total system
+        // memory).
+        tgt = (art_size_t)((double)tig_art_total_system_memory * 0.3f);
+    }
+
+    // Evict least recently used cache entries until we reach eviction target
+    // (or run out of entries). Freed memory is measured by available memory
+    // rather than summed from entries, since atlases are not charged to
+    // entries and are only freed once all their frames are evicted.
+    available = vid_vs_sys ? tig_art_available_video_memory : tig_art_available_system_memory;
+    index = tig_art_cache_lru_tail;
+    while (index != TIG_ART_CACHE_NONE) {
+        prev = tig_art_cache_entries[index].prev;
+
+        if ((tig_art_cache_entries[index].flags & TIG_ART_CACHE_ENTRY_PINNED) != 0) {
+            index = prev;
+            continue;
+        }
+
+        tig_art_cache_lru_unlink(index);
+        tig_art_cache_entry_unload(index);
+        tig_art_cache_buckets_remove(index);
+        tig_art_cache_entry_free(index);
+        tig_art_cache_counters.evictions++;
+
+        if (vid_vs_sys) {
+            acc = tig_art_available_video_memory - available;
+        } else {
+            acc = tig_art_available_system_memory - available;
+        }
+
+        index = prev;
+
+        // NOTE: Signed compare.
+        if (acc >= tgt) {
+            break;
+        }
+    }
+
+    dword_604714 = TIG_ART_CACHE_NONE;
+
+    tig_debug_printf("...\n");
+    vid_vs_sys = !vid_vs_sys;
+}
+
+// Evicts least recently used art of types which exceed their memory budgets
+// (see `TigInitInfo::art_cache_budgets`). Like `tig_art_cache_check_fullness`
+// this makes 30% of the budget available, so that it is not triggered again
+// right away.
+void tig_art_cache_check_budgets()
+{
+    int type;
+    int index;
+    int prev;
+    art_size_t system_memory_budget;
+    art_size_t video_memory_budget;
+    bool evicted = false;
+
+    for (type = 0; type < TIG_ART_TYPE_COUNT; type++) {
+        if (tig_art_type_budgets[type] == 0) {
+            continue;
+        }
+
+        system_memory_budget = (art_size_t)((double)tig_art_total_system_memory * tig_art_type_budgets[type] / 100.0);
+        video_memory_budget = (art_size_t)((double)tig_art_total_video_memory * tig_art_type_budgets[type] / 100.0);
+
+        if (tig_art_type_system_memory[type] <= system_memory_budget
+            && tig_art_type_video_memory[type] <= video_memory_budget) {
+            continue;
+        }
+
+        tig_debug_printf("Art cache budget of type %d exceeded, making some room", type);
+
+        system_memory_budget = (art_size_t)((double)system_memory_budget * 0.7);
+        video_memory_budget = (art_size_t)((double)video_memory_budget * 0.7);
+
+        index = tig_art_cache_lru_tail;
+        while (index != TIG_ART_CACHE_NONE
+            && (tig_art_type_system_memory[type] > system_memory_budget
+                || tig_art_type_video_memory[type] > video_memory_budget)) {
+            prev = tig_art_cache_entries[index].prev;
+
+            if (tig_art_type(tig_art_cache_entries[index].art_id) == type
+                && (tig_art_cache_entries[index].flags & TIG_ART_CACHE_ENTRY_PINNED) == 0) {
+                tig_art_cache_lru_unlink(index);
+                tig_art_cache_entry_unload(index);
+                tig_art_cache_buckets_remove(index);
+                tig_art_cache_entry_free(index);
+                tig_art_cache_counters.evictions++;
+                evicted = true;
+            }
+
+            index = prev;
+        }
+
+        tig_debug_printf("...\n");
+    }
+
+    if (evicted) {
+        dword_604714 = TIG_ART_CACHE_NONE;
+    }
+}
+
+// Updates memory usage of the art cache and the art type of the cache entry
+// when entry memory usage changes by the specified amounts.
+void tig_art_cache_entry_account(int cache_entry_index, art_size_t system_memory_size, art_size_t video_memory_size)
+{
+    int type;
+
+    tig_art_available_system_memory -= system_memory_size;
+    tig_art_available_video_memory -= video_memory_size;
+
+    type = tig_art_type(tig_art_cache_entries[cache_entry_index].art_id);
+    if (type < TIG_ART_TYPE_COUNT) {
+        tig_art_type_system_memory[type] += system_memory_size;
+        tig_art_type_video_memory[type] += video_memory_size;
+    }
+}
+
+// 0x51AE50
+int tig_art_build_path(unsigned int art_id, char* path)
+{
+    if (tig_art_type(art_id) == TIG_ART_TYPE_MISC) {
+        switch (tig_art_num_get(art_id)) {
+        case TIG_ART_SYSTEM_MOUSE:
+            strcpy(path, "art\\mouse.art");
+            return TIG_OK;
+        case TIG_ART_SYSTEM_BUTTON:
+            strcpy(path, "art\\button.art");
+            return TIG_OK;
+        case TIG_ART_SYSTEM_UP:
+            strcpy(path, "art\\up.art");
+            return TIG_OK;
+        case TIG_ART_SYSTEM_DOWN:
+            strcpy(path, "art\\down.art");
+            return TIG_OK;
+        case TIG_ART_SYSTEM_CANCEL:
+            strcpy(path, "art\\cancel.art");
+            return TIG_OK;
+        case TIG_ART_SYSTEM_LENS:
+            strcpy(path, "art\\lens.art");
+            return TIG_OK;
+        case TIG_ART_SYSTEM_X:
+            strcpy(path, "art\\x.art");
+            return TIG_OK;
+        case TIG_ART_SYSTEM_PLUS:
+            strcpy(path, "art\\plus.art");
+            return TIG_OK;
+        case TIG_ART_SYSTEM_MINUS:
+            strcpy(path, "art\\minus.art");
+            return TIG_OK;
+        case TIG_ART_SYSTEM_BLANK:
+            strcpy(path, "art\\blank.art");
+            return TIG_OK;
+        case TIG_ART_SYSTEM_FONT:
+            strcpy(path, "art\\morph15font.art");
+            return TIG_OK;
+        }
+    } else {
+        if (tig_art_file_path_resolver != NULL) {
+            return tig_art_file_path_resolver(art_id, path);
+        }
+    }
+
+    return TIG_ERR_GENERIC;
+}
+
+// 0x51B0A0
+tig_art_id_t tig_art_id_reset(tig_art_id_t art_id)
+{
+    if (tig_art_type(art_id) == TIG_ART_TYPE_MISC) {
+        art_id = tig_art_id_palette_set(art_id, 0);
+        art_id = tig_art_id_frame_set(art_id, 0);
+        return art_id;
+    }
+
+    if (tig_art_id_reset_func != NULL) {
+        return tig_art_id_reset_func(art_id);
+    }
+
+    return art_id;
+}
+
+// Returns key identifying art file of `art_id` in the art cache.
+//
+// Without `tig_art_id_reset_func` the properties which are stored in the art
+// file rather than denote separate files are stripped the same way setters
+// treat them for every type: frame and palette, as well as rotation unless
+// it selects wall piece.
+tig_art_id_t tig_art_cache_key(tig_art_id_t art_id)
+{
+    int type;
+
+    type = tig_art_type(art_id);
+    if (type == TIG_ART_TYPE_MISC || tig_art_id_reset_func != NULL) {
+        return tig_art_id_reset(art_id);
+    }
+
+    art_id = tig_art_id_frame_set(art_id, 0);
+    art_id = tig_art_id_palette_set(art_id, 0);
+    if (type != TIG_ART_TYPE_WALL) {
+        art_id = tig_art_id_rotation_set(art_id, 0);
+    }
+
+    return art_id;
+}
+
+static unsigned int tig_art_cache_hash(tig_art_id_t key)
+{
+    // Art ids pack type, num and other properties into distinct bit ranges,
+    // mix them so that neighbouring ids are spread across buckets.
+    key ^= key >> 16;
+    key *= 0x7FEB352D;
+    key ^= key >> 15;
+    key *= 0x846CA68B;
+    key ^= key >> 16;
+    return key;
+}
+
+// 0x51B0E0
+bool tig_art_cache_find(tig_art_id_t key, int* index)
+{
+    unsigned int mask = (unsigned int)tig_art_cache_buckets_capacity - 1;
+    unsigned int bucket = tig_art_cache_hash(key) & mask;
+
+    while (tig_art_cache_buckets[bucket] != TIG_ART_CACHE_NONE) {
+        if (tig_art_cache_entries[tig_art_cache_buckets[bucket]].key == key) {
+            *index = tig_art_cache_buckets[bucket];
+            return true;
+        }
+
+        bucket = (bucket + 1) & mask;
+    }
+
+    return false;
+}
+
+static void tig_art_cache_buckets_insert(int cache_entry_index)
+{
+    unsigned int mask;
+    unsigned int bucket;
+    int index;
+
+    // Keep load factor at or below 50% so probe sequences stay short.
+    if (tig_art_cache_entries_count * 2 > tig_art_cache_buckets_capacity) {
+        tig_art_cache_buckets_reset(tig_art_cache_buckets_capacity * 2);
+
+        for (index = 0; index < tig_art_cache_entries_length; index++) {
+            if (index != cache_entry_index
+                && (tig_art_cache_entries[index].flags & TIG_ART_CACHE_ENTRY_LOADED) != 0) {
+                tig_art_cache_buckets_insert(index);
+            }
+        }
+    }
+
+    mask = (unsigned int)tig_art_cache_buckets_capacity - 1;
+    bucket = tig_art_cache_hash(tig_art_cache_entries[cache_entry_index].key) & mask;
+    while (tig_art_cache_buckets[bucket] != TIG_ART_CACHE_NONE) {
+        bucket = (bucket + 1) & mask;
+    }
+
+    tig_art_cache_buckets[bucket] = cache_entry_index;
+}
+
+static void tig_art_cache_buckets_remove(int cache_entry_index)
+{
+    unsigned int mask = (unsigned int)tig_art_cache_buckets_capacity - 1;
+    unsigned int bucket;
+    unsigned int next;
+    unsigned int home;
+
+    bucket = tig_art_cache_hash(tig_art_cache_entries[cache_entry_index].key) & mask;
+    while (tig_art_cache_buckets[bucket] != cache_entry_index) {
+        bucket = (bucket + 1) & mask;
+    }
+
+    // Shift subsequent entries of the probe sequence back so that lookups
+    // never need tombstones.
+    next = bucket;
+    for (;;) {
+        next = (next + 1) & mask;
+        if (tig_art_cache_buckets[next] == TIG_ART_CACHE_NONE) {
+            break;
+        }
+
+        home = tig_art_cache_hash(tig_art_cache_entries[tig_art_cache_buckets[next]].key) & mask;
+        if (((next - home) & mask) >= ((next - bucket) & mask)) {
+            tig_art_cache_buckets[bucket] = tig_art_cache_buckets[next];
+            bucket = next;
+        }
+    }
+
+    tig_art_cache_buckets[bucket] = TIG_ART_CACHE_NONE;
+}
+
+static void tig_art_cache_buckets_reset(int capacity)
+{
+    int index;
+
+    if (capacity != tig_art_cache_buckets_capacity) {
+        if (tig_art_cache_buckets != NULL) {
+            FREE(tig_art_cache_buckets);
+        }
+
+        tig_art_cache_buckets = (int*)MALLOC(sizeof(*tig_art_cache_buckets) * capacity);
+        tig_art_cache_buckets_capacity = capacity;
+    }
+
+    for (index = 0; index < capacity; index++) {
+        tig_art_cache_buckets[index] = TIG_ART_CACHE_NONE;
+    }
+}
+
+static int tig_art_cache_entry_alloc()
+{
+    int cache_entry_index;
+
+    if (tig_art_cache_entries_free_head != TIG_ART_CACHE_NONE) {
+        cache_entry_index = tig_art_cache_entries_free_head;
+        tig_art_cache_entries_free_head = tig_art_cache_entries[cache_entry_index].next;
+        return cache_entry_index;
+    }
+
+    if (tig_art_cache_entries_length == tig_art_cache_entries_capacity) {
+        tig_art_cache_entries_capacity += 32;
+        tig_art_cache_entries = (TigArtCacheEntry*)REALLOC(tig_art_cache_entries,
+            sizeof(TigArtCacheEntry) * tig_art_cache_entries_capacity);
+    }
+
+    cache_entry_index = tig_art_cache_entries_length++;
+    tig_art_cache_entries[cache_entry_index].flags = 0;
+
+    return cache_entry_index;
+}
+
+static void tig_art_cache_entry_free(int cache_entry_index)
+{
+    tig_art_cache_entries[cache_entry_index].flags = 0;
+    tig_art_cache_entries[cache_entry_index].next = tig_art_cache_entries_free_head;
+    tig_art_cache_entries_free_head = cache_entry_index;
+}
+
+static void tig_art_cache_lru_link(int cache_entry_index)
+{
+    TigArtCacheEntry* cache_entry = &(tig_art_cache_entries[cache_entry_index]);
+
+    cache_entry->prev = TIG_ART_CACHE_NONE;
+    cache_entry->next = tig_art_cache_lru_head;
+
+    if (tig_art_cache_lru_head != TIG_ART_CACHE_NONE) {
+        tig_art_cache_entries[tig_art_cache_lru_head].prev = cache_entry_index;
+    } else {
+        tig_art_cache_lru_tail = cache_entry_index;
+    }
+
+    tig_art_cache_lru_head = cache_entry_index;
+}
+
+static void tig_art_cache_lru_unlink(int cache_entry_index)
+{
+    TigArtCacheEntry* cache_entry = &(tig_art_cache_entries[cache_entry_index]);
+
+    if (cache_entry->prev != TIG_ART_CACHE_NONE) {
+        tig_art_cache_entries[cache_entry->prev].next = cache_entry->next;
+    } else {
+        tig_art_cache_lru_head = cache_entry->next;
+    }
+
+    if (cache_entry->next != TIG_ART_CACHE_NONE) {
+        tig_art_cache_entries[cache_entry->next].prev = cache_entry->prev;
+    } else {
+        tig_art_cache_lru_tail = cache_entry->prev;
+    }
+}
+
+// Checks if the art is known to be missing. The table is reset when file
+// repositories change, since missing art might become available.
+static bool tig_art_missing_find(tig_art_id_t key)
+{
+    unsigned int version;
+    TigArtMissingSlot* slot;
+    int index;
+
+    version = tig_file_repository_version();
+    if (tig_art_missing_version != version) {
+        for (index = 0; index < TIG_ART_MISSING_CAPACITY; index++) {
+            tig_art_missing_slots[index].occupied = false;
+        }
+        tig_art_missing_version = version;
+        return false;
+    }
+
+    slot = &(tig_art_missing_slots[tig_art_cache_hash(key) % TIG_ART_MISSING_CAPACITY]);
+    return slot->occupied && slot->key == key;
+}
+
+static void tig_art_missing_add(tig_art_id_t key)
+{
+    TigArtMissingSlot* slot;
+
+    // Validates the table against current repositories.
+    tig_art_missing_find(key);
+
+    slot = &(tig_art_missing_slots[tig_art_cache_hash(key) % TIG_ART_MISSING_CAPACITY]);
+    slot->key = key;
+    slot->occupied = true;
+}
+
+// Returns header of the specified art suitable for geometry queries. Art which
+// is not in the cache is not loaded, only read into the metadata index (see
+// `tig_art_meta_load`). Returns `NULL` if art cannot be loaded at all.
+static TigArtHeader* tig_art_meta_hdr(tig_art_id_t art_id)
+{
+    int index;
+
+    if (tig_art_cache_find(tig_art_cache_key(art_id), &index)) {
+        return &(tig_art_cache_entries[index].hdr);
+    }
+
+    index = tig_art_meta_load(art_id);
+    if (index == TIG_ART_CACHE_NONE) {
+        // Let the regular loading deal with broken art (which falls back to
+        // `badart.art`).
+        index = sub_51AA90(art_id);
+        if (index == -1) {
+            return NULL;
+        }
+
+        return &(tig_art_cache_entries[index].hdr);
+    }
+
+    return &(tig_art_meta_entries[index].hdr);
+}
+
+// Returns metadata entry of the specified art, reading its header, frames
+// table, frame bounds and opacity masks if needed (regardless of whether art
+// is in the cache). Returns `TIG_ART_CACHE_NONE` if art is missing or broken.
+static int tig_art_meta_load(tig_art_id_t art_id)
+{
+    char path[TIG_MAX_PATH];
+    tig_art_id_t key;
+    int index;
+    TigArtHeader hdr;
+    TigRect* bounds;
+    TigArtFrameMask* masks;
+    uint8_t* masks_bits;
+
+    key = tig_art_cache_key(art_id);
+
+    tig_art_meta_reserve();
+
+    if (tig_art_meta_find(key, &index)) {
+        tig_art_meta_lru_unlink(index);
+        tig_art_meta_lru_link(index);
+        return index;
+    }
+
+    if (tig_art_missing_find(key)
+        || tig_art_build_path(art_id, path) != TIG_OK
+        || !tig_art_meta_read(path, &hdr, &bounds, &masks, &masks_bits)) {
+        return TIG_ART_CACHE_NONE;
+    }
+
+    return tig_art_meta_insert(key, &hdr, bounds, masks, masks_bits);
+}
+
+// Allocates metadata index on first use.
+static void tig_art_meta_reserve()
+{
+    if (tig_art_meta_entries == NULL) {
+        tig_art_meta_entries = (TigArtMetaEntry*)MALLOC(sizeof(*tig_art_meta_entries) * TIG_ART_META_CAPACITY);
+        tig_art_meta_buckets = (int*)MALLOC(sizeof(*tig_art_meta_buckets) * TIG_ART_META_CAPACITY * 2);
+        tig_art_meta_entries_count = 0;
+        tig_art_meta_flush();
+    }
+}
+
+// Adds metadata entry taking ownership of the header frames table, frame
+// bounds and masks (laid out the same way) and mask bits, replaces the least
+// recently used entry when the index is full.
+static int tig_art_meta_insert(tig_art_id_t key, TigArtHeader* hdr, TigRect* bounds, TigArtFrameMask* masks, uint8_t* masks_bits)
+{
+    TigArtMetaEntry* meta;
+    int index;
+    int num_rotations;
+    int rotation;
+
+    if (tig_art_meta_entries_count < TIG_ART_META_CAPACITY) {
+        index = tig_art_meta_entries_count++;
+    } else {
+        index = tig_art_meta_lru_tail;
+        tig_art_meta_lru_unlink(index);
+        tig_art_meta_buckets_remove(index);
+        tig_art_meta_free(index);
+    }
+
+    meta = &(tig_art_meta_entries[index]);
+    meta->hdr = *hdr;
+    meta->key = key;
+    meta->bounds = bounds;
+    num_rotations = sub_51BE30(hdr);
+    for (rotation = 0; rotation < MAX_ROTATIONS; rotation++) {
+        meta->bounds_tbl[rotation] = bounds + hdr->num_frames * (rotation % num_rotations);
+        meta->masks_tbl[rotation] = masks + hdr->num_frames * (rotation % num_rotations);
+    }
+    meta->masks = masks;
+    meta->masks_bits = masks_bits;
+
+    tig_art_meta_buckets_insert(index);
+    tig_art_meta_lru_link(index);
+
+    return index;
+}
+
+// Frees frames table, bounds and masks of the metadata entry.
+static void tig_art_meta_free(int index)
+{
+    TigArtMetaEntry* meta = &(tig_art_meta_entries[index]);
+
+    FREE(meta->hdr.frames_tbl[0]);
+    FREE(meta->bounds);
+    FREE(meta->masks);
+    FREE(meta->masks_bits);
+}
+
+// Reads art header and frames table skipping palettes. Pixels are only
+// decoded to calculate bounds and opacity masks of every frame (`bounds_ptr`
+// and `masks_ptr` receive them laid out the same way as frames,
+// `masks_bits_ptr` receives bits of all masks), they are not kept.
+static bool tig_art_meta_read(const char* path, TigArtHeader* hdr, TigRect** bounds_ptr, TigArtFrameMask** masks_ptr, uint8_t** masks_bits_ptr)
+{
+    TigFile* stream;
+    TigArtFileFrameData* frames;
+    TigArtFileFrameData* frm;
+    TigRect* bounds;
+    TigArtFrameMask* masks;
+    uint8_t* masks_bits;
+    size_t masks_size;
+    uint8_t* encoded;
+    uint8_t* pixels;
+    int encoded_capacity;
+    int pixels_capacity;
+    int num_palettes;
+    int num_rotations;
+    int palette;
+    int rotation;
+    int index;
+    bool ok;
+
+    stream = tig_file_fopen(path, "rb");
+    if (stream == NULL) {
+        return false;
+    }
+
+    if (!art_read_header(hdr, stream)
+        || hdr->bpp != 8
+        || hdr->num_frames <= 0) {
+        tig_file_fclose(stream);
+        return false;
+    }
+
+    num_palettes = 0;
+    for (palette = 0; palette < MAX_PALETTES; palette++) {
+        if (hdr->palette_tbl[palette] != NULL) {
+            num_palettes++;
+        }
+        hdr->palette_tbl[palette] = NULL;
+    }
+
+    if (tig_file_fseek(stream, num_palettes * 256 * (int)sizeof(uint32_t), SEEK_CUR) != 0) {
+        tig_file_fclose(stream);
+        return false;
+    }
+
+    num_rotations = sub_51BE30(hdr);
+    frames = (TigArtFileFrameData*)MALLOC(sizeof(*frames) * hdr->num_frames * num_rotations);
+    if (tig_file_fread(frames, sizeof(*frames), hdr->num_frames * num_rotations, stream) != (size_t)(hdr->num_frames * num_rotations)) {
+        FREE(frames);
+        tig_file_fclose(stream);
+        return false;
+    }
+
+    // Frames data follows in the same order as frames table (see
+    // `sub_51B710`).
+    bounds = (TigRect*)MALLOC(sizeof(*bounds) * hdr->num_frames * num_rotations);
+    masks = (TigArtFrameMask*)MALLOC(sizeof(*masks) * hdr->num_frames * num_rotations);
+    masks_bits = NULL;
+    masks_size = 0;
+    encoded = NULL;
+    encoded_capacity = 0;
+    pixels = NULL;
+    pixels_capacity = 0;
+    ok = true;
+
+    for (index = 0; index < hdr->num_frames * num_rotations; index++) {
+        frm = &(frames[index]);
+        if (frm->width < 0 || frm->height < 0) {
+            ok = false;
+            break;
+        }
+
+        if (frm->data_size > encoded_capacity) {
+            encoded_capacity = frm->data_size;
+            encoded = (uint8_t*)REALLOC(encoded, encoded_capacity);
+        }
+
+        if (frm->width * frm->height > pixels_capacity) {
+            pixels_capacity = frm->width * frm->height;
+            pixels = (uint8_t*)REALLOC(pixels, pixels_capacity);
+        }
+
+        if (frm->data_size > 0
+            && tig_file_fread(encoded, 1, frm->data_size, stream) != (size_t)frm->data_size) {
+            ok = false;
+            break;
+        }
+
+        if (frm->data_size == frm->width * frm->height) {
+            // Pixels are not compressed.
+            memcpy(pixels, encoded, frm->data_size);
+        } else if (frm->data_size > 0) {
+            // Pixels are RLE-encoded.
+            if (!art_read_rle_decode(encoded, frm->data_size, pixels, frm->width * frm->height)) {
+                ok = false;
+                break;
+            }
+        } else {
+            memset(pixels, 0, frm->width * frm->height);
+        }
+
+        art_frame_bounds(pixels, frm->width, frm->height, &(bounds[index]));
+        art_frame_mask_build(pixels, frm->width, frm->height, &(masks[index]), &masks_bits, &masks_size);
+    }
+
+    if (encoded != NULL) {
+        FREE(encoded);
+    }
+
+    if (pixels != NULL) {
+        FREE(pixels);
+    }
+
+    tig_file_fclose(stream);
+
+    if (!ok) {
+        if (masks_bits != NULL) {
+            FREE(masks_bits);
+        }
+        FREE(masks);
+        FREE(bounds);
+        FREE(frames);
+        return false;
+    }
+
+    // Bits were appended to a growing buffer, so masks are pointed to them
+    // once it is complete.
+    if (masks_bits == NULL) {
+        masks_bits = (uint8_t*)MALLOC(1);
+    }
+
+    masks_size = 0;
+    for (index = 0; index < hdr->num_frames * num_rotations; index++) {
+        masks[index].bits = masks_bits + masks_size;
+        masks_size += (size_t)masks[index].stride * masks[index].bounds.height;
+    }
+
+    for (rotation = 0; rotation < MAX_ROTATIONS; rotation++) {
+        hdr->frames_tbl[rotation] = frames + hdr->num_frames * (rotation % num_rotations);
+        hdr->pixels_tbl[rotation] = NULL;
+    }
+
+    *bounds_ptr = bounds;
+    *masks_ptr = masks;
+    *masks_bits_ptr = masks_bits;
+
+    return true;
+}
+
+static bool tig_art_meta_find(tig_art_id_t key, int* index)
+{
+    unsigned int mask = TIG_ART_META_CAPACITY * 2 - 1;
+    unsigned int bucket = tig_art_cache_hash(key) & mask;
+
+    while (tig_art_meta_buckets[bucket] != TIG_ART_CACHE_NONE) {
+        if (tig_art_meta_entries[tig_art_meta_buckets[bucket]].key == key) {
+            *index = tig_art_meta_buckets[bucket];
+            return true;
+        }
+
+        bucket = (bucket + 1) & mask;
+    }
+
+    return false;
+}
+
+static void tig_art_meta_buckets_insert(int index)
+{
+    unsigned int mask = TIG_ART_META_CAPACITY * 2 - 1;
+    unsigned int bucket = tig_art_cache_hash(tig_art_meta_entries[index].key) & mask;
+
+    while (tig_art_meta_buckets[bucket] != TIG_ART_CACHE_NONE) {
+        bucket = (bucket + 1) & mask;
+    }
+
+    tig_art_meta_buckets[bucket] = index;
+}
+
+static void tig_art_meta_buckets_remove(int index)
+{
+    unsigned int mask = TIG_ART_META_CAPACITY * 2 - 1;
+    unsigned int bucket;
+    unsigned int next;
+    unsigned int home;
+
+    bucket = tig_art_cache_hash(tig_art_meta_entries[index].key) & mask;
+    while (tig_art_meta_buckets[bucket] != index) {
+        bucket = (bucket + 1) & mask;
+    }
+
+    // See `tig_art_cache_buckets_remove`.
+    next = bucket;
+    for (;;) {
+        next = (next + 1) & mask;
+        if (tig_art_meta_buckets[next] == TIG_ART_CACHE_NONE) {
+            break;
+        }
+
+        home = tig_art_cache_hash(tig_art_meta_entries[tig_art_meta_buckets[next]].key) & mask;
+        if (((next - home) & mask) >= ((next - bucket) & mask)) {
+            tig_art_meta_buckets[bucket] = tig_art_meta_buckets[next];
+            bucket = next;
+        }
+    }
+
+    tig_art_meta_buckets[bucket] = TIG_ART_CACHE_NONE;
+}
+
+static void tig_art_meta_lru_link(int index)
+{
+    TigArtMetaEntry* meta = &(tig_art_meta_entries[index]);
+
+    meta->prev = TIG_ART_CACHE_NONE;
+    meta->next = tig_art_meta_lru_head;
+
+    if (tig_art_meta_lru_head != TIG_ART_CACHE_NONE) {
+        tig_art_meta_entries[tig_art_meta_lru_head].prev = index;
+    } else {
+        tig_art_meta_lru_tail = index;
+    }
+
+    tig_art_meta_lru_head = index;
+}
+
+static void tig_art_meta_lru_unlink(int index)
+{
+    TigArtMetaEntry* meta = &(tig_art_meta_entries[index]);
+
+    if (meta->prev != TIG_ART_CACHE_NONE) {
+        tig_art_meta_entries[meta->prev].next = meta->next;
+    } else {
+        tig_art_meta_lru_head = meta->next;
+    }
+
+    if (meta->next != TIG_ART_CACHE_NONE) {
+        tig_art_meta_entries[meta->next].prev = meta->prev;
+    } else {
+        tig_art_meta_lru_tail = meta->prev;
+    }
+}
+
+// Frees all metadata entries.
+static void tig_art_meta_flush()
+{
+    int index;
+
+    if (tig_art_meta_entries == NULL) {
+        return;
+    }
+
+    for (index = 0; index < tig_art_meta_entries_count; index++) {
+        tig_art_meta_free(index);
+    }
+
+    for (index = 0; index < TIG_ART_META_CAPACITY * 2; index++) {
+        tig_art_meta_buckets[index] = TIG_ART_CACHE_NONE;
+    }
+
+    tig_art_meta_entries_count = 0;
+    tig_art_meta_lru_head = TIG_ART_CACHE_NONE;
+    tig_art_meta_lru_tail = TIG_ART_CACHE_NONE;
+}
+
+// 0x51B170
+bool tig_art_cache_entry_load(tig_art_id_t art_id, const char* path, int cache_entry_index)
+{
+    TigArtCacheEntry* art;
+    uint64_t start;
+    bool ok;
+
+    art = &(tig_art_cache_entries[cache_entry_index]);
+
+    start = SDL_GetTicksNS();
+    ok = tig_art_cache_entry_read(art_id, path, art, false);
+    tig_art_cache_counters.load_time += (SDL_GetTicksNS() - start) / 1000;
+
+    if (!ok) {
+        return false;
+    }
+
+    art->flags |= TIG_ART_CACHE_ENTRY_LOADED;
+    tig_art_cache_entries_count++;
+    tig_art_cache_entry_account(cache_entry_index, art->system_memory_usage, 0);
+
+    return true;
+}
+
+// Reads art file into the cache entry which is not yet linked into the
+// cache. When `defer_palettes` is set, `hdr.palette_tbl` receives raw palette
+// entries which should be converted with
+// `tig_art_cache_entry_create_palettes` (this makes it safe to call from
+// background threads).
+bool tig_art_cache_entry_read(tig_art_id_t art_id, const char* path, TigArtCacheEntry* art, bool defer_palettes)
+{
+    int rc;
+    art_size_t size;
+    int type;
+    int start;
+    int num_rotations;
+    int rotation;
+    int index;
+    int frame;
+    int offset;
+
+    memset(art, 0, sizeof(TigArtCacheEntry));
+    strcpy(art->path, path);
+    art->art_id = art_id;
+
+    rc = sub_51B710(art_id,
+        path,
+        &(art->hdr),
+        defer_palettes ? NULL : art->palette_tbl,
+        0,
+        &size);
+    if (rc != TIG_OK) {
+        return false;
+    }
+
+    art->system_memory_usage += size;
+
+    type = tig_art_type(art_id);
+    if ((art->hdr.flags & TIG_ART_0x01) != 0) {
+        start = 0;
+        num_rotations = 1;
+    } else if (tig_art_mirroring_enabled
+        && (type == TIG_ART_TYPE_CRITTER
+            || type == TIG_ART_TYPE_MONSTER
+            || type == TIG_ART_TYPE_UNIQUE_NPC)) {
+        start = 4;
+        num_rotations = 5;
+    } else {
+        start = 0;
+        num_rotations = MAX_ROTATIONS;
+    }
+
+    for (index = 0; index < num_rotations; index++) {
+        rotation = (index + start) % MAX_ROTATIONS;
+        art->pixels_tbl[rotation] = (uint8_t**)MALLOC(sizeof(uint8_t*) * art->hdr.num_frames);
+        art->system_memory_usage += sizeof(uint8_t*) * art->hdr.num_frames;
+
+        offset = 0;
+        for (frame = 0; frame < art->hdr.num_frames; ++frame) {
+            art->pixels_tbl[rotation][frame] = art->hdr.pixels_tbl[rotation] + offset;
+            offset += art->hdr.frames_tbl[rotation][frame].width * art->hdr.frames_tbl[rotation][frame].height;
+        }
+    }
+
+    // Bounds are calculated on plain pixels, before they are possibly
+    // compressed.
+    tig_art_cache_entry_build_bounds(art, start, num_rotations);
+
+    if ((tig_art_rle_types & (1u << type)) != 0) {
+        tig_art_cache_entry_compress(art, start, num_rotations);
+    }
+
+    if ((art->flags & TIG_ART_CACHE_ENTRY_RLE) == 0) {
+        tig_art_cache_entry_build_spans(art, start, num_rotations);
+    }
 
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    for (y = 0; y < dst_rect.height; y++) {
-                        current_alpha = start_alpha;
-                        alpha_horizontal_step = (end_alpha - start_alpha) / src_rect.width;
-
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (*src_pixels != 0) {
-                                *(uint32_t*)dst_pixels = tig_color_blend_alpha(((uint32_t*)plt)[*src_pixels],
-                                    *(uint32_t*)dst_pixels,
-                                    (int)current_alpha);
-                            }
-                            src_pixels += src_step;
-                            dst_pixels += 4;
-
-                            current_alpha += alpha_horizontal_step;
-                        }
-                        src_pixels += src_pitch;
-                        dst_pixels += dst_skip;
+    if (MAX_ROTATIONS - num_rotations > 0) {
+        rotation = num_rotations + start;
+        for (index = MAX_ROTATIONS - num_rotations; index > 0; --index) {
+            art->pixels_tbl[rotation % MAX_ROTATIONS] = art->pixels_tbl[0];
+            art->spans_tbl[rotation % MAX_ROTATIONS] = art->spans_tbl[0];
+            art->bounds_tbl[rotation % MAX_ROTATIONS] = art->bounds_tbl[0];
+            rotation++;
+        }
+    }
 
-                        start_alpha += start_alpha_vertical_step;
-                        end_alpha += end_alpha_vertical_step;
-                    }
-                    break;
-                }
-            } else if ((blit_info->flags & TIG_ART_BLT_BLEND_ALPHA_STIPPLE_S) != 0) {
-                // 0x50779F
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    for (y = 0; y < dst_rect.height; y++) {
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (((src_checkerboard_cur_x ^ src_checkerboard_cur_y) & 1) != 0) {
-                                if (*src_pixels != 0) {
-                                    *(uint32_t*)dst_pixels = ((uint32_t*)plt)[*src_pixels];
-                                }
-                            }
-                            src_pixels += src_step;
-                            dst_pixels += 4;
-
-                            src_checkerboard_cur_x++;
-                        }
-                        src_pixels += src_pitch;
-                        dst_pixels += dst_skip;
+    return true;
+}
 
-                        src_checkerboard_cur_x = src_rect.x;
-                        src_checkerboard_cur_y++;
-                    }
-                    break;
-                }
-            } else if ((blit_info->flags & TIG_ART_BLT_BLEND_ALPHA_STIPPLE_D) != 0) {
-                // 0x507955
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    for (y = 0; y < dst_rect.height; y++) {
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (((dst_checkerboard_cur_x ^ dst_checkerboard_cur_y) & 1) != 0) {
-                                if (*src_pixels != 0) {
-                                    *(uint32_t*)dst_pixels = ((uint32_t*)plt)[*src_pixels];
-                                }
-                            }
-                            src_pixels += src_step;
-                            dst_pixels += 4;
-
-                            dst_checkerboard_cur_x++;
-                        }
-                        src_pixels += src_pitch;
-                        dst_pixels += dst_skip;
+// Creates palettes from raw palette entries read by
+// `tig_art_cache_entry_read` with deferred palettes.
+void tig_art_cache_entry_create_palettes(tig_art_id_t art_id, TigArtCacheEntry* art)
+{
+    int palette;
+    uint32_t* entries;
 
-                        dst_checkerboard_cur_x = dst_rect.x;
-                        dst_checkerboard_cur_y++;
-                    }
-                    break;
-                }
-            } else {
-                // 0x506FC8
-                switch (tig_art_bits_per_pixel) {
-                case 32:
-                    for (y = 0; y < dst_rect.height; y++) {
-                        for (x = 0; x < dst_rect.width; x++) {
-                            if (*src_pixels != 0) {
-                                *(uint32_t*)dst_pixels = ((uint32_t*)plt)[*src_pixels];
-                            }
-                            src_pixels += src_step;
-                            dst_pixels += 4;
-                        }
-                        src_pixels += src_pitch;
-                        dst_pixels += dst_skip;
-                    }
-                    break;
-                }
-            }
+    for (palette = 0; palette < MAX_PALETTES; palette++) {
+        entries = art->hdr.palette_tbl[palette];
+        if (entries == NULL) {
+            continue;
         }
-    }
 
-    tig_video_buffer_unlock(blit_info->dst_video_buffer);
+        art->hdr.palette_tbl[palette] = tig_palette_acquire_rgb(entries);
+        art->palette_tbl[palette] = art_palette_adjust(art_id, art->hdr.palette_tbl[palette]);
+        art->system_memory_usage += (art_size_t)tig_palette_system_memory_size() * 2;
 
-    return TIG_OK;
+        FREE(entries);
+    }
 }
 
-// 0x51AA90
-int sub_51AA90(tig_art_id_t art_id)
+// Converts frames of loaded rotations into run-length representation. Does
+// nothing if it does not save memory.
+void tig_art_cache_entry_compress(TigArtCacheEntry* art, int start, int num_rotations)
 {
-    char path[TIG_MAX_PATH];
-    int cache_entry_index;
+    art_size_t raw_size = 0;
+    art_size_t rle_size = 0;
+    art_size_t size;
+    int index;
+    int rotation;
+    int frame;
+    int other;
+    uint8_t* pixels;
+    uint8_t* rle;
+    TigArtFileFrameData* frm;
 
-    if (tig_art_build_path(art_id, path) != TIG_OK) {
-        return -1;
+    for (index = 0; index < num_rotations; index++) {
+        rotation = (index + start) % MAX_ROTATIONS;
+        for (frame = 0; frame < art->hdr.num_frames; frame++) {
+            frm = &(art->hdr.frames_tbl[rotation][frame]);
+            raw_size += frm->width * frm->height;
+            rle_size += art_runs_encode(art->pixels_tbl[rotation][frame], frm->width, frm->height, true, NULL);
+        }
     }
 
-    if (dword_604714 < tig_art_cache_entries_length
-        && strcmp(path, tig_art_cache_entries[dword_604714].path) == 0) {
-        tig_art_cache_entries[dword_604714].time = tig_ping_timestamp;
-        return dword_604714;
+    if (rle_size >= raw_size) {
+        return;
     }
 
-    // Called twice to check both system and video memory.
-    tig_art_cache_check_fullness();
-    tig_art_cache_check_fullness();
+    for (index = 0; index < num_rotations; index++) {
+        rotation = (index + start) % MAX_ROTATIONS;
 
-    if (!tig_art_cache_find(path, &cache_entry_index)) {
-        if (!tig_art_cache_entry_load(art_id, path, cache_entry_index)) {
-            tig_debug_printf("ART LOAD FAILURE!!! Trying to load %s\n", path);
+        size = 0;
+        for (frame = 0; frame < art->hdr.num_frames; frame++) {
+            frm = &(art->hdr.frames_tbl[rotation][frame]);
+            size += art_runs_encode(art->pixels_tbl[rotation][frame], frm->width, frm->height, true, NULL);
+        }
 
-            if (!tig_art_cache_entry_load(art_id, "art\\badart.art", cache_entry_index)) {
-                tig_debug_printf("ART LOAD FAILURE!!! Trying to load badart.art\n");
-                return -1;
+        rle = (uint8_t*)MALLOC(size);
+
+        size = 0;
+        for (frame = 0; frame < art->hdr.num_frames; frame++) {
+            frm = &(art->hdr.frames_tbl[rotation][frame]);
+            pixels = art->pixels_tbl[rotation][frame];
+            art->pixels_tbl[rotation][frame] = rle + size;
+            size += art_runs_encode(pixels, frm->width, frm->height, true, rle + size);
+        }
+
+        // Replace pixels in the header, including aliases of this rotation
+        // set up by `sub_51B710`.
+        pixels = art->hdr.pixels_tbl[rotation];
+        for (other = 0; other < MAX_ROTATIONS; other++) {
+            if (art->hdr.pixels_tbl[other] == pixels) {
+                art->hdr.pixels_tbl[other] = rle;
             }
         }
+        FREE(pixels);
     }
 
-    tig_art_cache_entries[cache_entry_index].time = tig_ping_timestamp;
-    tig_art_cache_entries[cache_entry_index].art_id = art_id;
-    dword_604714 = cache_entry_index;
-
-    return cache_entry_index;
-}
-
-// 0x51AC00
-void tig_art_cache_set_video_memory_fullness(int fullness)
-{
-    tig_art_cache_video_memory_fullness = (float)fullness / 100.0f;
+    art->system_memory_usage += rle_size - raw_size;
+    art->flags |= TIG_ART_CACHE_ENTRY_RLE;
 }
 
-// 0x51AC20
-void tig_art_cache_check_fullness()
+// Builds opaque spans tables of loaded rotations.
+void tig_art_cache_entry_build_spans(TigArtCacheEntry* art, int start, int num_rotations)
 {
-    // Flag that denotes if we should check video memory (true) or system memory
-    // (false). This flag alternates on every call.
-    //
-    // 0x604728
-    static bool vid_vs_sys;
-
-    art_size_t acc = 0;
-    art_size_t tgt;
+    art_size_t size;
     int index;
-    int cnt;
-
-    if (vid_vs_sys) {
-        // NOTE: Signed compare.
-        if (tig_art_available_video_memory > 0) {
-            vid_vs_sys = !vid_vs_sys;
-            return;
-        }
+    int rotation;
+    int frame;
+    uint8_t* spans;
+    TigArtFileFrameData* frm;
 
-        tig_debug_printf("Art cache full (vid), making some room");
+    for (index = 0; index < num_rotations; index++) {
+        rotation = (index + start) % MAX_ROTATIONS;
 
-        // Calculate target size we'd like to evict.
-        tgt = (art_size_t)((double)tig_art_total_video_memory * tig_art_cache_video_memory_fullness);
+        size = 0;
+        for (frame = 0; frame < art->hdr.num_frames; frame++) {
+            frm = &(art->hdr.frames_tbl[rotation][frame]);
+            size += art_runs_encode(art->pixels_tbl[rotation][frame], frm->width, frm->height, false, NULL);
+        }
 
-        // Sort cache entries by last access time, earliest first.
-        qsort(tig_art_cache_entries,
-            tig_art_cache_entries_length,
-            sizeof(TigArtCacheEntry),
-            tig_art_cache_entry_compare_time);
+        art->spans_tbl[rotation] = (uint8_t**)MALLOC(sizeof(uint8_t*) * art->hdr.num_frames);
+        spans = (uint8_t*)MALLOC(size);
+        art->system_memory_usage += sizeof(uint8_t*) * art->hdr.num_frames + size;
 
-        // Loop thru cache entries until we reach eviction target.
-        for (index = 0; index < tig_art_cache_entries_length; ++index) {
-            acc += tig_art_cache_entries[index].video_memory_usage;
-            if (acc >= tgt) {
-                break;
-            }
-        }
-    } else {
-        // NOTE: Signed compare.
-        if (tig_art_available_system_memory > 0) {
-            vid_vs_sys = !vid_vs_sys;
-            return;
+        size = 0;
+        for (frame = 0; frame < art->hdr.num_frames; frame++) {
+            frm = &(art->hdr.frames_tbl[rotation][frame]);
+            art->spans_tbl[rotation][frame] = spans + size;
+            size += art_runs_encode(art->pixels_tbl[rotation][frame], frm->width, frm->height, false, spans + size);
         }
+    }
+}
 
-        tig_debug_printf("Art cache full (sys), making some room");
+// Builds bounds tables of loaded rotations.
+void tig_art_cache_entry_build_bounds(TigArtCacheEntry* art, int start, int num_rotations)
+{
+    int index;
+    int rotation;
+    int frame;
+    TigArtFileFrameData* frm;
 
-        // Calculate target size we'd like to evict (30% of total system
-        // memory).
-        tgt = (art_size_t)((double)tig_art_total_system_memory * 0.3f);
+    for (index = 0; index < num_rotations; index++) {
+        rotation = (index + start) % MAX_ROTATIONS;
 
-        // Sort cache entries by last access time, earliest first.
-        qsort(tig_art_cache_entries,
-            tig_art_cache_entries_length,
-            sizeof(TigArtCacheEntry),
-            tig_art_cache_entry_compare_time);
+        art->bounds_tbl[rotation] = (TigRect*)MALLOC(sizeof(TigRect) * art->hdr.num_frames);
+        art->system_memory_usage += sizeof(TigRect) * art->hdr.num_frames;
 
-        // Loop thru cache entries until we reach eviction target.
-        for (index = 0; index < tig_art_cache_entries_length; ++index) {
-            acc += tig_art_cache_entries[index].system_memory_usage;
-            if (acc >= tgt) {
-                break;
+        for (frame = 0; frame < art->hdr.num_frames; frame++) {
+            frm = &(art->hdr.frames_tbl[rotation][frame]);
+            art_frame_bounds(art->pixels_tbl[rotation][frame],
+                frm->width,
+                frm->height,
+                &(art->bounds_tbl[rotation][frame]));
+        }
+    }
+}
+
+// Builds opacity mask of 8-bpp frame, its bits are appended to `*bits_ptr`
+// (which holds `*size_ptr` bytes and is grown as needed). `bits` of the mask
+// is not set, since the buffer can move.
+void art_frame_mask_build(const uint8_t* pixels, int width, int height, TigArtFrameMask* mask, uint8_t** bits_ptr, size_t* size_ptr)
+{
+    uint8_t* bits;
+    size_t size;
+    int x;
+    int y;
+    int min_x;
+    int min_y;
+    int max_x;
+    int max_y;
+
+    // Find bounds of opaque pixels.
+    min_x = width;
+    min_y = height;
+    max_x = -1;
+    max_y = -1;
+    for (y = 0; y < height; y++) {
+        for (x = 0; x < width; x++) {
+            if (pixels[y * width + x] >= 2) {
+                if (x < min_x) min_x = x;
+                if (x > max_x) max_x = x;
+                if (y < min_y) min_y = y;
+                max_y = y;
             }
         }
     }
 
-    // NOTE: Signed compare.
-    if (acc < tgt) {
-        // We haven't reached eviction target, flush everything.
-        tig_art_flush();
-        tig_debug_printf("...\n");
+    if (max_x >= 0) {
+        mask->bounds.x = min_x;
+        mask->bounds.y = min_y;
+        mask->bounds.width = max_x - min_x + 1;
+        mask->bounds.height = max_y - min_y + 1;
+    } else {
+        mask->bounds.x = 0;
+        mask->bounds.y = 0;
+        mask->bounds.width = 0;
+        mask->bounds.height = 0;
+    }
+    mask->stride = (mask->bounds.width + 7) / 8;
+    mask->bits = NULL;
+
+    size = (size_t)mask->stride * mask->bounds.height;
+    if (size == 0) {
         return;
     }
 
-    cnt = index + 1;
+    // Fill in bits.
+    *bits_ptr = (uint8_t*)REALLOC(*bits_ptr, *size_ptr + size);
+    bits = *bits_ptr + *size_ptr;
+    *size_ptr += size;
+    memset(bits, 0, size);
 
-    // Free cache entries.
-    for (; index >= 0; index--) {
-        tig_art_cache_entry_unload(index);
+    for (y = 0; y < mask->bounds.height; y++) {
+        for (x = 0; x < mask->bounds.width; x++) {
+            if (pixels[(mask->bounds.y + y) * width + mask->bounds.x + x] >= 2) {
+                bits[y * mask->stride + x / 8] |= 1 << (x % 8);
+            }
+        }
     }
+}
 
-    tig_art_cache_entries_length -= cnt;
+// Calculates bounding box of non-transparent pixels of 8-bpp frame. The box is
+// empty if the frame is fully transparent.
+void art_frame_bounds(const uint8_t* pixels, int width, int height, TigRect* bounds)
+{
+    const uint8_t* row;
+    int min_x;
+    int min_y;
+    int max_x;
+    int max_y;
+    int x;
+    int y;
 
-    // Move remaining cache entries on top.
-    memmove(tig_art_cache_entries,
-        &(tig_art_cache_entries[cnt]),
-        sizeof(TigArtCacheEntry) * (tig_art_cache_entries_length));
+    min_x = width;
+    min_y = height;
+    max_x = -1;
+    max_y = -1;
 
-    // Sort back cache entries by name (as `tig_art_cache_find` uses binary
-    // search by name).
-    qsort(tig_art_cache_entries,
-        tig_art_cache_entries_length,
-        sizeof(TigArtCacheEntry),
-        tig_art_cache_entry_compare_name);
+    for (y = 0; y < height; y++) {
+        row = pixels + width * y;
 
-    tig_debug_printf("...\n");
-    vid_vs_sys = !vid_vs_sys;
-}
+        for (x = 0; x < width && row[x] == 0; x++) {
+        }
 
-// 0x51ADE0
-int tig_art_cache_entry_compare_time(const void* a1, const void* a2)
-{
-    TigArtCacheEntry* a = (TigArtCacheEntry*)a1;
-    TigArtCacheEntry* b = (TigArtCacheEntry*)a2;
-    return a->time - b->time;
-}
+        if (x == width) {
+            continue;
+        }
 
-// 0x51AE00
-int tig_art_cache_entry_compare_name(const void* a1, const void* a2)
-{
-    TigArtCacheEntry* a = (TigArtCacheEntry*)a1;
-    TigArtCacheEntry* b = (TigArtCacheEntry*)a2;
-    return strcmp(a->path, b->path);
-}
+        if (x < min_x) {
+            min_x = x;
+        }
 
-// 0x51AE50
-int tig_art_build_path(unsigned int art_id, char* path)
-{
-    if (tig_art_type(art_id) == TIG_ART_TYPE_MISC) {
-        switch (tig_art_num_get(art_id)) {
-        case TIG_ART_SYSTEM_MOUSE:
-            strcpy(path, "art\\mouse.art");
-            return TIG_OK;
-        case TIG_ART_SYSTEM_BUTTON:
-            strcpy(path, "art\\button.art");
-            return TIG_OK;
-        case TIG_ART_SYSTEM_UP:
-            strcpy(path, "art\\up.art");
-            return TIG_OK;
-        case TIG_ART_SYSTEM_DOWN:
-            strcpy(path, "art\\down.art");
-            return TIG_OK;
-        case TIG_ART_SYSTEM_CANCEL:
-            strcpy(path, "art\\cancel.art");
-            return TIG_OK;
-        case TIG_ART_SYSTEM_LENS:
-            strcpy(path, "art\\lens.art");
-            return TIG_OK;
-        case TIG_ART_SYSTEM_X:
-            strcpy(path, "art\\x.art");
-            return TIG_OK;
-        case TIG_ART_SYSTEM_PLUS:
-            strcpy(path, "art\\plus.art");
-            return TIG_OK;
-        case TIG_ART_SYSTEM_MINUS:
-            strcpy(path, "art\\minus.art");
-            return TIG_OK;
-        case TIG_ART_SYSTEM_BLANK:
-            strcpy(path, "art\\blank.art");
-            return TIG_OK;
-        case TIG_ART_SYSTEM_FONT:
-            strcpy(path, "art\\morph15font.art");
-            return TIG_OK;
+        for (x = width - 1; row[x] == 0; x--) {
         }
-    } else {
-        if (tig_art_file_path_resolver != NULL) {
-            return tig_art_file_path_resolver(art_id, path);
+
+        if (x > max_x) {
+            max_x = x;
+        }
+
+        if (min_y > y) {
+            min_y = y;
         }
+        max_y = y;
     }
 
-    return TIG_ERR_GENERIC;
+    if (max_y < 0) {
+        bounds->x = 0;
+        bounds->y = 0;
+        bounds->width = 0;
+        bounds->height = 0;
+        return;
+    }
+
+    bounds->x = min_x;
+    bounds->y = min_y;
+    bounds->width = max_x - min_x + 1;
+    bounds->height = max_y - min_y + 1;
 }
 
-// 0x51B0A0
-tig_art_id_t tig_art_id_reset(tig_art_id_t art_id)
+// Encodes runs of transparent and opaque pixels of 8-bpp frame. The encoded
+// frame starts with table of `height` row offsets (`uint32_t`, relative to
+// the start of the frame), followed by rows. Every row is a sequence of runs
+// which covers entire row width, each run is:
+//
+//   uint16_t skip - number of transparent pixels
+//   uint16_t cnt - number of opaque pixels
+//   uint8_t pixels[cnt] - only when `inline_pixels` is set
+//
+// With inline pixels this is run-length representation of the frame,
+// without them it is a table of opaque spans to use alongside the frame.
+//
+// Values are little-endian and not aligned. Returns number of bytes the
+// encoded frame takes (only the size is calculated when `dst` is `NULL`).
+int art_runs_encode(const uint8_t* src, int width, int height, bool inline_pixels, uint8_t* dst)
 {
-    if (tig_art_type(art_id) == TIG_ART_TYPE_MISC) {
-        art_id = tig_art_id_palette_set(art_id, 0);
-        art_id = tig_art_id_frame_set(art_id, 0);
-        return art_id;
-    }
+    int size;
+    int y;
+    int x;
+    int skip;
+    int cnt;
+    uint32_t offset;
 
-    if (tig_art_id_reset_func != NULL) {
-        return tig_art_id_reset_func(art_id);
+    size = (int)sizeof(offset) * height;
+
+    for (y = 0; y < height; y++) {
+        if (dst != NULL) {
+            offset = (uint32_t)size;
+            memcpy(dst + sizeof(offset) * y, &offset, sizeof(offset));
+        }
+
+        x = 0;
+        while (x < width) {
+            skip = 0;
+            while (x + skip < width && src[x + skip] == 0 && skip < 0xFFFF) {
+                skip++;
+            }
+
+            cnt = 0;
+            while (x + skip + cnt < width && src[x + skip + cnt] != 0 && cnt < 0xFFFF) {
+                cnt++;
+            }
+
+            if (dst != NULL) {
+                dst[size] = (uint8_t)(skip & 0xFF);
+                dst[size + 1] = (uint8_t)(skip >> 8);
+                dst[size + 2] = (uint8_t)(cnt & 0xFF);
+                dst[size + 3] = (uint8_t)(cnt >> 8);
+                if (inline_pixels) {
+                    memcpy(dst + size + 4, src + x + skip, cnt);
+                }
+            }
+
+            size += 4;
+            if (inline_pixels) {
+                size += cnt;
+            }
+            x += skip + cnt;
+        }
+
+        src += width;
     }
 
-    return art_id;
+    return size;
 }
 
-// 0x51B0E0
-bool tig_art_cache_find(const char* path, int* index)
+// Expands frame from run-length representation into 8-bpp pixels.
+void art_rle_decode(const uint8_t* rle, int width, int height, uint8_t* dst)
 {
-    int l = 0;
-    int r = tig_art_cache_entries_length - 1;
+    const uint8_t* run;
+    uint32_t offset;
+    int y;
+    int x;
+    int skip;
+    int cnt;
 
-    while (l <= r) {
-        int mid = (l + r) / 2;
-        int cmp = strcmp(tig_art_cache_entries[mid].path, path);
-        if (cmp == 0) {
-            *index = mid;
-            return true;
-        }
+    memset(dst, 0, width * height);
 
-        if (cmp > 0) {
-            r = mid - 1;
-        } else {
-            l = mid + 1;
+    for (y = 0; y < height; y++) {
+        memcpy(&offset, rle + sizeof(offset) * y, sizeof(offset));
+        run = rle + offset;
+
+        x = 0;
+        while (x < width) {
+            skip = run[0] | (run[1] << 8);
+            cnt = run[2] | (run[3] << 8);
+            run += 4;
+            x += skip;
+
+            memcpy(dst + x, run, cnt);
+            run += cnt;
+            x += cnt;
         }
-    }
 
-    *index = l;
-    return false;
+        dst += width;
+    }
 }
 
-// 0x51B170
-bool tig_art_cache_entry_load(tig_art_id_t art_id, const char* path, int cache_entry_index)
+// Returns 8-bpp pixels of the specified frame. Frames in run-length
+// representation are expanded into `scratch` buffer which is only valid
+// until the next call.
+uint8_t* art_frame_pixels(TigArtCacheEntry* art, int rotation, int frame, TigArtScratch* scratch)
 {
-    TigArtCacheEntry* art;
-    int rc;
-    art_size_t size;
-    int type;
-    int start;
-    int num_rotations;
-    int rotation;
-    int index;
-    int frame;
-    int offset;
+    TigArtFileFrameData* frm;
+    int size;
+
+    if ((art->flags & TIG_ART_CACHE_ENTRY_RLE) == 0) {
+        return art->pixels_tbl[rotation][frame];
+    }
 
-    if (tig_art_cache_entries_length == tig_art_cache_entries_capacity - 1) {
-        tig_art_cache_entries_capacity += 32;
-        tig_art_cache_entries = (TigArtCacheEntry*)REALLOC(tig_art_cache_entries,
-            sizeof(TigArtCacheEntry) * tig_art_cache_entries_capacity);
+    frm = &(art->hdr.frames_tbl[rotation][frame]);
+    size = frm->width * frm->height;
+    if (size > scratch->rle_size) {
+        scratch->rle = (uint8_t*)REALLOC(scratch->rle, size);
+        scratch->rle_size = size;
     }
 
-    memmove(&(tig_art_cache_entries[cache_entry_index + 1]),
-        &(tig_art_cache_entries[cache_entry_index]),
-        sizeof(TigArtCacheEntry) * (tig_art_cache_entries_length - cache_entry_index));
+    art_rle_decode(art->pixels_tbl[rotation][frame], frm->width, frm->height, scratch->rle);
 
-    art = &(tig_art_cache_entries[cache_entry_index]);
+    return scratch->rle;
+}
 
-    memset(art, 0, sizeof(TigArtCacheEntry));
-    strcpy(art->path, path);
+// Returns palette index of the specified frame pixel.
+uint8_t art_frame_pixel(TigArtCacheEntry* art, int rotation, int frame, int x, int y)
+{
+    TigArtFileFrameData* frm;
+    const uint8_t* run;
+    uint32_t offset;
+    int pos;
+    int skip;
+    int cnt;
 
-    rc = sub_51B710(art_id,
-        path,
-        &(art->hdr),
-        art->palette_tbl,
-        0,
-        &size);
-    if (rc != TIG_OK) {
-        memmove(&(tig_art_cache_entries[cache_entry_index]),
-            &(tig_art_cache_entries[cache_entry_index + 1]),
-            sizeof(TigArtCacheEntry) * (tig_art_cache_entries_length - cache_entry_index));
-        return false;
-    }
+    frm = &(art->hdr.frames_tbl[rotation][frame]);
 
-    art->system_memory_usage += size;
+    if ((art->flags & TIG_ART_CACHE_ENTRY_RLE) == 0) {
+        return art->pixels_tbl[rotation][frame][y * frm->width + x];
+    }
 
-    type = tig_art_type(art_id);
-    if ((art->hdr.flags & TIG_ART_0x01) != 0) {
-        start = 0;
-        num_rotations = 1;
-    } else if (tig_art_mirroring_enabled
-        && (type == TIG_ART_TYPE_CRITTER
-            || type == TIG_ART_TYPE_MONSTER
-            || type == TIG_ART_TYPE_UNIQUE_NPC)) {
-        start = 4;
-        num_rotations = 5;
-    } else {
-        start = 0;
-        num_rotations = MAX_ROTATIONS;
+    if (x < 0 || x >= frm->width || y < 0 || y >= frm->height) {
+        return 0;
     }
 
-    for (index = 0; index < num_rotations; index++) {
-        rotation = (index + start) % MAX_ROTATIONS;
-        art->pixels_tbl[rotation] = (uint8_t**)MALLOC(sizeof(uint8_t*) * art->hdr.num_frames);
-        art->system_memory_usage += sizeof(uint8_t*) * art->hdr.num_frames;
+    memcpy(&offset, art->pixels_tbl[rotation][frame] + sizeof(offset) * y, sizeof(offset));
+    run = art->pixels_tbl[rotation][frame] + offset;
 
-        offset = 0;
-        for (frame = 0; frame < art->hdr.num_frames; ++frame) {
-            art->pixels_tbl[rotation][frame] = art->hdr.pixels_tbl[rotation] + offset;
-            offset += art->hdr.frames_tbl[rotation][frame].width * art->hdr.frames_tbl[rotation][frame].height;
+    pos = 0;
+    while (pos < frm->width) {
+        skip = run[0] | (run[1] << 8);
+        cnt = run[2] | (run[3] << 8);
+        run += 4;
+        pos += skip;
+
+        if (x < pos) {
+            break;
         }
-    }
 
-    if (MAX_ROTATIONS - num_rotations > 0) {
-        rotation = num_rotations + start;
-        for (index = MAX_ROTATIONS - num_rotations; index > 0; --index) {
-            art->pixels_tbl[rotation % MAX_ROTATIONS] = art->pixels_tbl[0];
-            rotation++;
+        if (x < pos + cnt) {
+            return run[x - pos];
         }
-    }
 
-    tig_art_cache_entries_length++;
-    tig_art_available_system_memory -= art->system_memory_usage;
+        run += cnt;
+        pos += cnt;
+    }
 
-    return true;
+    return 0;
 }
 
 // 0x51B490
 void tig_art_cache_entry_unload(int cache_entry_index)
 {
     TigArtCacheEntry* cache_entry;
-    int type;
-    int rotation_start;
-    int num_rotations;
-    int rotation;
     int palette;
-    int idx;
 
     cache_entry = &(tig_art_cache_entries[cache_entry_index]);
 
-    tig_art_available_system_memory += cache_entry->system_memory_usage;
-    tig_art_available_video_memory += cache_entry->video_memory_usage;
+    cache_entry->flags &= ~TIG_ART_CACHE_ENTRY_LOADED;
+    tig_art_cache_entries_count--;
+
+    tig_art_cache_entry_account(cache_entry_index, -cache_entry->system_memory_usage, -cache_entry->video_memory_usage);
 
     sub_51B650(cache_entry_index);
 
+    tig_art_cache_entry_free_frames(cache_entry);
+
+    for (palette = 0; palette < MAX_PALETTES; ++palette) {
+        if (cache_entry->hdr.palette_tbl[palette] != NULL) {
+            tig_palette_release(cache_entry->hdr.palette_tbl[palette]);
+        }
+
+        if (cache_entry->palette_tbl[palette] != NULL) {
+            tig_palette_release(cache_entry->palette_tbl[palette]);
+        }
+    }
+}
+
+// Frees frames and pixels of the cache entry.
+void tig_art_cache_entry_free_frames(TigArtCacheEntry* cache_entry)
+{
+    int type;
+    int rotation_start;
+    int num_rotations;
+    int rotation;
+    int idx;
+
     type = tig_art_type(cache_entry->art_id);
 
     if ((cache_entry->hdr.flags & TIG_ART_0x01) != 0) {
@@ -5731,20 +7356,19 @@ void tig_art_cache_entry_unload(int cache_entry_index)
 
     for (idx = 0; idx < num_rotations; ++idx) {
         rotation = (idx + rotation_start) % MAX_ROTATIONS;
+        if (cache_entry->spans_tbl[rotation] != NULL) {
+            if (cache_entry->hdr.num_frames > 0) {
+                FREE(cache_entry->spans_tbl[rotation][0]);
+            }
+            FREE(cache_entry->spans_tbl[rotation]);
+            cache_entry->spans_tbl[rotation] = NULL;
+        }
+        FREE(cache_entry->bounds_tbl[rotation]);
+        cache_entry->bounds_tbl[rotation] = NULL;
         FREE(cache_entry->pixels_tbl[rotation]);
         FREE(cache_entry->hdr.pixels_tbl[rotation]);
         FREE(cache_entry->hdr.frames_tbl[rotation]);
     }
-
-    for (palette = 0; palette < MAX_PALETTES; ++palette) {
-        if (cache_entry->hdr.palette_tbl[palette] != NULL) {
-            tig_palette_destroy(cache_entry->hdr.palette_tbl[palette]);
-        }
-
-        if (cache_entry->palette_tbl[palette] != NULL) {
-            tig_palette_destroy(cache_entry->palette_tbl[palette]);
-        }
-    }
 }
 
 // 0x51B610
@@ -5759,7 +7383,46 @@ void art_invalidate(int cache_entry_index)
         for (rotation = 0; rotation < MAX_ROTATIONS; rotation++) {
             tig_art_cache_entries[cache_entry_index].dirty[palette][rotation] = 1;
         }
+
+        tig_art_cache_entries[cache_entry_index].color_keyed[palette] = TIG_ART_PALETTE_UNCHECKED;
+    }
+}
+
+// Checks if opaque pixels of the art in `palette` can have the color key of
+// frame video buffers (which is what their transparent pixels are filled
+// with). Such pixels would be dropped by video buffer blits, so the art is
+// blitted directly instead. The result is kept until the palette changes
+// (see `art_invalidate`).
+bool art_palette_color_keyed(int cache_entry_index, int palette)
+{
+    TigArtCacheEntry* art;
+    tig_color_t color_key;
+    tig_color_t color;
+    int index;
+
+    art = &(tig_art_cache_entries[cache_entry_index]);
+
+    if (art->color_keyed[palette] == TIG_ART_PALETTE_UNCHECKED) {
+        color_key = tig_color_make(0, 255, 0);
+
+        art->color_keyed[palette] = TIG_ART_PALETTE_UNKEYED;
+
+        // Index 0 is transparent.
+        for (index = 1; index < 256; index++) {
+            if (tig_art_bits_per_pixel == 16) {
+                color = ((uint16_t*)art->palette_tbl[palette])[index];
+            } else {
+                color = ((uint32_t*)art->palette_tbl[palette])[index];
+            }
+
+            if (color == color_key) {
+                art->color_keyed[palette] = TIG_ART_PALETTE_KEYED;
+                break;
+            }
+        }
     }
+
+    return art->color_keyed[palette] == TIG_ART_PALETTE_KEYED;
 }
 
 // 0x51B650
@@ -5783,14 +7446,297 @@ void sub_51B650(int cache_entry_index)
         for (rotation = 0; rotation < MAX_ROTATIONS; rotation++) {
             if (art->video_buffers[palette][rotation] != NULL) {
                 for (frame = 0; frame < num_frames; frame++) {
-                    tig_video_buffer_destroy(art->video_buffers[palette][rotation][frame]);
+                    art_video_buffer_destroy(art->video_buffers[palette][rotation][frame], &(art->atlas_slots[palette][rotation][frame]));
                 }
 
                 FREE(art->video_buffers[palette][rotation]);
                 art->video_buffers[palette][rotation] = NULL;
+
+                FREE(art->atlas_slots[palette][rotation]);
+                art->atlas_slots[palette][rotation] = NULL;
+            }
+        }
+    }
+}
+
+// Creates video buffer of art frame, packing it into atlas when possible.
+// Placement of the video buffer is stored in `slot`, which should be passed
+// to `art_video_buffer_destroy`.
+int art_video_buffer_create(TigVideoBufferCreateInfo* vb_create_info, TigVideoBuffer** video_buffer_ptr, TigArtAtlasSlot* slot)
+{
+    int x;
+    int y;
+
+    if (vb_create_info->width > 0
+        && vb_create_info->height > 0
+        && vb_create_info->width <= TIG_ART_ATLAS_MAX_FRAME_SIZE
+        && vb_create_info->height <= TIG_ART_ATLAS_MAX_FRAME_SIZE
+        && tig_art_atlas_alloc(vb_create_info->flags, vb_create_info->width, vb_create_info->height, &(slot->atlas), &x, &y)) {
+        if (tig_video_buffer_create_view(vb_create_info, tig_art_atlases[slot->atlas].video_buffer, x, y, video_buffer_ptr) == TIG_OK) {
+            slot->y = y;
+            return TIG_OK;
+        }
+
+        tig_art_atlas_free(slot->atlas, y);
+    }
+
+    slot->atlas = TIG_ART_ATLAS_NONE;
+    slot->y = 0;
+
+    return tig_video_buffer_create(vb_create_info, video_buffer_ptr);
+}
+
+// Destroys video buffer created with `art_video_buffer_create` and frees its
+// atlas space.
+void art_video_buffer_destroy(TigVideoBuffer* video_buffer, TigArtAtlasSlot* slot)
+{
+    tig_video_buffer_destroy(video_buffer);
+
+    if (slot->atlas != TIG_ART_ATLAS_NONE) {
+        tig_art_atlas_free(slot->atlas, slot->y);
+    }
+}
+
+// Finds space for `width` x `height` frame in atlas of video buffers created
+// with `flags`, creating new atlas if needed.
+//
+// The frame is placed on the shelf which wastes the least vertical space,
+// free shelves (which are split to the frame height) are only taken when no
+// shelf with frames fits. Otherwise a new shelf is opened at the bottom of
+// atlas.
+bool tig_art_atlas_alloc(unsigned int flags, int width, int height, int* atlas_ptr, int* x_ptr, int* y_ptr)
+{
+    TigVideoBufferCreateInfo vb_create_info;
+    TigArtAtlas* atlas;
+    TigArtAtlasShelf* shelf;
+    int atlas_index;
+    int shelf_index;
+    int best_atlas_index = TIG_ART_ATLAS_NONE;
+    int best_shelf_index = -1;
+    int best_waste = INT_MAX;
+    int bottom_atlas_index = TIG_ART_ATLAS_NONE;
+    int unused_atlas_index = TIG_ART_ATLAS_NONE;
+    int waste;
+
+    for (atlas_index = 0; atlas_index < tig_art_atlases_count; atlas_index++) {
+        atlas = &(tig_art_atlases[atlas_index]);
+        if (atlas->video_buffer == NULL) {
+            if (unused_atlas_index == TIG_ART_ATLAS_NONE) {
+                unused_atlas_index = atlas_index;
+            }
+            continue;
+        }
+
+        if (atlas->flags != flags) {
+            continue;
+        }
+
+        for (shelf_index = 0; shelf_index < atlas->shelves_count; shelf_index++) {
+            shelf = &(atlas->shelves[shelf_index]);
+            if (shelf->height < height || TIG_ART_ATLAS_SIZE - shelf->width < width) {
+                continue;
+            }
+
+            if (shelf->frames != 0) {
+                // Limit space wasted above frames placed on taller shelves.
+                waste = shelf->height - height;
+                if (waste > height / 4) {
+                    continue;
+                }
+            } else {
+                waste = TIG_ART_ATLAS_SIZE + shelf->height - height;
+            }
+
+            if (waste < best_waste) {
+                best_atlas_index = atlas_index;
+                best_shelf_index = shelf_index;
+                best_waste = waste;
+            }
+        }
+
+        if (bottom_atlas_index == TIG_ART_ATLAS_NONE
+            && atlas->height + height <= TIG_ART_ATLAS_SIZE) {
+            bottom_atlas_index = atlas_index;
+        }
+    }
+
+    if (best_atlas_index != TIG_ART_ATLAS_NONE) {
+        atlas_index = best_atlas_index;
+        shelf_index = best_shelf_index;
+        atlas = &(tig_art_atlases[atlas_index]);
+
+        if (atlas->shelves[shelf_index].frames == 0
+            && atlas->shelves[shelf_index].height > height) {
+            tig_art_atlas_shelf_insert(atlas,
+                shelf_index + 1,
+                atlas->shelves[shelf_index].y + height,
+                atlas->shelves[shelf_index].height - height);
+            atlas->shelves[shelf_index].height = height;
+        }
+    } else {
+        if (bottom_atlas_index != TIG_ART_ATLAS_NONE) {
+            atlas_index = bottom_atlas_index;
+        } else {
+            if (unused_atlas_index != TIG_ART_ATLAS_NONE) {
+                atlas_index = unused_atlas_index;
+            } else {
+                atlas_index = tig_art_atlases_count;
+                tig_art_atlases = (TigArtAtlas*)REALLOC(tig_art_atlases, sizeof(*tig_art_atlases) * (tig_art_atlases_count + 1));
+                memset(&(tig_art_atlases[atlas_index]), 0, sizeof(*tig_art_atlases));
+                tig_art_atlases_count++;
             }
+
+            vb_create_info.flags = flags;
+            vb_create_info.width = TIG_ART_ATLAS_SIZE;
+            vb_create_info.height = TIG_ART_ATLAS_SIZE;
+            vb_create_info.background_color = 0;
+            vb_create_info.color_key = 0;
+
+            atlas = &(tig_art_atlases[atlas_index]);
+            if (tig_video_buffer_create(&vb_create_info, &(atlas->video_buffer)) != TIG_OK) {
+                atlas->video_buffer = NULL;
+                return false;
+            }
+
+            atlas->flags = flags;
+
+            // Atlas is charged to the art cache video memory as soon as it is
+            // created rather than by frames placed on it, so that eviction
+            // sees memory actually taken (see `tig_art_atlas_destroy`).
+            tig_art_atlases_video_memory += TIG_ART_ATLAS_SIZE * TIG_ART_ATLAS_SIZE * tig_art_bytes_per_pixel;
+            tig_art_available_video_memory -= TIG_ART_ATLAS_SIZE * TIG_ART_ATLAS_SIZE * tig_art_bytes_per_pixel;
+        }
+
+        atlas = &(tig_art_atlases[atlas_index]);
+        shelf_index = atlas->shelves_count;
+        tig_art_atlas_shelf_insert(atlas, shelf_index, atlas->height, height);
+        atlas->height += height;
+    }
+
+    shelf = &(atlas->shelves[shelf_index]);
+
+    *atlas_ptr = atlas_index;
+    *x_ptr = shelf->width;
+    *y_ptr = shelf->y;
+
+    shelf->width += width;
+    shelf->frames++;
+    atlas->frames++;
+
+    return true;
+}
+
+// Frees frame placed on atlas shelf at `y`.
+//
+// Frames are referenced by their video buffers, so they are never moved.
+// Instead, shelves are reclaimed once all their frames are freed and merged
+// with adjacent free shelves (free shelves at the bottom are returned to
+// the atlas), so that the space can be reused by frames of any height.
+// Atlases without frames are destroyed.
+void tig_art_atlas_free(int atlas_index, int y)
+{
+    TigArtAtlas* atlas;
+    TigArtAtlasShelf* shelf;
+    int shelf_index;
+
+    atlas = &(tig_art_atlases[atlas_index]);
+    shelf_index = tig_art_atlas_shelf_find(atlas, y);
+    shelf = &(atlas->shelves[shelf_index]);
+
+    shelf->frames--;
+    atlas->frames--;
+
+    if (atlas->frames == 0) {
+        tig_art_atlas_destroy(atlas);
+        return;
+    }
+
+    if (shelf->frames != 0) {
+        return;
+    }
+
+    shelf->width = 0;
+
+    if (shelf_index + 1 < atlas->shelves_count
+        && atlas->shelves[shelf_index + 1].frames == 0) {
+        shelf->height += atlas->shelves[shelf_index + 1].height;
+        tig_art_atlas_shelf_remove(atlas, shelf_index + 1);
+    }
+
+    if (shelf_index > 0
+        && atlas->shelves[shelf_index - 1].frames == 0) {
+        atlas->shelves[shelf_index - 1].height += atlas->shelves[shelf_index].height;
+        tig_art_atlas_shelf_remove(atlas, shelf_index);
+        shelf_index--;
+    }
+
+    if (shelf_index == atlas->shelves_count - 1) {
+        atlas->height -= atlas->shelves[shelf_index].height;
+        tig_art_atlas_shelf_remove(atlas, shelf_index);
+    }
+}
+
+// Returns index of atlas shelf at `y`.
+int tig_art_atlas_shelf_find(TigArtAtlas* atlas, int y)
+{
+    int lo = 0;
+    int hi = atlas->shelves_count - 1;
+    int mid;
+
+    while (lo < hi) {
+        mid = (lo + hi) / 2;
+        if (atlas->shelves[mid].y < y) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
         }
     }
+
+    return lo;
+}
+
+void tig_art_atlas_shelf_insert(TigArtAtlas* atlas, int index, int y, int height)
+{
+    if (atlas->shelves_count == atlas->shelves_capacity) {
+        atlas->shelves_capacity = atlas->shelves_capacity != 0 ? atlas->shelves_capacity * 2 : 16;
+        atlas->shelves = (TigArtAtlasShelf*)REALLOC(atlas->shelves, sizeof(*atlas->shelves) * atlas->shelves_capacity);
+    }
+
+    memmove(&(atlas->shelves[index + 1]),
+        &(atlas->shelves[index]),
+        sizeof(*atlas->shelves) * (atlas->shelves_count - index));
+    atlas->shelves_count++;
+
+    atlas->shelves[index].y = y;
+    atlas->shelves[index].height = height;
+    atlas->shelves[index].width = 0;
+    atlas->shelves[index].frames = 0;
+}
+
+void tig_art_atlas_shelf_remove(TigArtAtlas* atlas, int index)
+{
+    memmove(&(atlas->shelves[index]),
+        &(atlas->shelves[index + 1]),
+        sizeof(*atlas->shelves) * (atlas->shelves_count - index - 1));
+    atlas->shelves_count--;
+}
+
+// Destroys atlas video buffer and returns its memory to the art cache, the
+// atlas becomes unused.
+void tig_art_atlas_destroy(TigArtAtlas* atlas)
+{
+    if (atlas->video_buffer != NULL) {
+        tig_video_buffer_destroy(atlas->video_buffer);
+
+        tig_art_atlases_video_memory -= TIG_ART_ATLAS_SIZE * TIG_ART_ATLAS_SIZE * tig_art_bytes_per_pixel;
+        tig_art_available_video_memory += TIG_ART_ATLAS_SIZE * TIG_ART_ATLAS_SIZE * tig_art_bytes_per_pixel;
+    }
+
+    if (atlas->shelves != NULL) {
+        FREE(atlas->shelves);
+    }
+
+    memset(atlas, 0, sizeof(*atlas));
 }
 
 // 0x51B710
@@ -5807,6 +7753,8 @@ int sub_51B710(tig_art_id_t art_id, const char* filename, TigArtHeader* hdr, voi
     int current_palette_index;
     void* current_palette;
     int num_rotations;
+    uint8_t* encoded;
+    art_size_t encoded_capacity;
 
     // NOTE: Keep compiler happy.
     current_palette_index = 0;
@@ -5847,7 +7795,9 @@ int sub_51B710(tig_art_id_t art_id, const char* filename, TigArtHeader* hdr, voi
     for (palette = 0; palette < MAX_PALETTES; palette++) {
         saved_palette_tbl[palette] = hdr->palette_tbl[palette];
         hdr->palette_tbl[palette] = NULL;
-        palette_tbl[palette] = NULL;
+        if (palette_tbl != NULL) {
+            palette_tbl[palette] = NULL;
+        }
     }
 
     for (palette = 0; palette < MAX_PALETTES; palette++) {
@@ -5866,36 +7816,18 @@ int sub_51B710(tig_art_id_t art_id, const char* filename, TigArtHeader* hdr, voi
                     tig_file_fclose(stream);
                     return TIG_OK;
                 }
+            } else if (palette_tbl == NULL) {
+                // Palettes are deferred, keep raw entries (see
+                // `tig_art_cache_entry_read`).
+                hdr->palette_tbl[palette] = MALLOC(sizeof(temp_palette_entries));
+                memcpy(hdr->palette_tbl[palette], temp_palette_entries, sizeof(temp_palette_entries));
+                continue;
             } else {
-                hdr->palette_tbl[palette] = tig_palette_create();
-                palette_tbl[palette] = tig_palette_create();
+                // Palettes are shared between art with identical colors.
+                hdr->palette_tbl[palette] = tig_palette_acquire_rgb(temp_palette_entries);
+                palette_tbl[palette] = art_palette_adjust(art_id, hdr->palette_tbl[palette]);
                 *size_ptr += (art_size_t)tig_palette_system_memory_size() * 2;
-
-                switch (tig_art_bits_per_pixel) {
-                case 8:
-                    for (index = 0; index < 256; index++) {
-                        ((uint8_t*)hdr->palette_tbl[palette])[index] = (uint8_t)tig_color_index_of(temp_palette_entries[index]);
-                    }
-                    break;
-                case 16:
-                    for (index = 0; index < 256; index++) {
-                        ((uint16_t*)hdr->palette_tbl[palette])[index] = (uint16_t)tig_color_index_of(temp_palette_entries[index]);
-                    }
-                    break;
-                case 24:
-                    for (index = 0; index < 256; index++) {
-                        ((uint32_t*)hdr->palette_tbl[palette])[index] = (uint32_t)tig_color_index_of(temp_palette_entries[index]);
-                    }
-                    break;
-                case 32:
-                    for (index = 0; index < 256; index++) {
-                        ((uint32_t*)hdr->palette_tbl[palette])[index] = (uint32_t)tig_color_index_of(temp_palette_entries[index]);
-                    }
-                    break;
-                }
             }
-
-            sub_505000(art_id, hdr->palette_tbl[palette], palette_tbl[palette]);
         }
     }
 
@@ -5911,14 +7843,26 @@ int sub_51B710(tig_art_id_t art_id, const char* filename, TigArtHeader* hdr, voi
         }
     }
 
+    // Encoded data of all frames of a rotation is read in one go and decoded
+    // from memory, which avoids going through file (and possibly inflate)
+    // for every run.
+    encoded_capacity = 0;
+    encoded = NULL;
+
     for (index = 0; index < num_rotations; index++) {
         uint8_t* bytes;
         art_size_t total_size;
+        art_size_t encoded_size;
+        const uint8_t* src;
 
-        // Calculate total size of pixels data.
+        // Calculate total size of pixels and encoded data.
         total_size = 0;
+        encoded_size = 0;
         for (frame = 0; frame < hdr->num_frames; ++frame) {
             total_size += hdr->frames_tbl[index][frame].width * hdr->frames_tbl[index][frame].height;
+            if (hdr->frames_tbl[index][frame].data_size > 0) {
+                encoded_size += hdr->frames_tbl[index][frame].data_size;
+            }
         }
 
         // Allocate appropriate memory.
@@ -5928,51 +7872,47 @@ int sub_51B710(tig_art_id_t art_id, const char* filename, TigArtHeader* hdr, voi
         size_tbl[index] = total_size;
         *size_ptr += total_size;
 
-        // Read raw pixel data for each frame.
+        if (encoded_size > encoded_capacity) {
+            encoded = (uint8_t*)REALLOC(encoded, encoded_size);
+            encoded_capacity = encoded_size;
+        }
+
+        if (encoded_size > 0
+            && tig_file_fread(encoded, 1, encoded_size, stream) != (size_t)encoded_size) {
+            FREE(encoded);
+            sub_51BE50(stream, hdr, palette_tbl);
+            return TIG_ERR_GENERIC;
+        }
+
         bytes = hdr->pixels_tbl[index];
+        src = encoded;
         for (frame = 0; frame < hdr->num_frames; ++frame) {
-            if (hdr->frames_tbl[index][frame].data_size == hdr->frames_tbl[index][frame].width * hdr->frames_tbl[index][frame].height) {
-                // Pixels are not compressed, read everything in one go.
-                if (tig_file_fread(bytes, 1, hdr->frames_tbl[index][frame].data_size, stream) != (size_t)hdr->frames_tbl[index][frame].data_size) {
+            int frame_size = hdr->frames_tbl[index][frame].width * hdr->frames_tbl[index][frame].height;
+            int data_size = hdr->frames_tbl[index][frame].data_size;
+
+            if (data_size == frame_size) {
+                // Pixels are not compressed.
+                memcpy(bytes, src, frame_size);
+            } else if (data_size > 0) {
+                // Pixels are RLE-encoded.
+                if (!art_read_rle_decode(src, data_size, bytes, frame_size)) {
+                    FREE(encoded);
                     sub_51BE50(stream, hdr, palette_tbl);
                     return TIG_ERR_GENERIC;
                 }
-                bytes += hdr->frames_tbl[index][frame].data_size;
-            } else if (hdr->frames_tbl[index][frame].data_size > 0) {
-                // Pixels are RLE-encoded.
-                uint8_t value;
-                uint8_t color;
-                int len;
-                int cnt = 0;
-
-                while (cnt < hdr->frames_tbl[index][frame].data_size) {
-                    if (tig_file_fread(&value, 1, 1, stream) != 1) {
-                        sub_51BE50(stream, hdr, palette_tbl);
-                        return TIG_ERR_GENERIC;
-                    }
-
-                    len = value & 0x7F;
-                    if ((value & 0x80) != 0) {
-                        if (tig_file_fread(bytes, 1, len, stream) != (size_t)len) {
-                            sub_51BE50(stream, hdr, palette_tbl);
-                            return TIG_ERR_GENERIC;
-                        }
-                        cnt += 1 + len;
-                    } else {
-                        if (tig_file_fread(&color, 1, 1, stream) != 1) {
-                            sub_51BE50(stream, hdr, palette_tbl);
-                            return TIG_ERR_GENERIC;
-                        }
+            }
 
-                        memset(bytes, color, len);
-                        cnt += 2;
-                    }
-                    bytes += len;
-                }
+            if (data_size > 0) {
+                src += data_size;
             }
+            bytes += frame_size;
         }
     }
 
+    if (encoded != NULL) {
+        FREE(encoded);
+    }
+
     while (index < MAX_ROTATIONS) {
         hdr->frames_tbl[index] = hdr->frames_tbl[0];
         hdr->pixels_tbl[index] = hdr->pixels_tbl[0];
@@ -6002,6 +7942,37 @@ int sub_51B710(tig_art_id_t art_id, const char* filename, TigArtHeader* hdr, voi
     return TIG_OK;
 }
 
+// Decodes RLE-encoded frame pixels. Returns `false` if the data is malformed.
+bool art_read_rle_decode(const uint8_t* src, int src_size, uint8_t* dst, int dst_size)
+{
+    const uint8_t* end = src + src_size;
+    uint8_t* dst_end = dst + dst_size;
+    int len;
+
+    while (src < end) {
+        len = *src & 0x7F;
+        if (len > dst_end - dst) {
+            return false;
+        }
+
+        if ((*src++ & 0x80) != 0) {
+            if (len > end - src) {
+                return false;
+            }
+            memcpy(dst, src, len);
+            src += len;
+        } else {
+            if (src == end) {
+                return false;
+            }
+            memset(dst, *src++, len);
+        }
+        dst += len;
+    }
+
+    return true;
+}
+
 // 0x51BE30
 int sub_51BE30(TigArtHeader* hdr)
 {
@@ -6020,12 +7991,21 @@ void sub_51BE50(TigFile* stream, TigArtHeader* hdr, TigPalette* palette_tbl)
     sub_51BF20(hdr);
 
     for (palette = 0; palette < MAX_PALETTES; ++palette) {
+        if (palette_tbl == NULL) {
+            // Deferred palettes are raw entries.
+            if (hdr->palette_tbl[palette] != NULL) {
+                FREE(hdr->palette_tbl[palette]);
+                hdr->palette_tbl[palette] = NULL;
+            }
+            continue;
+        }
+
         if (hdr->palette_tbl[palette] != NULL) {
-            tig_palette_destroy(hdr->palette_tbl[palette]);
+            tig_palette_release(hdr->palette_tbl[palette]);
         }
 
         if (palette_tbl[palette] != NULL) {
-            tig_palette_destroy(palette_tbl[palette]);
+            tig_palette_release(palette_tbl[palette]);
         }
     }
 }
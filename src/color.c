@@ -28,6 +28,25 @@ static void tig_color_rgb_conversion_tables_init();
 static void tig_color_rgb_conversion_tables_exit();
 static void tig_color_table_4_init();
 static void tig_color_table_4_exit();
+static void tig_color_batch_init();
+#ifdef SDL_SSE2_INTRINSICS
+static int tig_color_add_n_sse2(tig_color_t* dst, const tig_color_t* src, int n);
+static int tig_color_sub_n_sse2(tig_color_t* dst, const tig_color_t* src, int n);
+static int tig_color_mul_n_sse2(tig_color_t* dst, const tig_color_t* src, int n);
+static int tig_color_blend_alpha_n_sse2(tig_color_t* dst, const tig_color_t* src, int alpha, int n);
+#endif
+#ifdef SDL_AVX2_INTRINSICS
+static int tig_color_add_n_avx2(tig_color_t* dst, const tig_color_t* src, int n);
+static int tig_color_sub_n_avx2(tig_color_t* dst, const tig_color_t* src, int n);
+static int tig_color_mul_n_avx2(tig_color_t* dst, const tig_color_t* src, int n);
+static int tig_color_blend_alpha_n_avx2(tig_color_t* dst, const tig_color_t* src, int alpha, int n);
+#endif
+
+// Vectorized kernel of batch blending operation. Processes leading pixels
+// (in multiples of vector width) and returns number of pixels processed,
+// the rest is handled by scalar operators.
+typedef int(TigColorBatchFunc)(tig_color_t* dst, const tig_color_t* src, int n);
+typedef int(TigColorBatchAlphaFunc)(tig_color_t* dst, const tig_color_t* src, int alpha, int n);
 
 // This table contains masks which should be applied to `tig_color_t` value in order
 // to extract appropriate color component (see `tig_color_shifts_table`).
@@ -84,6 +103,13 @@ static int tig_color_bpp;
 // 0x62B2A0
 static bool tig_color_initialized;
 
+// Vectorized kernels of batch blending operations for current video mode,
+// `NULL` when the mode or CPU is not supported (see `tig_color_batch_init`).
+static TigColorBatchFunc* tig_color_add_n_func;
+static TigColorBatchFunc* tig_color_sub_n_func;
+static TigColorBatchFunc* tig_color_mul_n_func;
+static TigColorBatchAlphaFunc* tig_color_blend_alpha_n_func;
+
 // 0x739E88
 uint8_t* tig_color_green_mult_table;
 
@@ -292,6 +318,7 @@ int tig_color_set_rgb_settings(unsigned int red_mask, unsigned int green_mask, u
     tig_color_mult_tables_init();
     tig_color_grayscale_table_init();
     tig_color_rgb_conversion_tables_init();
+    tig_color_batch_init();
 
     return 0;
 }
@@ -896,3 +923,334 @@ void tig_color_table_4_exit()
         tig_color_rgba_red_table = NULL;
     }
 }
+
+void tig_color_add_n(tig_color_t* dst, const tig_color_t* src, int n)
+{
+    int index = 0;
+
+    if (tig_color_add_n_func != NULL) {
+        index = tig_color_add_n_func(dst, src, n);
+    }
+
+    for (; index < n; index++) {
+        dst[index] = tig_color_add(src[index], dst[index]);
+    }
+}
+
+void tig_color_sub_n(tig_color_t* dst, const tig_color_t* src, int n)
+{
+    int index = 0;
+
+    if (tig_color_sub_n_func != NULL) {
+        index = tig_color_sub_n_func(dst, src, n);
+    }
+
+    for (; index < n; index++) {
+        dst[index] = tig_color_sub(src[index], dst[index]);
+    }
+}
+
+void tig_color_mul_n(tig_color_t* dst, const tig_color_t* src, int n)
+{
+    int index = 0;
+
+    if (tig_color_mul_n_func != NULL) {
+        index = tig_color_mul_n_func(dst, src, n);
+    }
+
+    for (; index < n; index++) {
+        dst[index] = tig_color_mul(src[index], dst[index]);
+    }
+}
+
+void tig_color_blend_alpha_n(tig_color_t* dst, const tig_color_t* src, int alpha, int n)
+{
+    int index = 0;
+
+    if (tig_color_blend_alpha_n_func != NULL) {
+        index = tig_color_blend_alpha_n_func(dst, src, alpha, n);
+    }
+
+    for (; index < n; index++) {
+        dst[index] = tig_color_blend_alpha(src[index], dst[index], alpha);
+    }
+}
+
+// Selects vectorized kernels of batch blending operations.
+//
+// The kernels process every byte of a color independently, so they are only
+// applicable when each color component occupies a whole byte (which is the
+// case for every 32 bpp mode). In this case every operator can be expressed
+// with 8-bit (add, sub) or 16-bit (mul, blend alpha) lanes while producing
+// exactly the same results as scalar versions.
+//
+// The top byte is excluded, scalar operators compute products of unshifted
+// components in 32 bits, which overflow for a component in the top byte.
+void tig_color_batch_init()
+{
+    unsigned int masks[CC_COUNT];
+    int cc;
+
+    tig_color_add_n_func = NULL;
+    tig_color_sub_n_func = NULL;
+    tig_color_mul_n_func = NULL;
+    tig_color_blend_alpha_n_func = NULL;
+
+    masks[CC_RED] = tig_color_red_mask;
+    masks[CC_GREEN] = tig_color_green_mask;
+    masks[CC_BLUE] = tig_color_blue_mask;
+
+    for (cc = 0; cc < CC_COUNT; cc++) {
+        if (masks[cc] != 0xFF
+            && masks[cc] != 0xFF00
+            && masks[cc] != 0xFF0000) {
+            return;
+        }
+    }
+
+    if (masks[CC_RED] == masks[CC_GREEN]
+        || masks[CC_RED] == masks[CC_BLUE]
+        || masks[CC_GREEN] == masks[CC_BLUE]) {
+        return;
+    }
+
+#ifdef SDL_SSE2_INTRINSICS
+    if (SDL_HasSSE2()) {
+        tig_color_add_n_func = tig_color_add_n_sse2;
+        tig_color_sub_n_func = tig_color_sub_n_sse2;
+        tig_color_mul_n_func = tig_color_mul_n_sse2;
+        tig_color_blend_alpha_n_func = tig_color_blend_alpha_n_sse2;
+    }
+#endif
+
+#ifdef SDL_AVX2_INTRINSICS
+    if (SDL_HasAVX2()) {
+        tig_color_add_n_func = tig_color_add_n_avx2;
+        tig_color_sub_n_func = tig_color_sub_n_avx2;
+        tig_color_mul_n_func = tig_color_mul_n_avx2;
+        tig_color_blend_alpha_n_func = tig_color_blend_alpha_n_avx2;
+    }
+#endif
+}
+
+#ifdef SDL_SSE2_INTRINSICS
+SDL_TARGETING("sse2") int tig_color_add_n_sse2(tig_color_t* dst, const tig_color_t* src, int n)
+{
+    __m128i mask;
+    __m128i s;
+    __m128i d;
+    int index;
+
+    mask = _mm_set1_epi32((int)(tig_color_red_mask | tig_color_green_mask | tig_color_blue_mask));
+
+    for (index = 0; index + 4 <= n; index += 4) {
+        s = _mm_loadu_si128((const __m128i*)(src + index));
+        d = _mm_loadu_si128((const __m128i*)(dst + index));
+        d = _mm_and_si128(_mm_adds_epu8(s, d), mask);
+        _mm_storeu_si128((__m128i*)(dst + index), d);
+    }
+
+    return index;
+}
+
+SDL_TARGETING("sse2") int tig_color_sub_n_sse2(tig_color_t* dst, const tig_color_t* src, int n)
+{
+    __m128i mask;
+    __m128i s;
+    __m128i d;
+    int index;
+
+    mask = _mm_set1_epi32((int)(tig_color_red_mask | tig_color_green_mask | tig_color_blue_mask));
+
+    for (index = 0; index + 4 <= n; index += 4) {
+        s = _mm_loadu_si128((const __m128i*)(src + index));
+        d = _mm_loadu_si128((const __m128i*)(dst + index));
+        d = _mm_and_si128(_mm_subs_epu8(d, s), mask);
+        _mm_storeu_si128((__m128i*)(dst + index), d);
+    }
+
+    return index;
+}
+
+// Calculates `a * b / 255` (rounded down, as in mult tables) of 16-bit
+// lanes.
+SDL_TARGETING("sse2") static inline __m128i tig_color_mul_epu16_sse2(__m128i a, __m128i b)
+{
+    __m128i t;
+
+    t = _mm_add_epi16(_mm_mullo_epi16(a, b), _mm_set1_epi16(1));
+    return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+SDL_TARGETING("sse2") int tig_color_mul_n_sse2(tig_color_t* dst, const tig_color_t* src, int n)
+{
+    __m128i mask;
+    __m128i zero;
+    __m128i s;
+    __m128i d;
+    __m128i lo;
+    __m128i hi;
+    int index;
+
+    mask = _mm_set1_epi32((int)(tig_color_red_mask | tig_color_green_mask | tig_color_blue_mask));
+    zero = _mm_setzero_si128();
+
+    for (index = 0; index + 4 <= n; index += 4) {
+        s = _mm_loadu_si128((const __m128i*)(src + index));
+        d = _mm_loadu_si128((const __m128i*)(dst + index));
+        lo = tig_color_mul_epu16_sse2(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero));
+        hi = tig_color_mul_epu16_sse2(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero));
+        d = _mm_and_si128(_mm_packus_epi16(lo, hi), mask);
+        _mm_storeu_si128((__m128i*)(dst + index), d);
+    }
+
+    return index;
+}
+
+// Calculates `d + alpha * (s - d) / 256` of 16-bit lanes. Only the low byte
+// of the result is meaningful, which makes wrapping 16-bit arithmetic exact.
+SDL_TARGETING("sse2") static inline __m128i tig_color_blend_alpha_epu16_sse2(__m128i s, __m128i d, __m128i alpha)
+{
+    __m128i t;
+
+    t = _mm_srli_epi16(_mm_mullo_epi16(_mm_sub_epi16(s, d), alpha), 8);
+    return _mm_and_si128(_mm_add_epi16(d, t), _mm_set1_epi16(0xFF));
+}
+
+SDL_TARGETING("sse2") int tig_color_blend_alpha_n_sse2(tig_color_t* dst, const tig_color_t* src, int alpha, int n)
+{
+    __m128i mask;
+    __m128i zero;
+    __m128i a;
+    __m128i s;
+    __m128i d;
+    __m128i lo;
+    __m128i hi;
+    int index;
+
+    mask = _mm_set1_epi32((int)(tig_color_red_mask | tig_color_green_mask | tig_color_blue_mask));
+    zero = _mm_setzero_si128();
+    a = _mm_set1_epi16((short)alpha);
+
+    for (index = 0; index + 4 <= n; index += 4) {
+        s = _mm_loadu_si128((const __m128i*)(src + index));
+        d = _mm_loadu_si128((const __m128i*)(dst + index));
+        lo = tig_color_blend_alpha_epu16_sse2(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero), a);
+        hi = tig_color_blend_alpha_epu16_sse2(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero), a);
+        d = _mm_and_si128(_mm_packus_epi16(lo, hi), mask);
+        _mm_storeu_si128((__m128i*)(dst + index), d);
+    }
+
+    return index;
+}
+#endif
+
+#ifdef SDL_AVX2_INTRINSICS
+SDL_TARGETING("avx2") int tig_color_add_n_avx2(tig_color_t* dst, const tig_color_t* src, int n)
+{
+    __m256i mask;
+    __m256i s;
+    __m256i d;
+    int index;
+
+    mask = _mm256_set1_epi32((int)(tig_color_red_mask | tig_color_green_mask | tig_color_blue_mask));
+
+    for (index = 0; index + 8 <= n; index += 8) {
+        s = _mm256_loadu_si256((const __m256i*)(src + index));
+        d = _mm256_loadu_si256((const __m256i*)(dst + index));
+        d = _mm256_and_si256(_mm256_adds_epu8(s, d), mask);
+        _mm256_storeu_si256((__m256i*)(dst + index), d);
+    }
+
+    return index;
+}
+
+SDL_TARGETING("avx2") int tig_color_sub_n_avx2(tig_color_t* dst, const tig_color_t* src, int n)
+{
+    __m256i mask;
+    __m256i s;
+    __m256i d;
+    int index;
+
+    mask = _mm256_set1_epi32((int)(tig_color_red_mask | tig_color_green_mask | tig_color_blue_mask));
+
+    for (index = 0; index + 8 <= n; index += 8) {
+        s = _mm256_loadu_si256((const __m256i*)(src + index));
+        d = _mm256_loadu_si256((const __m256i*)(dst + index));
+        d = _mm256_and_si256(_mm256_subs_epu8(d, s), mask);
+        _mm256_storeu_si256((__m256i*)(dst + index), d);
+    }
+
+    return index;
+}
+
+// See `tig_color_mul_epu16_sse2`.
+SDL_TARGETING("avx2") static inline __m256i tig_color_mul_epu16_avx2(__m256i a, __m256i b)
+{
+    __m256i t;
+
+    t = _mm256_add_epi16(_mm256_mullo_epi16(a, b), _mm256_set1_epi16(1));
+    return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+}
+
+SDL_TARGETING("avx2") int tig_color_mul_n_avx2(tig_color_t* dst, const tig_color_t* src, int n)
+{
+    __m256i mask;
+    __m256i zero;
+    __m256i s;
+    __m256i d;
+    __m256i lo;
+    __m256i hi;
+    int index;
+
+    mask = _mm256_set1_epi32((int)(tig_color_red_mask | tig_color_green_mask | tig_color_blue_mask));
+    zero = _mm256_setzero_si256();
+
+    for (index = 0; index + 8 <= n; index += 8) {
+        s = _mm256_loadu_si256((const __m256i*)(src + index));
+        d = _mm256_loadu_si256((const __m256i*)(dst + index));
+        lo = tig_color_mul_epu16_avx2(_mm256_unpacklo_epi8(s, zero), _mm256_unpacklo_epi8(d, zero));
+        hi = tig_color_mul_epu16_avx2(_mm256_unpackhi_epi8(s, zero), _mm256_unpackhi_epi8(d, zero));
+        d = _mm256_and_si256(_mm256_packus_epi16(lo, hi), mask);
+        _mm256_storeu_si256((__m256i*)(dst + index), d);
+    }
+
+    return index;
+}
+
+// See `tig_color_blend_alpha_epu16_sse2`.
+SDL_TARGETING("avx2") static inline __m256i tig_color_blend_alpha_epu16_avx2(__m256i s, __m256i d, __m256i alpha)
+{
+    __m256i t;
+
+    t = _mm256_srli_epi16(_mm256_mullo_epi16(_mm256_sub_epi16(s, d), alpha), 8);
+    return _mm256_and_si256(_mm256_add_epi16(d, t), _mm256_set1_epi16(0xFF));
+}
+
+SDL_TARGETING("avx2") int tig_color_blend_alpha_n_avx2(tig_color_t* dst, const tig_color_t* src, int alpha, int n)
+{
+    __m256i mask;
+    __m256i zero;
+    __m256i a;
+    __m256i s;
+    __m256i d;
+    __m256i lo;
+    __m256i hi;
+    int index;
+
+    mask = _mm256_set1_epi32((int)(tig_color_red_mask | tig_color_green_mask | tig_color_blue_mask));
+    zero = _mm256_setzero_si256();
+    a = _mm256_set1_epi16((short)alpha);
+
+    for (index = 0; index + 8 <= n; index += 8) {
+        s = _mm256_loadu_si256((const __m256i*)(src + index));
+        d = _mm256_loadu_si256((const __m256i*)(dst + index));
+        lo = tig_color_blend_alpha_epu16_avx2(_mm256_unpacklo_epi8(s, zero), _mm256_unpacklo_epi8(d, zero), a);
+        hi = tig_color_blend_alpha_epu16_avx2(_mm256_unpackhi_epi8(s, zero), _mm256_unpackhi_epi8(d, zero), a);
+        d = _mm256_and_si256(_mm256_packus_epi16(lo, hi), mask);
+        _mm256_storeu_si256((__m256i*)(dst + index), d);
+    }
+
+    return index;
+}
+#endif
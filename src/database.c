@@ -24,6 +24,10 @@ typedef struct DecompressionContext {
 #define TIG_DATABASE_FILE_ERROR 0x04
 #define TIG_DATABASE_FILE_TEXT_MODE 0x08
 
+// Handles are independent of each other (every handle has its own underlying
+// stream and decompression state), so different handles can be read from
+// different threads. Opening and closing handles changes the list of open
+// handles of the database and must be serialized by the caller.
 typedef struct TigDatabaseFileHandle {
     unsigned int flags;
     TigDatabase* database;
@@ -45,9 +49,6 @@ static bool tig_database_fopen_internal(TigDatabase* database, TigDatabaseEntry*
 static int tig_database_fgetc_internal(TigDatabaseFileHandle* stream);
 static bool tig_database_fread_internal(void* buffer, size_t size, TigDatabaseFileHandle* stream);
 
-// 0x638BBC
-static unsigned char tig_database_decompression_buffer[DECOMPRESSION_BUFFER_SIZE];
-
 // 0x63CBC0
 static TigDatabase* tig_database_open_databases_head;
 
@@ -649,6 +650,9 @@ int tig_database_fseek(TigDatabaseFileHandle* stream, int offset, int origin)
             return 1;
         }
     } else if ((stream->entry->flags & TIG_DATABASE_ENTRY_COMPRESSED) != 0) {
+        // Skipped bytes are decompressed into the local buffer rather than a
+        // shared one, so that handles can be read from different threads.
+        unsigned char buffer[DECOMPRESSION_BUFFER_SIZE];
         unsigned int bytes_to_skip;
 
         if (pos < stream->pos) {
@@ -674,7 +678,7 @@ int tig_database_fseek(TigDatabaseFileHandle* stream, int offset, int origin)
 
         bytes_to_skip = pos - stream->pos;
         while (bytes_to_skip >= DECOMPRESSION_BUFFER_SIZE) {
-            if (!tig_database_fread_internal(tig_database_decompression_buffer, DECOMPRESSION_BUFFER_SIZE, stream)) {
+            if (!tig_database_fread_internal(buffer, DECOMPRESSION_BUFFER_SIZE, stream)) {
                 return 1;
             }
 
@@ -682,7 +686,7 @@ int tig_database_fseek(TigDatabaseFileHandle* stream, int offset, int origin)
         }
 
         if (bytes_to_skip > 0) {
-            if (!tig_database_fread_internal(tig_database_decompression_buffer, bytes_to_skip, stream)) {
+            if (!tig_database_fread_internal(buffer, bytes_to_skip, stream)) {
                 return 1;
             }
         }
@@ -94,6 +94,17 @@ static TigFileRepository* tig_file_repositories_head;
 // 0x62B2B0
 static TigFileIgnore* tig_file_ignore_head;
 
+// Guards repositories list and opening/closing files, so that files can be
+// read from background threads. Reading an opened file does not touch shared
+// state, but opening and closing database files changes the list of open
+// handles of the database (see `tig_database_fopen_entry`). The mutex is
+// recursive, functions which hold it may open and close files.
+static SDL_Mutex* tig_file_mutex;
+
+// Incremented when repositories are added or removed (see
+// `tig_file_repository_version`).
+static unsigned int tig_file_repositories_version;
+
 // 0x52DFE0
 bool tig_file_mkdir_native(const char* path)
 {
@@ -542,6 +553,8 @@ int tig_file_init(TigInitInfo* init_info)
 {
     (void)init_info;
 
+    tig_file_mutex = SDL_CreateMutex();
+
     // FIX: Make `tig.dat` mandatory.
     //
     // When `tig.dat` is not present in the current working directory, the
@@ -549,6 +562,8 @@ int tig_file_init(TigInitInfo* init_info)
     // `GetModuleFileNameA`, which is the full path to `Arcanum.exe`. Obviously,
     // this is not a valid asset bundle.
     if (!tig_file_repository_add("tig.dat")) {
+        SDL_DestroyMutex(tig_file_mutex);
+        tig_file_mutex = NULL;
         return TIG_ERR_GENERIC;
     }
 
@@ -573,6 +588,9 @@ void tig_file_exit()
     }
 
     tig_file_repository_remove_all();
+
+    SDL_DestroyMutex(tig_file_mutex);
+    tig_file_mutex = NULL;
 }
 
 // 0x52ED40
@@ -712,6 +730,8 @@ bool tig_file_repository_remove_all()
     TigFileRepository* next;
     char path[TIG_MAX_PATH];
 
+    SDL_LockMutex(tig_file_mutex);
+
     curr = tig_file_repositories_head;
     while (curr != NULL) {
         next = curr->next;
@@ -729,6 +749,9 @@ bool tig_file_repository_remove_all()
     }
 
     tig_file_repositories_head = NULL;
+    tig_file_repositories_version++;
+
+    SDL_UnlockMutex(tig_file_mutex);
 
     return true;
 }
@@ -1278,7 +1301,10 @@ int tig_file_fclose(TigFile* stream)
 {
     bool success;
 
+    SDL_LockMutex(tig_file_mutex);
     success = tig_file_close_internal(stream);
+    SDL_UnlockMutex(tig_file_mutex);
+
     tig_file_destroy(stream);
 
     if (!success) {
@@ -1310,9 +1336,15 @@ int tig_file_fflush(TigFile* stream)
 TigFile* tig_file_fopen_native(const char* path, const char* mode)
 {
     TigFile* stream;
+    int rc;
 
     stream = tig_file_create();
-    if (tig_file_open_internal_native(path, mode, stream) == 0) {
+
+    SDL_LockMutex(tig_file_mutex);
+    rc = tig_file_open_internal_native(path, mode, stream);
+    SDL_UnlockMutex(tig_file_mutex);
+
+    if (rc == 0) {
         tig_file_destroy(stream);
         return NULL;
     }
@@ -1323,9 +1355,14 @@ TigFile* tig_file_fopen_native(const char* path, const char* mode)
 // 0x5303D0
 TigFile* tig_file_reopen_native(const char* path, const char* mode, TigFile* stream)
 {
+    int rc;
+
+    SDL_LockMutex(tig_file_mutex);
     tig_file_close_internal(stream);
+    rc = tig_file_open_internal_native(path, mode, stream);
+    SDL_UnlockMutex(tig_file_mutex);
 
-    if (tig_file_open_internal_native(path, mode, stream) == 0) {
+    if (rc == 0) {
         tig_file_destroy(stream);
         return NULL;
     }
@@ -2217,23 +2254,50 @@ bool tig_file_unarchive(const char* src, const char* dst)
 bool tig_file_repository_add(const char* path)
 {
     char native_path[TIG_MAX_PATH];
+    bool success;
 
     strcpy(native_path, path);
     compat_windows_path_to_native(native_path);
     compat_resolve_path(native_path);
 
-    return tig_file_repository_add_native(native_path);
+    SDL_LockMutex(tig_file_mutex);
+    success = tig_file_repository_add_native(native_path);
+    if (success) {
+        tig_file_repositories_version++;
+    }
+    SDL_UnlockMutex(tig_file_mutex);
+
+    return success;
 }
 
 bool tig_file_repository_remove(const char* path)
 {
     char native_path[TIG_MAX_PATH];
+    bool success;
 
     strcpy(native_path, path);
     compat_windows_path_to_native(native_path);
     compat_resolve_path(native_path);
 
-    return tig_file_repository_remove_native(native_path);
+    SDL_LockMutex(tig_file_mutex);
+    success = tig_file_repository_remove_native(native_path);
+    if (success) {
+        tig_file_repositories_version++;
+    }
+    SDL_UnlockMutex(tig_file_mutex);
+
+    return success;
+}
+
+unsigned int tig_file_repository_version()
+{
+    unsigned int version;
+
+    SDL_LockMutex(tig_file_mutex);
+    version = tig_file_repositories_version;
+    SDL_UnlockMutex(tig_file_mutex);
+
+    return version;
 }
 
 int tig_file_mkdir_ex(const char* path)
@@ -2261,12 +2325,19 @@ int tig_file_rmdir_ex(const char* path)
 bool tig_file_extract(const char* filename, char* path)
 {
     char native_filename[TIG_MAX_PATH];
+    bool success;
 
     strcpy(native_filename, filename);
     compat_windows_path_to_native(native_filename);
     compat_resolve_path(native_filename);
 
-    return tig_file_extract_native(native_filename, path);
+    // Extraction opens database files directly (see
+    // `tig_database_fopen_entry`).
+    SDL_LockMutex(tig_file_mutex);
+    success = tig_file_extract_native(native_filename, path);
+    SDL_UnlockMutex(tig_file_mutex);
+
+    return success;
 }
 
 void tig_file_list_create(TigFileList* list, const char* pattern)
@@ -0,0 +1,25 @@
+#ifndef TIG_FIXED_H_
+#define TIG_FIXED_H_
+
+#include <stdint.h>
+
+// 16.16 fixed-point helpers shared by stretched blits of art and video
+// buffers. Internal to the library.
+
+// One in 16.16 fixed-point representation.
+#define TIG_FIXED_ONE 0x10000
+
+// Returns 16.16 fixed-point ratio of `src_size` to `dst_size`.
+static inline int tig_fixed_ratio(int src_size, int dst_size)
+{
+    return (int)(((int64_t)src_size << 16) / dst_size);
+}
+
+// Returns integer `value` divided by 16.16 fixed-point `ratio`, i.e. number
+// of destination pixels covered by `value` source pixels.
+static inline int tig_fixed_div(int value, int ratio)
+{
+    return (int)(((int64_t)value << 16) / ratio);
+}
+
+#endif /* TIG_FIXED_H_ */
@@ -147,6 +147,10 @@ void tig_message_ping()
                 tig_message_enqueue(&message);
             }
             break;
+        case SDL_EVENT_RENDER_DEVICE_RESET:
+            // Texture content is lost along with the device.
+            tig_video_invalidate(NULL);
+            break;
         case SDL_EVENT_QUIT:
             tig_message_post_quit(0);
             break;
@@ -11,8 +11,42 @@ typedef struct TigPaletteListNode {
     struct TigPaletteListNode* next;
 } TigPaletteListNode;
 
+// Shared palette (see `tig_palette_acquire`).
+typedef struct TigPalettePoolEntry {
+    TigPalette palette;
+    int refcount;
+
+    // Hash of palette entries, the entry is linked into
+    // `tig_palette_pool_buckets` via `next`.
+    unsigned int hash;
+    struct TigPalettePoolEntry* next;
+
+    // RGB colors the palette was converted from (only for palettes acquired
+    // with `tig_palette_acquire_rgb`), linked via `sibling`. There can be
+    // several of them, since different colors might be converted into the
+    // same palette.
+    struct TigPaletteRgbKey* rgb_keys;
+} TigPalettePoolEntry;
+
+// RGB colors shared palette was converted from (see
+// `tig_palette_acquire_rgb`), the key is linked into
+// `tig_palette_pool_rgb_buckets` via `next`.
+typedef struct TigPaletteRgbKey {
+    uint32_t colors[256];
+    unsigned int hash;
+    TigPalettePoolEntry* entry;
+    struct TigPaletteRgbKey* next;
+    struct TigPaletteRgbKey* sibling;
+} TigPaletteRgbKey;
+
+// Number of buckets in the shared palettes hash tables.
+#define POOL_BUCKETS 256
+
 static void tig_palette_node_reserve();
 static void tig_palette_node_clear();
+static unsigned int tig_palette_hash(const void* data, size_t size);
+static TigPalettePoolEntry* tig_palette_pool_find(TigPalette palette, unsigned int hash);
+static TigPalette tig_palette_pool_add(TigPalette palette, unsigned int hash);
 
 // 0x6301F8
 static bool tig_palette_initialized;
@@ -26,6 +60,12 @@ static size_t tig_palette_size;
 // 0x630204
 static TigPaletteListNode* tig_palette_head;
 
+// Shared palettes keyed by their entries.
+static TigPalettePoolEntry* tig_palette_pool_buckets[POOL_BUCKETS];
+
+// Shared palettes keyed by RGB colors they were converted from.
+static TigPaletteRgbKey* tig_palette_pool_rgb_buckets[POOL_BUCKETS];
+
 // 0x533D50
 int tig_palette_init(TigInitInfo* init_info)
 {
@@ -64,7 +104,27 @@ int tig_palette_init(TigInitInfo* init_info)
 // 0x533DD0
 void tig_palette_exit()
 {
+    TigPalettePoolEntry* entry;
+    TigPaletteRgbKey* rgb_key;
+    int index;
+
     if (tig_palette_initialized) {
+        // Release shared palettes which are still referenced.
+        for (index = 0; index < POOL_BUCKETS; index++) {
+            while (tig_palette_pool_buckets[index] != NULL) {
+                entry = tig_palette_pool_buckets[index];
+                tig_palette_pool_buckets[index] = entry->next;
+                tig_palette_destroy(entry->palette);
+                while (entry->rgb_keys != NULL) {
+                    rgb_key = entry->rgb_keys;
+                    entry->rgb_keys = rgb_key->sibling;
+                    FREE(rgb_key);
+                }
+                FREE(entry);
+            }
+            tig_palette_pool_rgb_buckets[index] = NULL;
+        }
+
         tig_palette_node_clear();
         tig_palette_initialized = false;
     }
@@ -194,6 +254,125 @@ void tig_palette_modify(const TigPaletteModifyInfo* modify_info)
     }
 }
 
+TigPalette tig_palette_acquire(const TigPalette palette)
+{
+    unsigned int hash;
+    TigPalettePoolEntry* entry;
+
+    hash = tig_palette_hash(palette, tig_palette_size);
+
+    entry = tig_palette_pool_find(palette, hash);
+    if (entry != NULL) {
+        entry->refcount++;
+        return entry->palette;
+    }
+
+    return tig_palette_pool_add(palette, hash);
+}
+
+TigPalette tig_palette_acquire_rgb(const uint32_t* colors)
+{
+    unsigned int hash;
+    unsigned int rgb_hash;
+    TigPalettePoolEntry* entry;
+    TigPaletteRgbKey* rgb_key;
+    TigPalette palette;
+    int index;
+
+    rgb_hash = tig_palette_hash(colors, sizeof(*colors) * 256);
+
+    for (rgb_key = tig_palette_pool_rgb_buckets[rgb_hash % POOL_BUCKETS]; rgb_key != NULL; rgb_key = rgb_key->next) {
+        if (rgb_key->hash == rgb_hash
+            && memcmp(rgb_key->colors, colors, sizeof(*colors) * 256) == 0) {
+            rgb_key->entry->refcount++;
+            return rgb_key->entry->palette;
+        }
+    }
+
+    palette = tig_palette_create();
+
+    switch (tig_palette_bpp) {
+    case 16:
+        for (index = 0; index < 256; index++) {
+            ((uint16_t*)palette)[index] = (uint16_t)tig_color_index_of(colors[index]);
+        }
+        break;
+    case 24:
+    case 32:
+        for (index = 0; index < 256; index++) {
+            ((uint32_t*)palette)[index] = (uint32_t)tig_color_index_of(colors[index]);
+        }
+        break;
+    }
+
+    // Different colors might be converted into the same palette (when the
+    // video mode has less color depth), so conversion result is shared by
+    // its entries as well.
+    hash = tig_palette_hash(palette, tig_palette_size);
+    entry = tig_palette_pool_find(palette, hash);
+    if (entry != NULL) {
+        tig_palette_destroy(palette);
+        entry->refcount++;
+    } else {
+        tig_palette_pool_add(palette, hash);
+        tig_palette_destroy(palette);
+        entry = tig_palette_pool_buckets[hash % POOL_BUCKETS];
+    }
+
+    // Remember these colors, so that the next time they are looked up
+    // without conversion.
+    rgb_key = (TigPaletteRgbKey*)MALLOC(sizeof(*rgb_key));
+    memcpy(rgb_key->colors, colors, sizeof(*colors) * 256);
+    rgb_key->hash = rgb_hash;
+    rgb_key->entry = entry;
+    rgb_key->next = tig_palette_pool_rgb_buckets[rgb_hash % POOL_BUCKETS];
+    tig_palette_pool_rgb_buckets[rgb_hash % POOL_BUCKETS] = rgb_key;
+    rgb_key->sibling = entry->rgb_keys;
+    entry->rgb_keys = rgb_key;
+
+    return entry->palette;
+}
+
+void tig_palette_release(TigPalette palette)
+{
+    TigPalettePoolEntry* entry;
+    TigPalettePoolEntry** link;
+    TigPaletteRgbKey* rgb_key;
+    TigPaletteRgbKey** rgb_link;
+
+    entry = tig_palette_pool_find(palette, tig_palette_hash(palette, tig_palette_size));
+    if (entry == NULL || entry->palette != palette) {
+        tig_debug_println("Releasing palette which is not shared in tig_palette_release()\n");
+        return;
+    }
+
+    if (--entry->refcount > 0) {
+        return;
+    }
+
+    link = &(tig_palette_pool_buckets[entry->hash % POOL_BUCKETS]);
+    while (*link != entry) {
+        link = &((*link)->next);
+    }
+    *link = entry->next;
+
+    while (entry->rgb_keys != NULL) {
+        rgb_key = entry->rgb_keys;
+        entry->rgb_keys = rgb_key->sibling;
+
+        rgb_link = &(tig_palette_pool_rgb_buckets[rgb_key->hash % POOL_BUCKETS]);
+        while (*rgb_link != rgb_key) {
+            rgb_link = &((*rgb_link)->next);
+        }
+        *rgb_link = rgb_key->next;
+
+        FREE(rgb_key);
+    }
+
+    tig_palette_destroy(entry->palette);
+    FREE(entry);
+}
+
 // 0x534290
 size_t tig_palette_system_memory_size()
 {
@@ -216,6 +395,53 @@ void tig_palette_node_reserve()
     }
 }
 
+// FNV-1a.
+unsigned int tig_palette_hash(const void* data, size_t size)
+{
+    const unsigned char* bytes = (const unsigned char*)data;
+    unsigned int hash = 2166136261u;
+    size_t index;
+
+    for (index = 0; index < size; index++) {
+        hash ^= bytes[index];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+TigPalettePoolEntry* tig_palette_pool_find(TigPalette palette, unsigned int hash)
+{
+    TigPalettePoolEntry* entry;
+
+    for (entry = tig_palette_pool_buckets[hash % POOL_BUCKETS]; entry != NULL; entry = entry->next) {
+        if (entry->hash == hash
+            && memcmp(entry->palette, palette, tig_palette_size) == 0) {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+// Adds copy of the palette to the pool.
+TigPalette tig_palette_pool_add(TigPalette palette, unsigned int hash)
+{
+    TigPalettePoolEntry* entry;
+
+    entry = (TigPalettePoolEntry*)MALLOC(sizeof(*entry));
+    entry->palette = tig_palette_create();
+    entry->refcount = 1;
+    entry->hash = hash;
+    entry->rgb_keys = NULL;
+    tig_palette_copy(entry->palette, palette);
+
+    entry->next = tig_palette_pool_buckets[hash % POOL_BUCKETS];
+    tig_palette_pool_buckets[hash % POOL_BUCKETS] = entry;
+
+    return entry->palette;
+}
+
 // 0x5342E0
 void tig_palette_node_clear()
 {
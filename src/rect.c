@@ -740,3 +740,63 @@ int tig_line_bounding_box(const TigLine* line, TigRect* rect)
 
     return TIG_OK;
 }
+
+void tig_dirty_rects_init(TigDirtyRects* dirty_rects, const TigRect* bounds, int full_coverage)
+{
+    dirty_rects->bounds = *bounds;
+    dirty_rects->full_coverage = full_coverage;
+    tig_dirty_rects_clear(dirty_rects);
+}
+
+void tig_dirty_rects_add(TigDirtyRects* dirty_rects, const TigRect* rect)
+{
+    TigRect dirty_rect;
+    TigRect tmp_rect;
+    int index;
+
+    if (dirty_rects->full) {
+        return;
+    }
+
+    if (rect == NULL) {
+        dirty_rects->full = true;
+        return;
+    }
+
+    if (tig_rect_intersection(rect, &(dirty_rects->bounds), &dirty_rect) != TIG_OK) {
+        return;
+    }
+
+    // The union can overlap rects which were checked before, so the search
+    // starts over after every merge.
+    index = 0;
+    while (index < dirty_rects->count) {
+        if (tig_rect_intersection(&dirty_rect, &(dirty_rects->rects[index]), &tmp_rect) == TIG_OK) {
+            tig_rect_union(&dirty_rect, &(dirty_rects->rects[index]), &dirty_rect);
+            dirty_rects->area -= dirty_rects->rects[index].width * dirty_rects->rects[index].height;
+            dirty_rects->rects[index] = dirty_rects->rects[--dirty_rects->count];
+            index = 0;
+        } else {
+            index++;
+        }
+    }
+
+    if (dirty_rects->count == TIG_DIRTY_RECTS_MAX) {
+        dirty_rects->full = true;
+        return;
+    }
+
+    dirty_rects->rects[dirty_rects->count++] = dirty_rect;
+    dirty_rects->area += dirty_rect.width * dirty_rect.height;
+
+    if ((int64_t)dirty_rects->area * 100 > (int64_t)dirty_rects->bounds.width * dirty_rects->bounds.height * dirty_rects->full_coverage) {
+        dirty_rects->full = true;
+    }
+}
+
+void tig_dirty_rects_clear(TigDirtyRects* dirty_rects)
+{
+    dirty_rects->count = 0;
+    dirty_rects->area = 0;
+    dirty_rects->full = false;
+}
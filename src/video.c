@@ -15,6 +15,8 @@
 #include "tig/timer.h"
 #include "tig/window.h"
 
+#include "fixed.h"
+
 typedef struct TigVideoBuffer {
     TigVideoBufferFlags flags;
     TigRect frame;
@@ -39,11 +41,19 @@ typedef struct TigFadeState {
     SDL_Color color;
 } TigFadeState;
 
+// Dirty area of the main surface (in percents of its area) above which the
+// whole surface is uploaded, since it is cheaper than uploading many rects.
+#define TIG_VIDEO_DIRTY_FULL_COVERAGE 50
+
 static bool tig_video_window_create(TigInitInfo* init_info);
 static void tig_video_window_destroy();
 static bool sub_524830();
 static int tig_video_screenshot_make_internal(int key);
 static int tig_video_buffer_data_to_bmp(SDL_Surface* surface, TigRect* rect, const char* file_name);
+static int tig_video_buffer_blit_blend(TigVideoBufferBlitInfo* blit_info, TigRect* src_rect, TigRect* dst_rect);
+static unsigned int tig_video_buffer_blit_op(unsigned int flags);
+static void tig_video_buffer_blit_sample(int index, int ratio, int size, bool linear, int* index0_ptr, int* index1_ptr, int* weight_ptr);
+static void tig_video_buffer_blit_span(TigVideoBufferBlitInfo* blit_info, unsigned int op, uint32_t* dst, uint32_t* src, int n, int64_t alpha, int64_t alpha_step);
 
 // 0x5BF3D8
 static int tig_video_screenshot_key = -1;
@@ -80,6 +90,10 @@ static int dword_6103A4;
 
 static TigFadeState tig_fade_state;
 
+// Areas of the main surface changed since the last flip (see
+// `tig_video_invalidate`).
+static TigDirtyRects tig_video_dirty_rects;
+
 // 0x51F330
 int tig_video_init(TigInitInfo* init_info)
 {
@@ -110,6 +124,10 @@ int tig_video_init(TigInitInfo* init_info)
     tig_video_screenshot_key = -1;
     dword_6103A4 = 0;
 
+    // Texture content is undefined until the first upload.
+    tig_dirty_rects_init(&tig_video_dirty_rects, &stru_610388, TIG_VIDEO_DIRTY_FULL_COVERAGE);
+    tig_dirty_rects_add(&tig_video_dirty_rects, NULL);
+
     tig_video_initialized = true;
 
     return TIG_OK;
@@ -202,6 +220,8 @@ int tig_video_blit(TigVideoBuffer* src_video_buffer, TigRect* src_rect, TigRect*
         tig_video_state.surface,
         &native_dst_rect);
 
+    tig_video_invalidate(&clamped_dst_rect);
+
     return TIG_OK;
 }
 
@@ -232,14 +252,43 @@ int tig_video_fill(const TigRect* rect, tig_color_t color)
         return TIG_ERR_GENERIC;
     }
 
+    tig_video_invalidate(&clamped_rect);
+
     return TIG_OK;
 }
 
+void tig_video_invalidate(const TigRect* rect)
+{
+    tig_dirty_rects_add(&tig_video_dirty_rects, rect);
+}
+
 // 0x51F8F0
 int tig_video_flip()
 {
-    SDL_UpdateTexture(tig_video_state.texture, NULL, tig_video_state.surface->pixels, tig_video_state.surface->pitch);
+    SDL_Rect native_rect;
+    TigRect* rect;
+    int index;
 
+    // Only changed areas of the main surface are uploaded, the texture keeps
+    // the rest from previous flips.
+    if (tig_video_dirty_rects.full) {
+        SDL_UpdateTexture(tig_video_state.texture, NULL, tig_video_state.surface->pixels, tig_video_state.surface->pitch);
+    } else {
+        for (index = 0; index < tig_video_dirty_rects.count; index++) {
+            rect = &(tig_video_dirty_rects.rects[index]);
+            native_rect.x = rect->x;
+            native_rect.y = rect->y;
+            native_rect.w = rect->width;
+            native_rect.h = rect->height;
+
+            SDL_UpdateTexture(tig_video_state.texture,
+                &native_rect,
+                (uint8_t*)tig_video_state.surface->pixels + tig_video_state.surface->pitch * rect->y + SDL_BYTESPERPIXEL(tig_video_state.surface->format) * rect->x,
+                tig_video_state.surface->pitch);
+        }
+    }
+
+    tig_dirty_rects_clear(&tig_video_dirty_rects);
     SDL_RenderClear(tig_video_state.renderer);
     SDL_RenderTexture(tig_video_state.renderer, tig_video_state.texture, NULL, NULL);
 
@@ -490,6 +539,66 @@ int tig_video_buffer_create(TigVideoBufferCreateInfo* vb_create_info, TigVideoBu
     return TIG_OK;
 }
 
+// Creates video buffer which shares pixels of `parent` video buffer, its
+// top-left corner is at `x`, `y` of `parent`. Size, color key and background
+// color are taken from `vb_create_info`, memory type flags are ignored.
+//
+// The view must be destroyed before `parent`.
+int tig_video_buffer_create_view(TigVideoBufferCreateInfo* vb_create_info, TigVideoBuffer* parent, int x, int y, TigVideoBuffer** video_buffer_ptr)
+{
+    TigVideoBuffer* video_buffer;
+    uint8_t* pixels;
+
+    if (x < 0
+        || y < 0
+        || vb_create_info->width <= 0
+        || vb_create_info->height <= 0
+        || x + vb_create_info->width > parent->frame.width
+        || y + vb_create_info->height > parent->frame.height) {
+        return TIG_ERR_INVALID_PARAM;
+    }
+
+    video_buffer = (TigVideoBuffer*)MALLOC(sizeof(*video_buffer));
+    memset(video_buffer, 0, sizeof(*video_buffer));
+
+    pixels = (uint8_t*)parent->surface->pixels
+        + parent->surface->pitch * y
+        + SDL_BYTESPERPIXEL(parent->surface->format) * x;
+
+    video_buffer->surface = SDL_CreateSurfaceFrom(vb_create_info->width,
+        vb_create_info->height,
+        parent->surface->format,
+        pixels,
+        parent->surface->pitch);
+    if (video_buffer->surface == NULL) {
+        FREE(video_buffer);
+        return TIG_ERR_OUT_OF_MEMORY;
+    }
+
+    *video_buffer_ptr = video_buffer;
+
+    video_buffer->flags |= TIG_VIDEO_BUFFER_SYSTEM_MEMORY;
+
+    if ((vb_create_info->flags & TIG_VIDEO_BUFFER_CREATE_COLOR_KEY) != 0) {
+        video_buffer->flags |= TIG_VIDEO_BUFFER_COLOR_KEY;
+        tig_video_buffer_set_color_key(video_buffer, vb_create_info->color_key);
+    }
+
+    video_buffer->frame.x = 0;
+    video_buffer->frame.y = 0;
+    video_buffer->frame.width = vb_create_info->width;
+    video_buffer->frame.height = vb_create_info->height;
+    video_buffer->texture_width = vb_create_info->width;
+    video_buffer->texture_height = vb_create_info->height;
+    video_buffer->background_color = vb_create_info->background_color;
+
+    SDL_FillSurfaceRect(video_buffer->surface, NULL, vb_create_info->background_color);
+
+    video_buffer->lock_count = 0;
+
+    return TIG_OK;
+}
+
 // 0x520390
 int tig_video_buffer_destroy(TigVideoBuffer* video_buffer)
 {
@@ -827,21 +936,18 @@ int tig_video_buffer_line(TigVideoBuffer* video_buffer, TigLine* line, TigRect*
 // 0x520FB0
 int sub_520FB0(TigVideoBuffer* video_buffer, unsigned int flags)
 {
-    TigVideoBufferData data;
-
     if (flags == 0) {
         return TIG_OK;
     }
 
-    if (!tig_video_3d_initialized) {
+    // Blends used to require Direct3D render target, now they are done in
+    // software on any video buffer.
+    if ((flags & TIG_VIDEO_BUFFER_BLIT_BLEND_COLOR_LERP) != 0) {
         return TIG_ERR_GENERIC;
     }
 
-    if (tig_video_buffer_data(video_buffer, &data) != TIG_OK) {
-        return TIG_ERR_GENERIC;
-    }
-
-    if ((data.flags & TIG_VIDEO_BUFFER_RENDER_TARGET) == 0) {
+    // Software blends are 32-bit only.
+    if (SDL_BYTESPERPIXEL(video_buffer->surface->format) != 4) {
         return TIG_ERR_GENERIC;
     }
 
@@ -852,28 +958,35 @@ int sub_520FB0(TigVideoBuffer* video_buffer, unsigned int flags)
 int tig_video_buffer_blit(TigVideoBufferBlitInfo* blit_info)
 {
     bool stretched;
-    float width_ratio;
-    float height_ratio;
+    int width_ratio;
+    int height_ratio;
     TigRect bounds;
     TigRect blit_src_rect;
     TigRect blit_dst_rect;
     TigRect tmp_rect;
     SDL_Rect native_src_rect;
     SDL_Rect native_dst_rect;
+    SDL_ScaleMode scale_mode;
     int rc;
 
+    if ((blit_info->flags & TIG_VIDEO_BUFFER_BLIT_BLEND_COLOR_LERP) != 0) {
+        return TIG_ERR_INVALID_PARAM;
+    }
+
     if (blit_info->src_rect->width == blit_info->dst_rect->width
         && blit_info->src_rect->height == blit_info->dst_rect->height) {
         stretched = false;
 
         // NOTE: Original code does not initialize these values, but we have
         // to keep compiler happy.
-        width_ratio = 1;
-        height_ratio = 1;
+        width_ratio = TIG_FIXED_ONE;
+        height_ratio = TIG_FIXED_ONE;
     } else {
         stretched = true;
-        width_ratio = (float)blit_info->src_rect->width / (float)blit_info->dst_rect->width;
-        height_ratio = (float)blit_info->src_rect->height / (float)blit_info->dst_rect->height;
+
+        // 16.16 fixed-point source to destination ratios.
+        width_ratio = tig_fixed_ratio(blit_info->src_rect->width, blit_info->dst_rect->width);
+        height_ratio = tig_fixed_ratio(blit_info->src_rect->height, blit_info->dst_rect->height);
     }
 
     bounds.x = 0;
@@ -891,10 +1004,10 @@ int tig_video_buffer_blit(TigVideoBufferBlitInfo* blit_info)
     tmp_rect = *blit_info->dst_rect;
 
     if (stretched) {
-        tmp_rect.x += (int)((float)(blit_src_rect.x - blit_info->src_rect->x) / width_ratio);
-        tmp_rect.y += (int)((float)(blit_src_rect.y - blit_info->src_rect->y) / height_ratio);
-        tmp_rect.width -= (int)((float)(blit_info->src_rect->width - blit_src_rect.width) / width_ratio);
-        tmp_rect.height -= (int)((float)(blit_info->src_rect->height - blit_src_rect.height) / height_ratio);
+        tmp_rect.x += tig_fixed_div(blit_src_rect.x - blit_info->src_rect->x, width_ratio);
+        tmp_rect.y += tig_fixed_div(blit_src_rect.y - blit_info->src_rect->y, height_ratio);
+        tmp_rect.width -= tig_fixed_div(blit_info->src_rect->width - blit_src_rect.width, width_ratio);
+        tmp_rect.height -= tig_fixed_div(blit_info->src_rect->height - blit_src_rect.height, height_ratio);
     } else {
         tmp_rect.x += blit_src_rect.x - blit_info->src_rect->x;
         tmp_rect.y += blit_src_rect.y - blit_info->src_rect->y;
@@ -914,11 +1027,17 @@ int tig_video_buffer_blit(TigVideoBufferBlitInfo* blit_info)
         return TIG_OK;
     }
 
+    // Flipping does not affect clipping, source rect is relative to mirrored
+    // source video buffer which has the same bounds.
+    if ((blit_info->flags & (TIG_VIDEO_BUFFER_BLIT_FLIP_ANY | TIG_VIDEO_BUFFER_BLIT_BLEND_ANY)) != 0) {
+        return tig_video_buffer_blit_blend(blit_info, &blit_src_rect, &blit_dst_rect);
+    }
+
     if (stretched) {
-        blit_src_rect.x += (int)((float)(blit_dst_rect.x - tmp_rect.x) / width_ratio);
-        blit_src_rect.y += (int)((float)(blit_dst_rect.y - tmp_rect.y) / height_ratio);
-        blit_src_rect.width -= (int)((float)(tmp_rect.width - blit_dst_rect.width) / width_ratio);
-        blit_src_rect.height -= (int)((float)(tmp_rect.height - blit_dst_rect.height) / height_ratio);
+        blit_src_rect.x += tig_fixed_div(blit_dst_rect.x - tmp_rect.x, width_ratio);
+        blit_src_rect.y += tig_fixed_div(blit_dst_rect.y - tmp_rect.y, height_ratio);
+        blit_src_rect.width -= tig_fixed_div(tmp_rect.width - blit_dst_rect.width, width_ratio);
+        blit_src_rect.height -= tig_fixed_div(tmp_rect.height - blit_dst_rect.height, height_ratio);
     } else {
         blit_src_rect.x += blit_dst_rect.x - tmp_rect.x;
         blit_src_rect.y += blit_dst_rect.y - tmp_rect.y;
@@ -937,7 +1056,10 @@ int tig_video_buffer_blit(TigVideoBufferBlitInfo* blit_info)
     native_dst_rect.h = blit_dst_rect.height;
 
     if (stretched) {
-        if (!SDL_BlitSurfaceScaled(blit_info->src_video_buffer->surface, &native_src_rect, blit_info->dst_video_buffer->surface, &native_dst_rect, SDL_SCALEMODE_NEAREST)) {
+        scale_mode = (blit_info->flags & TIG_VIDEO_BUFFER_BLIT_SCALE_LINEAR) != 0
+            ? SDL_SCALEMODE_LINEAR
+            : SDL_SCALEMODE_NEAREST;
+        if (!SDL_BlitSurfaceScaled(blit_info->src_video_buffer->surface, &native_src_rect, blit_info->dst_video_buffer->surface, &native_dst_rect, scale_mode)) {
             return TIG_ERR_GENERIC;
         }
     } else {
@@ -949,6 +1071,292 @@ int tig_video_buffer_blit(TigVideoBufferBlitInfo* blit_info)
     return TIG_OK;
 }
 
+// Blits source video buffer into clipped `dst_rect` of destination video
+// buffer with flipping and blending (see `tig_video_buffer_blit`). The
+// `src_rect` is source rect clipped to source video buffer bounds.
+//
+// Rows are processed in chunks of up to 256 pixels: source colors are
+// gathered into a chunk (which takes care of flipping and scaling), and
+// spans of opaque colors are blended into destination by batch color
+// operators.
+int tig_video_buffer_blit_blend(TigVideoBufferBlitInfo* blit_info, TigRect* src_rect, TigRect* dst_rect)
+{
+    TigVideoBuffer* src_video_buffer = blit_info->src_video_buffer;
+    TigVideoBuffer* dst_video_buffer = blit_info->dst_video_buffer;
+    unsigned int op;
+    bool color_key;
+    bool linear;
+    int width_ratio;
+    int height_ratio;
+    int col_offset;
+    int row_offset;
+    uint32_t* src_pixels;
+    int src_pitch;
+    uint32_t* dst_pixels;
+    int dst_pitch;
+    uint32_t* src_row0;
+    uint32_t* src_row1;
+    uint32_t* dst;
+    int row0;
+    int row1;
+    int row_weight;
+    int col0;
+    int col1;
+    int col_weight;
+    int64_t left_alpha;
+    int64_t right_alpha;
+    int64_t alpha;
+    int64_t alpha_step;
+    uint32_t colors[256];
+    int x;
+    int y;
+    int n;
+    int index;
+    int start;
+    int end;
+    int rc;
+
+    if (SDL_BYTESPERPIXEL(blit_info->src_video_buffer->surface->format) != 4
+        || SDL_BYTESPERPIXEL(blit_info->dst_video_buffer->surface->format) != 4) {
+        return TIG_ERR_GENERIC;
+    }
+
+    op = tig_video_buffer_blit_op(blit_info->flags);
+
+    // Destination pixels are mapped to source pixels using unclipped rects,
+    // so that clipping does not shift stretched source. Source pixels are
+    // kept inside clipped source rect, since clipped destination rect of
+    // stretched blit can be off by a pixel due to rounding.
+    width_ratio = tig_fixed_ratio(blit_info->src_rect->width, blit_info->dst_rect->width);
+    height_ratio = tig_fixed_ratio(blit_info->src_rect->height, blit_info->dst_rect->height);
+    col_offset = dst_rect->x - blit_info->dst_rect->x;
+    row_offset = dst_rect->y - blit_info->dst_rect->y;
+
+    // Filtering color keyed source would bleed color key into opaque pixels.
+    color_key = (src_video_buffer->flags & TIG_VIDEO_BUFFER_COLOR_KEY) != 0;
+    linear = (blit_info->flags & TIG_VIDEO_BUFFER_BLIT_SCALE_LINEAR) != 0
+        && !color_key
+        && (width_ratio != TIG_FIXED_ONE || height_ratio != TIG_FIXED_ONE);
+
+    rc = tig_video_buffer_lock(src_video_buffer);
+    if (rc != TIG_OK) {
+        return rc;
+    }
+
+    rc = tig_video_buffer_lock(dst_video_buffer);
+    if (rc != TIG_OK) {
+        tig_video_buffer_unlock(src_video_buffer);
+        return rc;
+    }
+
+    src_pixels = (uint32_t*)src_video_buffer->surface->pixels;
+    src_pitch = src_video_buffer->surface->pitch / 4;
+    dst_pixels = (uint32_t*)dst_video_buffer->surface->pixels;
+    dst_pitch = dst_video_buffer->surface->pitch / 4;
+
+    alpha = 0;
+    alpha_step = 0;
+
+    for (y = 0; y < dst_rect->height; y++) {
+        tig_video_buffer_blit_sample(row_offset + y, height_ratio, blit_info->src_rect->height, linear, &row0, &row1, &row_weight);
+        row0 = SDL_clamp(blit_info->src_rect->y + row0, src_rect->y, src_rect->y + src_rect->height - 1);
+        row1 = SDL_clamp(blit_info->src_rect->y + row1, src_rect->y, src_rect->y + src_rect->height - 1);
+
+        if ((blit_info->flags & TIG_VIDEO_BUFFER_BLIT_FLIP_Y) != 0) {
+            row0 = src_video_buffer->frame.height - row0 - 1;
+            row1 = src_video_buffer->frame.height - row1 - 1;
+        }
+
+        src_row0 = src_pixels + src_pitch * row0;
+        src_row1 = src_pixels + src_pitch * row1;
+        dst = dst_pixels + dst_pitch * (dst_rect->y + y) + dst_rect->x;
+
+        // Alpha is interpolated across unclipped destination rect, first
+        // between corners along left and right edges, then along the row.
+        if (op == TIG_VIDEO_BUFFER_BLIT_BLEND_ALPHA_LERP) {
+            index = row_offset + y;
+            left_alpha = ((int64_t)blit_info->alpha[0] << 16)
+                + (((int64_t)(blit_info->alpha[3] - blit_info->alpha[0]) << 16) * index) / blit_info->dst_rect->height;
+            right_alpha = ((int64_t)blit_info->alpha[1] << 16)
+                + (((int64_t)(blit_info->alpha[2] - blit_info->alpha[1]) << 16) * index) / blit_info->dst_rect->height;
+            alpha_step = (right_alpha - left_alpha) / blit_info->dst_rect->width;
+            alpha = left_alpha + alpha_step * col_offset;
+        }
+
+        for (x = 0; x < dst_rect->width; x += n) {
+            n = SDL_min(dst_rect->width - x, 256);
+
+            if (linear) {
+                for (index = 0; index < n; index++) {
+                    tig_video_buffer_blit_sample(col_offset + x + index, width_ratio, blit_info->src_rect->width, true, &col0, &col1, &col_weight);
+                    col0 = SDL_clamp(blit_info->src_rect->x + col0, src_rect->x, src_rect->x + src_rect->width - 1);
+                    col1 = SDL_clamp(blit_info->src_rect->x + col1, src_rect->x, src_rect->x + src_rect->width - 1);
+
+                    if ((blit_info->flags & TIG_VIDEO_BUFFER_BLIT_FLIP_X) != 0) {
+                        col0 = src_video_buffer->frame.width - col0 - 1;
+                        col1 = src_video_buffer->frame.width - col1 - 1;
+                    }
+
+                    colors[index] = tig_color_blend_alpha(
+                        tig_color_blend_alpha(src_row1[col1], src_row1[col0], col_weight),
+                        tig_color_blend_alpha(src_row0[col1], src_row0[col0], col_weight),
+                        row_weight);
+                }
+            } else if (width_ratio == TIG_FIXED_ONE
+                && (blit_info->flags & TIG_VIDEO_BUFFER_BLIT_FLIP_X) == 0) {
+                memcpy(colors, src_row0 + blit_info->src_rect->x + col_offset + x, sizeof(*colors) * n);
+            } else {
+                for (index = 0; index < n; index++) {
+                    tig_video_buffer_blit_sample(col_offset + x + index, width_ratio, blit_info->src_rect->width, false, &col0, &col1, &col_weight);
+                    col0 = SDL_clamp(blit_info->src_rect->x + col0, src_rect->x, src_rect->x + src_rect->width - 1);
+
+                    if ((blit_info->flags & TIG_VIDEO_BUFFER_BLIT_FLIP_X) != 0) {
+                        col0 = src_video_buffer->frame.width - col0 - 1;
+                    }
+
+                    colors[index] = src_row0[col0];
+                }
+            }
+
+            if (color_key) {
+                start = 0;
+                while (start < n) {
+                    while (start < n && colors[start] == src_video_buffer->color_key) {
+                        start++;
+                    }
+
+                    end = start;
+                    while (end < n && colors[end] != src_video_buffer->color_key) {
+                        end++;
+                    }
+
+                    if (start < end) {
+                        tig_video_buffer_blit_span(blit_info, op, dst + x + start, colors + start, end - start, alpha + alpha_step * (x + start), alpha_step);
+                    }
+
+                    start = end;
+                }
+            } else {
+                tig_video_buffer_blit_span(blit_info, op, dst + x, colors, n, alpha + alpha_step * x, alpha_step);
+            }
+        }
+    }
+
+    tig_video_buffer_unlock(dst_video_buffer);
+    tig_video_buffer_unlock(src_video_buffer);
+
+    return TIG_OK;
+}
+
+// Resolves blending flags into single blend operation, when several are set
+// the first one in the order below wins (like in art blits). Returns `0` for
+// plain copy.
+unsigned int tig_video_buffer_blit_op(unsigned int flags)
+{
+    static const unsigned int ops[] = {
+        TIG_VIDEO_BUFFER_BLIT_BLEND_ADD,
+        TIG_VIDEO_BUFFER_BLIT_BLEND_SUB,
+        TIG_VIDEO_BUFFER_BLIT_BLEND_MUL,
+        TIG_VIDEO_BUFFER_BLIT_BLEND_ALPHA_AVG,
+        TIG_VIDEO_BUFFER_BLIT_BLEND_ALPHA_CONST,
+        TIG_VIDEO_BUFFER_BLIT_BLEND_ALPHA_SRC,
+        TIG_VIDEO_BUFFER_BLIT_BLEND_ALPHA_LERP,
+    };
+    size_t index;
+
+    for (index = 0; index < SDL_arraysize(ops); index++) {
+        if ((flags & ops[index]) != 0) {
+            return ops[index];
+        }
+    }
+
+    return 0;
+}
+
+// Maps destination pixel `index` to source pixel (relative to source rect of
+// `size` pixels) with 16.16 fixed-point source to destination `ratio`. When
+// `linear` is set the sample falls between two source pixels, `weight` (0-255)
+// is the amount of the second one.
+void tig_video_buffer_blit_sample(int index, int ratio, int size, bool linear, int* index0_ptr, int* index1_ptr, int* weight_ptr)
+{
+    int64_t pos;
+
+    // Samples are taken at pixel centers.
+    pos = (int64_t)index * ratio + ratio / 2;
+
+    if (linear) {
+        pos -= 0x8000;
+        if (pos < 0) {
+            pos = 0;
+        }
+    }
+
+    *index0_ptr = (int)(pos >> 16);
+    *weight_ptr = linear ? (int)((pos >> 8) & 0xFF) : 0;
+
+    if (*index0_ptr >= size - 1) {
+        *index0_ptr = size - 1;
+        *weight_ptr = 0;
+    }
+
+    *index1_ptr = *weight_ptr != 0 ? *index0_ptr + 1 : *index0_ptr;
+}
+
+// Blends `n` source colors into destination. Source colors are modulated in
+// place. With `TIG_VIDEO_BUFFER_BLIT_BLEND_ALPHA_LERP` 16.16 fixed-point
+// `alpha` of the first pixel is advanced by `alpha_step` every pixel.
+void tig_video_buffer_blit_span(TigVideoBufferBlitInfo* blit_info, unsigned int op, uint32_t* dst, uint32_t* src, int n, int64_t alpha, int64_t alpha_step)
+{
+    int index;
+
+    if ((blit_info->flags & TIG_VIDEO_BUFFER_BLIT_BLEND_COLOR_CONST) != 0
+        && op != TIG_VIDEO_BUFFER_BLIT_BLEND_ALPHA_SRC) {
+        for (index = 0; index < n; index++) {
+            src[index] = tig_color_mul(src[index], (tig_color_t)blit_info->field_10);
+        }
+    }
+
+    switch (op) {
+    case TIG_VIDEO_BUFFER_BLIT_BLEND_ADD:
+        tig_color_add_n(dst, src, n);
+        break;
+    case TIG_VIDEO_BUFFER_BLIT_BLEND_SUB:
+        tig_color_sub_n(dst, src, n);
+        break;
+    case TIG_VIDEO_BUFFER_BLIT_BLEND_MUL:
+        tig_color_mul_n(dst, src, n);
+        break;
+    case TIG_VIDEO_BUFFER_BLIT_BLEND_ALPHA_AVG:
+        for (index = 0; index < n; index++) {
+            dst[index] = tig_color_blend_alpha(src[index], dst[index], tig_color_rgb_to_grayscale(src[index]));
+        }
+        break;
+    case TIG_VIDEO_BUFFER_BLIT_BLEND_ALPHA_CONST:
+        tig_color_blend_alpha_n(dst, src, blit_info->alpha[0], n);
+        break;
+    case TIG_VIDEO_BUFFER_BLIT_BLEND_ALPHA_SRC:
+        if ((blit_info->flags & TIG_VIDEO_BUFFER_BLIT_BLEND_COLOR_CONST) != 0) {
+            for (index = 0; index < n; index++) {
+                dst[index] = tig_color_blend_alpha((tig_color_t)blit_info->field_10, dst[index], tig_color_alpha(src[index]));
+            }
+        } else {
+            for (index = 0; index < n; index++) {
+                dst[index] = tig_color_blend_alpha(src[index], dst[index], tig_color_alpha(src[index]));
+            }
+        }
+        break;
+    case TIG_VIDEO_BUFFER_BLIT_BLEND_ALPHA_LERP:
+        for (index = 0; index < n; index++) {
+            dst[index] = tig_color_blend_alpha(src[index], dst[index], (int)(alpha >> 16));
+            alpha += alpha_step;
+        }
+        break;
+    default:
+        memcpy(dst, src, sizeof(*dst) * n);
+        break;
+    }
+}
+
 // 0x522F30
 int tig_video_buffer_get_pixel_color(TigVideoBuffer* video_buffer, int x, int y, unsigned int* color)
 {
@@ -986,6 +1394,8 @@ int tig_video_buffer_tint(TigVideoBuffer* video_buffer, TigRect* rect, tig_color
     TigRect frame;
     int x;
     int y;
+    tig_color_t tint_colors[256];
+    int n;
 
     if (mode >= TIG_VIDEO_BUFFER_TINT_MODE_COUNT) {
         return TIG_ERR_INVALID_PARAM;
@@ -1006,6 +1416,11 @@ int tig_video_buffer_tint(TigVideoBuffer* video_buffer, TigRect* rect, tig_color
         return rc;
     }
 
+    // Rows are tinted with batch color operators in chunks.
+    for (n = 0; n < 256; n++) {
+        tint_colors[n] = tint_color;
+    }
+
     for (y = 0; y < frame.height; ++y) {
         switch (tig_video_bpp) {
         case 32:
@@ -1015,21 +1430,21 @@ int tig_video_buffer_tint(TigVideoBuffer* video_buffer, TigRect* rect, tig_color
 
                 switch (mode) {
                 case TIG_VIDEO_BUFFER_TINT_MODE_ADD:
-                    for (x = 0; x < frame.width; ++x) {
-                        src_color = *dst;
-                        *dst++ = tig_color_add(tint_color, src_color);
+                    for (x = 0; x < frame.width; x += n) {
+                        n = SDL_min(frame.width - x, 256);
+                        tig_color_add_n(dst + x, tint_colors, n);
                     }
                     break;
                 case TIG_VIDEO_BUFFER_TINT_MODE_SUB:
-                    for (x = 0; x < frame.width; ++x) {
-                        src_color = *dst;
-                        *dst++ = tig_color_sub(tint_color, src_color);
+                    for (x = 0; x < frame.width; x += n) {
+                        n = SDL_min(frame.width - x, 256);
+                        tig_color_sub_n(dst + x, tint_colors, n);
                     }
                     break;
                 case TIG_VIDEO_BUFFER_TINT_MODE_MUL:
-                    for (x = 0; x < frame.width; ++x) {
-                        src_color = *dst;
-                        *dst++ = tig_color_mul(tint_color, src_color);
+                    for (x = 0; x < frame.width; x += n) {
+                        n = SDL_min(frame.width - x, 256);
+                        tig_color_mul_n(dst + x, tint_colors, n);
                     }
                     break;
                 case TIG_VIDEO_BUFFER_TINT_MODE_GRAYSCALE:
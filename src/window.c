@@ -841,6 +841,8 @@ int tig_window_blit_art(tig_window_handle_t window_handle, TigArtBlitInfo* blit_
     int window_index;
     int rc;
     TigRect rect;
+    TigRect src_rect;
+    TigArtFrameData art_frame_data;
 
     if (window_handle == TIG_WINDOW_HANDLE_INVALID) {
         tig_debug_printf("tig_window_blit_art: ERROR: Attempt to reference Empty WinID!\n");
@@ -858,6 +860,27 @@ int tig_window_blit_art(tig_window_handle_t window_handle, TigArtBlitInfo* blit_
     }
 
     rect = *(blit_info->dst_rect);
+
+    // Unstretched blit does not touch pixels outside of non-transparent area
+    // of the frame, there is no need to invalidate them.
+    if (blit_info->src_rect->width == blit_info->dst_rect->width
+        && blit_info->src_rect->height == blit_info->dst_rect->height
+        && (blit_info->flags & TIG_ART_BLT_FLIP_Y) == 0
+        && tig_art_frame_data(blit_info->art_id, &art_frame_data) == TIG_OK) {
+        if ((blit_info->flags & TIG_ART_BLT_FLIP_X) != 0) {
+            art_frame_data.bounds.x = art_frame_data.width - art_frame_data.bounds.x - art_frame_data.bounds.width;
+        }
+
+        if (tig_rect_intersection(blit_info->src_rect, &(art_frame_data.bounds), &src_rect) != TIG_OK) {
+            return rc;
+        }
+
+        rect.x += src_rect.x - blit_info->src_rect->x;
+        rect.y += src_rect.y - blit_info->src_rect->y;
+        rect.width = src_rect.width;
+        rect.height = src_rect.height;
+    }
+
     rect.x += win->frame.x;
     rect.y += win->frame.y;
 
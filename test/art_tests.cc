@@ -1,7 +1,18 @@
 #include "tig/art.h"
 
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
 #include <gtest/gtest.h>
 
+#include "tig/color.h"
+#include "tig/memory.h"
+#include "tig/palette.h"
+#include "tig/video.h"
+
 TEST(TigArtIdTest, MiscIdCreate)
 {
     tig_art_id_t art_id;
@@ -41,3 +52,844 @@ TEST(TigArtIdTest, LightIdCreate)
     EXPECT_EQ(tig_art_light_id_create(6, 0, 0, 1, &art_id), TIG_OK);
     EXPECT_EQ(art_id, 0x90300001);
 }
+
+TEST(TigArtInitTest, InvalidCacheBudgets)
+{
+    TigInitInfo init_info = {};
+    int budgets[TIG_ART_TYPE_COUNT] = { 0 };
+
+    init_info.bpp = 32;
+    init_info.art_cache_budgets = budgets;
+
+    budgets[TIG_ART_TYPE_TILE] = 101;
+    EXPECT_EQ(tig_art_init(&init_info), TIG_ERR_INVALID_PARAM);
+
+    budgets[TIG_ART_TYPE_TILE] = -1;
+    EXPECT_EQ(tig_art_init(&init_info), TIG_ERR_INVALID_PARAM);
+
+    budgets[TIG_ART_TYPE_TILE] = 60;
+    budgets[TIG_ART_TYPE_CRITTER] = 50;
+    EXPECT_EQ(tig_art_init(&init_info), TIG_ERR_INVALID_PARAM);
+}
+
+// Pixel index of the specified frame pixel of test art.
+typedef uint8_t(TigArtTestPixelFunc)(int frame, int x, int y);
+
+// Color of the specified palette index of test art.
+typedef uint32_t(TigArtTestColorFunc)(int index);
+
+class TigArtCacheTest : public testing::Test {
+protected:
+    void SetUp() override
+    {
+        TigInitInfo init_info = {};
+        init_info.bpp = 32;
+
+        ASSERT_EQ(tig_color_init(&init_info), TIG_OK);
+        ASSERT_EQ(tig_color_set_rgb_settings(0xFF0000, 0xFF00, 0xFF), TIG_OK);
+        ASSERT_EQ(tig_palette_init(&init_info), TIG_OK);
+
+        init(0);
+        tig_art_cache_set_palette_indirect(false);
+    }
+
+    void TearDown() override
+    {
+        tig_art_exit();
+        tig_palette_exit();
+        tig_color_exit();
+
+        for (const std::string& path : paths) {
+            remove(path.c_str());
+        }
+
+        ASSERT_TRUE(tig_memory_validate_memory_leaks());
+    }
+
+    // (Re)initializes art cache with the specified size (see
+    // `TigInitInfo::art_cache_size`) and art id reset function.
+    void init(unsigned int art_cache_size, TigArtIdResetFunc* art_id_reset_func = reset_id)
+    {
+        TigInitInfo init_info = {};
+        init_info.bpp = 32;
+        init_info.art_file_path_resolver = resolve_path;
+        init_info.art_id_reset_func = art_id_reset_func;
+        init_info.art_cache_size = art_cache_size;
+
+        tig_art_exit();
+        ASSERT_EQ(tig_art_init(&init_info), TIG_OK);
+    }
+
+    // Writes single rotation interface art with uncompressed frames.
+    void write_art(unsigned int num, int num_frames, int width, int height, TigArtTestPixelFunc* pixel, TigArtTestColorFunc* palette = color)
+    {
+        char path[TIG_MAX_PATH];
+        resolve_path(interface_id(num), path);
+
+        FILE* stream = fopen(path, "wb");
+        ASSERT_NE(stream, nullptr);
+        paths.push_back(path);
+
+        // Flags (single rotation), fps, bpp, palettes, action frame and
+        // number of frames, followed by in-memory tables.
+        int hdr[33] = { 0 };
+        hdr[0] = 1;
+        hdr[1] = 10;
+        hdr[2] = 8;
+        hdr[3] = 1;
+        hdr[8] = num_frames;
+        fwrite(hdr, sizeof(*hdr), 33, stream);
+
+        uint32_t colors[256];
+        for (int index = 0; index < 256; index++) {
+            colors[index] = palette(index);
+        }
+        fwrite(colors, sizeof(*colors), 256, stream);
+
+        for (int frame = 0; frame < num_frames; frame++) {
+            int frm[7] = { width, height, width * height, width / 2, height - 1, 0, 0 };
+            fwrite(frm, sizeof(*frm), 7, stream);
+        }
+
+        for (int frame = 0; frame < num_frames; frame++) {
+            for (int y = 0; y < height; y++) {
+                for (int x = 0; x < width; x++) {
+                    uint8_t value = pixel(frame, x, y);
+                    fwrite(&value, 1, 1, stream);
+                }
+            }
+        }
+
+        fclose(stream);
+    }
+
+    // Color of pixel index in palette of test art.
+    static uint32_t color(int index)
+    {
+        return (index << 16) | ((255 - index) << 8) | (index / 2);
+    }
+
+    static tig_art_id_t interface_id(unsigned int num, unsigned int frame = 0, unsigned int palette = 0)
+    {
+        tig_art_id_t art_id;
+        EXPECT_EQ(tig_art_interface_id_create(num, frame, 0, palette, &art_id), TIG_OK);
+        return art_id;
+    }
+
+    static int resolve_path(tig_art_id_t art_id, char* path)
+    {
+        snprintf(path, TIG_MAX_PATH, "%stig_art_test_%u.art", testing::TempDir().c_str(), tig_art_num_get(art_id));
+        return TIG_OK;
+    }
+
+    static tig_art_id_t reset_id(tig_art_id_t art_id)
+    {
+        return tig_art_id_frame_set(art_id, 0);
+    }
+
+    // Loads art so that all previously loaded art is evicted.
+    void evict_all(unsigned int first_num, int count)
+    {
+        for (int index = 0; index < count; index++) {
+            write_art(first_num + index, 4, 64, 64, [](int frame, int x, int y) -> uint8_t {
+                return (uint8_t)((x + y + frame) % 7);
+            });
+            TigArtAnimData anim_data;
+            ASSERT_EQ(tig_art_anim_data(interface_id(first_num + index), &anim_data), TIG_OK);
+        }
+    }
+
+    // Interface art which is blitted through frame video buffers (see
+    // `TigArtCacheStats::atlases`).
+    static tig_art_id_t buffered_interface_id(unsigned int num, unsigned int frame = 0)
+    {
+        tig_art_id_t art_id;
+        EXPECT_EQ(tig_art_interface_id_create(num, frame, 1, 0, &art_id), TIG_OK);
+        return art_id;
+    }
+
+    static TigVideoBuffer* create_video_buffer(int width, int height)
+    {
+        TigVideoBufferCreateInfo vb_create_info = {};
+        vb_create_info.flags = TIG_VIDEO_BUFFER_CREATE_SYSTEM_MEMORY;
+        vb_create_info.width = width;
+        vb_create_info.height = height;
+
+        TigVideoBuffer* video_buffer = nullptr;
+        EXPECT_EQ(tig_video_buffer_create(&vb_create_info, &video_buffer), TIG_OK);
+        return video_buffer;
+    }
+
+    // Blits entire frame of the art to `x`, `y` of the video buffer.
+    static int blit(TigVideoBuffer* video_buffer, tig_art_id_t art_id, int x, int y)
+    {
+        TigArtFrameData frame_data;
+        int rc = tig_art_frame_data(art_id, &frame_data);
+        if (rc != TIG_OK) {
+            return rc;
+        }
+
+        TigRect src_rect = { 0, 0, frame_data.width, frame_data.height };
+        TigRect dst_rect = { x, y, frame_data.width, frame_data.height };
+
+        TigArtBlitInfo blit_info = {};
+        blit_info.art_id = art_id;
+        blit_info.src_rect = &src_rect;
+        blit_info.dst_rect = &dst_rect;
+        blit_info.dst_video_buffer = video_buffer;
+        return tig_art_blit(&blit_info);
+    }
+
+    // Blits art into video buffer filled with a gradient, either through
+    // frame video buffers or with art blits (using palette-indirect mode,
+    // which is never done through video buffers), and returns resulting
+    // pixels. `buffered` tells if frame video buffers were used.
+    static std::vector<uint32_t> blend(TigArtBlitInfo blit_info, bool palette_indirect, bool* buffered)
+    {
+        TigArtCacheStats stats;
+        TigVideoBuffer* video_buffer = create_video_buffer(64, 48);
+        TigVideoBufferData video_buffer_data;
+        TigRect rect = { 0, 0, 64, 48 };
+
+        EXPECT_EQ(tig_video_buffer_lock(video_buffer), TIG_OK);
+        EXPECT_EQ(tig_video_buffer_data(video_buffer, &video_buffer_data), TIG_OK);
+        for (int y = 0; y < rect.height; y++) {
+            uint32_t* row = (uint32_t*)(video_buffer_data.surface_data.p8 + video_buffer_data.pitch * y);
+            for (int x = 0; x < rect.width; x++) {
+                row[x] = ((x * 4) << 16) | ((y * 5) << 8) | (255 - x * 2);
+            }
+        }
+        tig_video_buffer_unlock(video_buffer);
+
+        tig_art_flush();
+        tig_art_cache_set_palette_indirect(palette_indirect);
+
+        blit_info.dst_video_buffer = video_buffer;
+        EXPECT_EQ(tig_art_blit(&blit_info), TIG_OK);
+
+        tig_art_cache_stats(&stats);
+        *buffered = stats.atlases != 0;
+
+        tig_art_cache_set_palette_indirect(false);
+
+        std::vector<uint32_t> result = pixels(video_buffer, rect);
+        tig_video_buffer_destroy(video_buffer);
+        return result;
+    }
+
+    static std::vector<uint32_t> pixels(TigVideoBuffer* video_buffer, const TigRect& rect)
+    {
+        std::vector<uint32_t> result;
+        TigVideoBufferData video_buffer_data;
+
+        EXPECT_EQ(tig_video_buffer_lock(video_buffer), TIG_OK);
+        EXPECT_EQ(tig_video_buffer_data(video_buffer, &video_buffer_data), TIG_OK);
+
+        for (int y = rect.y; y < rect.y + rect.height; y++) {
+            const uint32_t* row = (const uint32_t*)(video_buffer_data.surface_data.p8 + video_buffer_data.pitch * y);
+            for (int x = rect.x; x < rect.x + rect.width; x++) {
+                result.push_back(row[x] & 0xFFFFFF);
+            }
+        }
+
+        tig_video_buffer_unlock(video_buffer);
+
+        return result;
+    }
+
+    // Checks if the art is in the art cache.
+    static bool cached(unsigned int num)
+    {
+        char path[TIG_MAX_PATH];
+        resolve_path(interface_id(num), path);
+
+        return !tig_art_cache_enumerate(compare_path, path);
+    }
+
+    static bool compare_path(const TigArtCacheEntryInfo* info, void* context)
+    {
+        return strcmp(info->path, (const char*)context) != 0;
+    }
+
+    std::vector<std::string> paths;
+};
+
+// Opaque rectangle in the middle, shadow on the left edge and a transparent
+// hole which depends on the frame.
+static uint8_t hit_test_pixel(int frame, int x, int y)
+{
+    if (x == 0) {
+        return 1;
+    }
+
+    if (x < 4 || y < 2 || x >= 12 || y >= 10 || (x == 6 + frame && y == 5)) {
+        return 0;
+    }
+
+    return (uint8_t)(2 + (x + y) % 5);
+}
+
+TEST_F(TigArtCacheTest, HitTest)
+{
+    write_art(1, 2, 16, 12, hit_test_pixel);
+
+    for (int frame = 0; frame < 2; frame++) {
+        for (int y = 0; y < 12; y++) {
+            for (int x = 0; x < 16; x++) {
+                EXPECT_EQ(tig_art_hit_test(interface_id(1, frame), x, y) == TIG_OK, hit_test_pixel(frame, x, y) >= 2)
+                    << "frame " << frame << " at " << x << ", " << y;
+            }
+        }
+    }
+
+    // Frames beyond the art are never hit.
+    EXPECT_EQ(tig_art_hit_test(interface_id(1, 2), 5, 5), TIG_ERR_GENERIC);
+    EXPECT_EQ(tig_art_hit_test(interface_id(1, 31), 5, 5), TIG_ERR_GENERIC);
+}
+
+TEST_F(TigArtCacheTest, HitTestAfterEviction)
+{
+    TigArtCacheStats stats;
+
+    init(64 * 1024);
+    write_art(1, 2, 16, 12, hit_test_pixel);
+
+    std::vector<bool> before;
+    for (int y = 0; y < 12; y++) {
+        for (int x = 0; x < 16; x++) {
+            before.push_back(tig_art_hit_test(interface_id(1, 1), x, y) == TIG_OK);
+        }
+    }
+
+    evict_all(100, 16);
+    ASSERT_FALSE(cached(1));
+
+    tig_art_cache_reset_stats();
+
+    std::vector<bool> after;
+    for (int y = 0; y < 12; y++) {
+        for (int x = 0; x < 16; x++) {
+            after.push_back(tig_art_hit_test(interface_id(1, 1), x, y) == TIG_OK);
+        }
+    }
+
+    EXPECT_EQ(before, after);
+
+    // Masks are kept in the metadata index, so the art is not loaded again.
+    tig_art_cache_stats(&stats);
+    EXPECT_EQ(stats.misses, 0u);
+}
+
+TEST_F(TigArtCacheTest, HitTestDoesNotLoadArt)
+{
+    TigArtCacheStats stats;
+
+    write_art(1, 2, 16, 12, hit_test_pixel);
+
+    tig_art_cache_reset_stats();
+
+    for (int frame = 0; frame < 2; frame++) {
+        for (int y = 0; y < 12; y++) {
+            for (int x = 0; x < 16; x++) {
+                EXPECT_EQ(tig_art_hit_test(interface_id(1, frame), x, y) == TIG_OK, hit_test_pixel(frame, x, y) >= 2)
+                    << "frame " << frame << " at " << x << ", " << y;
+            }
+        }
+    }
+
+    // Cold art is answered from the metadata index.
+    tig_art_cache_stats(&stats);
+    EXPECT_EQ(stats.misses, 0u);
+    EXPECT_EQ(stats.entries, 0u);
+    EXPECT_FALSE(cached(1));
+}
+
+TEST_F(TigArtCacheTest, FramesShareEntryWithoutResetFunc)
+{
+    TigArtCacheStats stats;
+
+    init(0, nullptr);
+    write_art(1, 4, 8, 8, hit_test_pixel);
+
+    for (int palette = 0; palette < 2; palette++) {
+        for (int frame = 0; frame < 4; frame++) {
+            TigArtAnimData data;
+            EXPECT_EQ(tig_art_anim_data(interface_id(1, frame, palette), &data), TIG_OK);
+        }
+    }
+
+    // All frames and palettes are in the same art file.
+    tig_art_cache_stats(&stats);
+    EXPECT_EQ(stats.entries, 1);
+    EXPECT_EQ(stats.misses, 1u);
+}
+
+// Size of 32 bpp atlas (see `TigArtCacheStats::atlas_video_memory_usage`).
+static constexpr int kAtlasSize = 1024 * 1024 * 4;
+
+// Number of art written by `atlas_pixel`, so that frames of different art
+// differ.
+static unsigned int atlas_art_num;
+
+static uint8_t atlas_pixel(int frame, int x, int y)
+{
+    return (uint8_t)(1 + (x + 2 * y + frame + 7 * atlas_art_num) % 250);
+}
+
+TEST_F(TigArtCacheTest, AtlasesChargedPerAtlas)
+{
+    TigArtCacheStats stats;
+    TigVideoBuffer* video_buffer = create_video_buffer(128, 16);
+
+    for (unsigned int num = 1; num <= 8; num++) {
+        atlas_art_num = num;
+        write_art(num, 1, 16, 16, atlas_pixel);
+        ASSERT_EQ(blit(video_buffer, buffered_interface_id(num), (num - 1) * 16, 0), TIG_OK);
+    }
+
+    // Frames packed into atlas are not charged to their art.
+    tig_art_cache_stats(&stats);
+    EXPECT_EQ(stats.atlases, 1);
+    EXPECT_EQ(stats.atlas_video_memory_usage, kAtlasSize);
+    EXPECT_EQ(stats.video_memory_usage, kAtlasSize);
+    EXPECT_EQ(stats.video_memory_usage_by_type[TIG_ART_TYPE_INTERFACE], 0);
+
+    tig_art_flush();
+
+    tig_art_cache_stats(&stats);
+    EXPECT_EQ(stats.atlases, 0);
+    EXPECT_EQ(stats.atlas_video_memory_usage, 0);
+    EXPECT_EQ(stats.video_memory_usage, 0);
+
+    tig_video_buffer_destroy(video_buffer);
+}
+
+TEST_F(TigArtCacheTest, EvictionFreesEmptyAtlases)
+{
+    TigArtCacheStats stats;
+    TigVideoBuffer* video_buffer = create_video_buffer(256, 200);
+
+    // Two atlases take entire video memory of the cache.
+    init(2 * kAtlasSize);
+
+    // 20 frames fill the first atlas (5 shelves of 4 frames), the next one
+    // opens the second atlas.
+    for (unsigned int num = 1; num <= 22; num++) {
+        atlas_art_num = num;
+        write_art(num, 1, 256, 200, atlas_pixel);
+    }
+
+    for (unsigned int num = 1; num <= 21; num++) {
+        ASSERT_EQ(blit(video_buffer, buffered_interface_id(num), 0, 0), TIG_OK);
+    }
+
+    tig_art_cache_stats(&stats);
+    EXPECT_EQ(stats.atlases, 2);
+    EXPECT_EQ(stats.video_memory_usage, 2 * kAtlasSize);
+
+    // Art in the first atlas is evicted until the atlas is freed.
+    ASSERT_EQ(blit(video_buffer, interface_id(22), 0, 0), TIG_OK);
+
+    tig_art_cache_stats(&stats);
+    EXPECT_EQ(stats.atlases, 1);
+    EXPECT_EQ(stats.atlas_video_memory_usage, kAtlasSize);
+    EXPECT_FALSE(cached(1));
+    EXPECT_FALSE(cached(20));
+    EXPECT_TRUE(cached(21));
+    EXPECT_TRUE(cached(22));
+
+    tig_video_buffer_destroy(video_buffer);
+}
+
+TEST_F(TigArtCacheTest, AtlasReusesFreedSpace)
+{
+    TigArtCacheStats stats;
+    TigVideoBuffer* video_buffer = create_video_buffer(256, 256);
+
+    init(2 * kAtlasSize);
+
+    for (unsigned int num = 1; num <= 48; num++) {
+        atlas_art_num = num;
+        write_art(num, 2, 30 + (num * 37) % 227, 20 + (num * 53) % 181, atlas_pixel);
+    }
+
+    // Art is evicted in the order different from the order frames are placed
+    // into atlases, so that freed shelves are merged and split to frames of
+    // different heights. Frames which overlap in atlas would break frames
+    // of art blitted later.
+    for (int index = 0; index < 600; index++) {
+        unsigned int num = 1 + (index * 7 + index / 48) % 48;
+        int frame = index % 2;
+        TigArtFrameData frame_data;
+        ASSERT_EQ(tig_art_frame_data(buffered_interface_id(num, frame), &frame_data), TIG_OK);
+
+        TigRect rect = { 0, 0, frame_data.width, frame_data.height };
+        ASSERT_EQ(blit(video_buffer, buffered_interface_id(num, frame), 0, 0), TIG_OK);
+
+        std::vector<uint32_t> actual = pixels(video_buffer, rect);
+        atlas_art_num = num;
+        for (int y = 0; y < rect.height; y++) {
+            for (int x = 0; x < rect.width; x++) {
+                ASSERT_EQ(actual[y * rect.width + x], color(atlas_pixel(frame, x, y)))
+                    << "art " << num << " frame " << frame << " at " << x << ", " << y;
+            }
+        }
+
+        tig_art_cache_stats(&stats);
+        ASSERT_LE(stats.atlases, 2);
+        ASSERT_EQ(stats.atlas_video_memory_usage, stats.atlases * kAtlasSize);
+    }
+
+    tig_art_cache_stats(&stats);
+    EXPECT_GT(stats.evictions, 0u);
+
+    tig_art_flush();
+
+    tig_art_cache_stats(&stats);
+    EXPECT_EQ(stats.atlases, 0);
+
+    tig_video_buffer_destroy(video_buffer);
+}
+
+// Records blits of art 1-12 (two frames each) scattered over 256x256 video
+// buffer, so that consecutive blits are of different art.
+static void add_scattered_blits(int count)
+{
+    for (int index = 0; index < count; index++) {
+        unsigned int num = 1 + (index * 5) % 12;
+        tig_art_id_t art_id;
+        ASSERT_EQ(tig_art_interface_id_create(num, index % 2, 0, 0, &art_id), TIG_OK);
+
+        TigArtFrameData frame_data;
+        ASSERT_EQ(tig_art_frame_data(art_id, &frame_data), TIG_OK);
+
+        TigRect src_rect = { 0, 0, frame_data.width, frame_data.height };
+        TigRect dst_rect = { (index * 37) % 220, (index * 53) % 220, frame_data.width, frame_data.height };
+
+        TigArtBlitInfo blit_info = {};
+        blit_info.art_id = art_id;
+        blit_info.src_rect = &src_rect;
+        blit_info.dst_rect = &dst_rect;
+        ASSERT_EQ(tig_art_blit_list_add(&blit_info), TIG_OK);
+    }
+}
+
+TEST_F(TigArtCacheTest, BandedBlitListUnderEviction)
+{
+    TigArtCacheStats stats;
+    TigVideoBuffer* serial = create_video_buffer(256, 256);
+    TigVideoBuffer* banded = create_video_buffer(256, 256);
+    TigRect rect = { 0, 0, 256, 256 };
+
+    // The cache fits a few art, so lookups evict art of blits collected for
+    // bands.
+    init(48 * 1024);
+
+    for (unsigned int num = 1; num <= 12; num++) {
+        atlas_art_num = num;
+        write_art(num, 2, 20 + num * 3, 30 + num * 2, atlas_pixel);
+    }
+
+    ASSERT_EQ(tig_art_blit_list_begin(serial, 0), TIG_OK);
+    add_scattered_blits(200);
+    ASSERT_EQ(tig_art_blit_list_submit(), TIG_OK);
+
+    tig_art_cache_reset_stats();
+
+    ASSERT_EQ(tig_art_blit_list_begin(banded, TIG_ART_BLIT_LIST_BANDED), TIG_OK);
+    add_scattered_blits(200);
+    ASSERT_EQ(tig_art_blit_list_submit(), TIG_OK);
+
+    tig_art_cache_stats(&stats);
+    EXPECT_GT(stats.evictions, 0u);
+
+    EXPECT_EQ(pixels(serial, rect), pixels(banded, rect));
+
+    tig_video_buffer_destroy(banded);
+    tig_video_buffer_destroy(serial);
+}
+
+// Opaque rectangle which depends on the frame, surrounded by transparent
+// pixels.
+static uint8_t bounds_pixel(int frame, int x, int y)
+{
+    return x >= 3 + frame && x < 9 && y >= 2 && y < 7 - frame ? 5 : 0;
+}
+
+TEST_F(TigArtCacheTest, FrameBoundsDoNotDependOnCache)
+{
+    init(64 * 1024);
+    write_art(1, 2, 12, 10, bounds_pixel);
+
+    auto expect_bounds = [](const char* state) {
+        for (int frame = 0; frame < 2; frame++) {
+            TigArtFrameData frame_data;
+            ASSERT_EQ(tig_art_frame_data(interface_id(1, frame), &frame_data), TIG_OK);
+            EXPECT_EQ(frame_data.bounds.x, 3 + frame) << state;
+            EXPECT_EQ(frame_data.bounds.y, 2) << state;
+            EXPECT_EQ(frame_data.bounds.width, 6 - frame) << state;
+            EXPECT_EQ(frame_data.bounds.height, 5 - frame) << state;
+        }
+    };
+
+    // Not loaded.
+    expect_bounds("not loaded");
+    EXPECT_FALSE(cached(1));
+
+    // Loaded.
+    TigArtAnimData anim_data;
+    ASSERT_EQ(tig_art_anim_data(interface_id(1), &anim_data), TIG_OK);
+    ASSERT_TRUE(cached(1));
+    expect_bounds("loaded");
+
+    // Evicted.
+    evict_all(100, 16);
+    ASSERT_FALSE(cached(1));
+    expect_bounds("evicted");
+
+    // Flushed along with the metadata index.
+    tig_art_flush();
+    expect_bounds("flushed");
+}
+
+// Opaque pixels of all palette indices with transparent border and holes.
+static uint8_t blend_pixel(int frame, int x, int y)
+{
+    (void)frame;
+
+    if (x < 2 || y < 2 || x >= 22 || y >= 18 || (x + y) % 7 == 0) {
+        return 0;
+    }
+
+    return (uint8_t)(1 + (x * 13 + y * 29) % 255);
+}
+
+TEST_F(TigArtCacheTest, VideoBufferBlendsMatchArtBlits)
+{
+    static const unsigned int flags_tbl[] = {
+        0,
+        TIG_ART_BLT_FLIP_X,
+        TIG_ART_BLT_BLEND_ADD,
+        TIG_ART_BLT_BLEND_SUB,
+        TIG_ART_BLT_BLEND_MUL,
+        TIG_ART_BLT_BLEND_ALPHA_AVG,
+        TIG_ART_BLT_BLEND_ALPHA_CONST,
+        TIG_ART_BLT_BLEND_ALPHA_SRC,
+        TIG_ART_BLT_BLEND_COLOR_CONST,
+        TIG_ART_BLT_BLEND_COLOR_CONST | TIG_ART_BLT_BLEND_ALPHA_CONST,
+        TIG_ART_BLT_BLEND_ADD | TIG_ART_BLT_FLIP_X,
+    };
+
+    write_art(1, 1, 24, 20, blend_pixel);
+
+    TigRect src_rect = { 0, 0, 24, 20 };
+    TigRect dst_rect = { 30, 20, 24, 20 };
+
+    TigArtBlitInfo blit_info = {};
+    blit_info.art_id = buffered_interface_id(1);
+    blit_info.src_rect = &src_rect;
+    blit_info.dst_rect = &dst_rect;
+    blit_info.color = tig_color_make(200, 120, 40);
+    blit_info.alpha[0] = 100;
+
+    for (unsigned int flags : flags_tbl) {
+        bool buffered;
+        blit_info.flags = flags;
+
+        std::vector<uint32_t> expected = blend(blit_info, true, &buffered);
+        ASSERT_FALSE(buffered);
+
+        std::vector<uint32_t> actual = blend(blit_info, false, &buffered);
+        EXPECT_TRUE(buffered) << "flags " << std::hex << flags;
+        EXPECT_EQ(actual, expected) << "flags " << std::hex << flags;
+    }
+}
+
+TEST_F(TigArtCacheTest, StretchedBlendsMatchArtBlits)
+{
+    static const unsigned int flags_tbl[] = {
+        TIG_ART_BLT_BLEND_ADD,
+        TIG_ART_BLT_BLEND_ALPHA_CONST,
+        TIG_ART_BLT_BLEND_COLOR_CONST,
+    };
+
+    write_art(1, 1, 24, 20, blend_pixel);
+
+    TigRect src_rect = { 0, 0, 24, 20 };
+    TigRect dst_rect = { 5, 3, 41, 33 };
+
+    TigArtBlitInfo blit_info = {};
+    blit_info.art_id = buffered_interface_id(1);
+    blit_info.src_rect = &src_rect;
+    blit_info.dst_rect = &dst_rect;
+    blit_info.color = tig_color_make(200, 120, 40);
+    blit_info.alpha[0] = 100;
+
+    for (unsigned int flags : flags_tbl) {
+        bool buffered;
+        blit_info.flags = flags;
+
+        std::vector<uint32_t> expected = blend(blit_info, true, &buffered);
+        std::vector<uint32_t> actual = blend(blit_info, false, &buffered);
+        EXPECT_FALSE(buffered) << "flags " << std::hex << flags;
+        EXPECT_EQ(actual, expected) << "flags " << std::hex << flags;
+    }
+}
+
+// Palette of test art with opaque index 3 equal to the color key of frame
+// video buffers.
+static uint32_t color_key_palette(int index)
+{
+    return index == 3 ? 0x00FF00 : (uint32_t)((index << 16) | (index / 2));
+}
+
+static uint8_t color_key_pixel(int frame, int x, int y)
+{
+    (void)frame;
+
+    return (uint8_t)((x + y) % 4);
+}
+
+TEST_F(TigArtCacheTest, ColorKeyedPaletteMatchesArtBlits)
+{
+    write_art(1, 1, 16, 16, color_key_pixel, color_key_palette);
+
+    TigRect src_rect = { 0, 0, 16, 16 };
+    TigRect dst_rect = { 10, 10, 16, 16 };
+
+    TigArtBlitInfo blit_info = {};
+    blit_info.art_id = buffered_interface_id(1);
+    blit_info.src_rect = &src_rect;
+    blit_info.dst_rect = &dst_rect;
+
+    bool buffered;
+    std::vector<uint32_t> expected = blend(blit_info, true, &buffered);
+    std::vector<uint32_t> actual = blend(blit_info, false, &buffered);
+    EXPECT_FALSE(buffered);
+    EXPECT_EQ(actual, expected);
+
+    // Pixel (3, 0) of the art has index 3.
+    EXPECT_EQ(actual[10 * 64 + 13], 0x00FF00u);
+}
+
+// Records blit of 16x16 art at `x`, `y`.
+static void add_blit(unsigned int num, int x, int y)
+{
+    tig_art_id_t art_id;
+    ASSERT_EQ(tig_art_interface_id_create(num, 0, 0, 0, &art_id), TIG_OK);
+
+    TigRect src_rect = { 0, 0, 16, 16 };
+    TigRect dst_rect = { x, y, 16, 16 };
+
+    TigArtBlitInfo blit_info = {};
+    blit_info.art_id = art_id;
+    blit_info.src_rect = &src_rect;
+    blit_info.dst_rect = &dst_rect;
+    ASSERT_EQ(tig_art_blit_list_add(&blit_info), TIG_OK);
+}
+
+TEST_F(TigArtCacheTest, BlitListKeepsOrder)
+{
+    // Overlapping blits of art 1, 1, 2, 3, 3, 1.
+    static const unsigned int nums[] = { 1, 1, 2, 3, 3, 1 };
+
+    TigArtCacheStats stats;
+    TigVideoBuffer* direct = create_video_buffer(64, 32);
+    TigVideoBuffer* listed = create_video_buffer(64, 32);
+    TigRect rect = { 0, 0, 64, 32 };
+
+    for (unsigned int num = 1; num <= 3; num++) {
+        atlas_art_num = num;
+        write_art(num, 1, 16, 16, atlas_pixel);
+    }
+
+    for (int index = 0; index < 6; index++) {
+        ASSERT_EQ(blit(direct, interface_id(nums[index]), index * 6, index * 3), TIG_OK);
+    }
+
+    tig_art_cache_reset_stats();
+
+    ASSERT_EQ(tig_art_blit_list_begin(listed, 0), TIG_OK);
+    for (int index = 0; index < 6; index++) {
+        add_blit(nums[index], index * 6, index * 3);
+    }
+    ASSERT_EQ(tig_art_blit_list_submit(), TIG_OK);
+
+    // Consecutive blits of the same art share one lookup.
+    tig_art_cache_stats(&stats);
+    EXPECT_EQ(stats.lookups, 4u);
+
+    EXPECT_EQ(pixels(listed, rect), pixels(direct, rect));
+
+    tig_video_buffer_destroy(listed);
+    tig_video_buffer_destroy(direct);
+}
+
+TEST_F(TigArtCacheTest, UnorderedBlitListGroupsArt)
+{
+    TigArtCacheStats stats;
+    TigVideoBuffer* direct = create_video_buffer(128, 32);
+    TigVideoBuffer* listed = create_video_buffer(128, 32);
+    TigRect rect = { 0, 0, 128, 32 };
+
+    for (unsigned int num = 1; num <= 3; num++) {
+        atlas_art_num = num;
+        write_art(num, 1, 16, 16, atlas_pixel);
+    }
+
+    // Blits do not overlap, so their order does not matter.
+    for (int index = 0; index < 12; index++) {
+        ASSERT_EQ(blit(direct, interface_id(1 + index % 3), (index % 8) * 16, (index / 8) * 16), TIG_OK);
+    }
+
+    tig_art_cache_reset_stats();
+
+    ASSERT_EQ(tig_art_blit_list_begin(listed, TIG_ART_BLIT_LIST_UNORDERED), TIG_OK);
+    for (int index = 0; index < 12; index++) {
+        add_blit(1 + index % 3, (index % 8) * 16, (index / 8) * 16);
+    }
+    ASSERT_EQ(tig_art_blit_list_submit(), TIG_OK);
+
+    // All blits of the same art share one lookup.
+    tig_art_cache_stats(&stats);
+    EXPECT_EQ(stats.lookups, 3u);
+
+    EXPECT_EQ(pixels(listed, rect), pixels(direct, rect));
+
+    tig_video_buffer_destroy(listed);
+    tig_video_buffer_destroy(direct);
+}
+
+TEST_F(TigArtCacheTest, BlitListCullsBlitsOutsideDestination)
+{
+    TigArtCacheStats stats;
+    TigVideoBuffer* video_buffer = create_video_buffer(64, 32);
+    TigRect rect = { 0, 0, 64, 32 };
+
+    for (unsigned int num = 1; num <= 2; num++) {
+        atlas_art_num = num;
+        write_art(num, 1, 16, 16, atlas_pixel);
+    }
+
+    std::vector<uint32_t> before = pixels(video_buffer, rect);
+
+    ASSERT_EQ(tig_art_blit_list_begin(video_buffer, 0), TIG_OK);
+    add_blit(1, -16, 0);
+    add_blit(1, 64, 10);
+    add_blit(1, 20, -16);
+    add_blit(1, 20, 32);
+    add_blit(2, -15, -15);
+    ASSERT_EQ(tig_art_blit_list_submit(), TIG_OK);
+
+    // Only the blit which touches the corner needs its art.
+    tig_art_cache_stats(&stats);
+    EXPECT_EQ(stats.lookups, 1u);
+    EXPECT_FALSE(cached(1));
+    EXPECT_TRUE(cached(2));
+
+    std::vector<uint32_t> after = pixels(video_buffer, rect);
+    EXPECT_EQ(after[0], color(atlas_pixel(0, 15, 15)));
+    EXPECT_TRUE(std::equal(after.begin() + 1, after.end(), before.begin() + 1));
+
+    tig_video_buffer_destroy(video_buffer);
+}
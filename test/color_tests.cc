@@ -1218,3 +1218,87 @@ TEST_F(TigColorTestRGB888, BlendAlpha)
 
     ASSERT_EQ(tig_color_blend_alpha(src, dst, 128), tig_color_make(80, 0, 0));
 }
+
+// Checks that batch operators produce exactly the same results as scalar
+// ones, including leftover pixels which do not fill complete vector.
+static void expect_batch_matches_scalar()
+{
+    const int n = 259;
+    const int alphas[] = { 0, 1, 64, 127, 128, 255, 256 };
+    tig_color_t src[n];
+    tig_color_t dst[n];
+    tig_color_t actual[n];
+    unsigned int seed = 1;
+
+    for (int index = 0; index < n; index++) {
+        seed = seed * 1103515245 + 12345;
+        src[index] = tig_color_make(seed & 0xFF, (seed >> 8) & 0xFF, (seed >> 16) & 0xFF);
+        seed = seed * 1103515245 + 12345;
+        dst[index] = tig_color_make(seed & 0xFF, (seed >> 8) & 0xFF, (seed >> 16) & 0xFF);
+    }
+
+    // Extremes of every component.
+    src[0] = tig_color_make(255, 255, 255);
+    dst[0] = tig_color_make(0, 0, 0);
+    src[1] = tig_color_make(0, 0, 0);
+    dst[1] = tig_color_make(255, 255, 255);
+
+    memcpy(actual, dst, sizeof(dst));
+    tig_color_add_n(actual, src, n);
+    for (int index = 0; index < n; index++) {
+        ASSERT_EQ(actual[index], tig_color_add(src[index], dst[index])) << "index " << index;
+    }
+
+    memcpy(actual, dst, sizeof(dst));
+    tig_color_sub_n(actual, src, n);
+    for (int index = 0; index < n; index++) {
+        ASSERT_EQ(actual[index], tig_color_sub(src[index], dst[index])) << "index " << index;
+    }
+
+    memcpy(actual, dst, sizeof(dst));
+    tig_color_mul_n(actual, src, n);
+    for (int index = 0; index < n; index++) {
+        ASSERT_EQ(actual[index], tig_color_mul(src[index], dst[index])) << "index " << index;
+    }
+
+    for (int alpha : alphas) {
+        memcpy(actual, dst, sizeof(dst));
+        tig_color_blend_alpha_n(actual, src, alpha, n);
+        for (int index = 0; index < n; index++) {
+            ASSERT_EQ(actual[index], tig_color_blend_alpha(src[index], dst[index], alpha)) << "index " << index << ", alpha " << alpha;
+        }
+    }
+}
+
+// Batch operators must produce exactly the same results as scalar ones.
+TEST_F(TigColorTestRGB888, BatchMatchesScalar)
+{
+    expect_batch_matches_scalar();
+}
+
+// 32 bpp mode with red in the top byte.
+class TigColorTestRGBA8888 : public TigColorTest {
+protected:
+    void SetUp() override
+    {
+        TigColorTest::SetUp();
+
+        TigInitInfo init_info;
+        init_info.bpp = 32;
+
+        ASSERT_EQ(tig_color_init(&init_info), TIG_OK);
+        ASSERT_EQ(tig_color_set_rgb_settings(0xFF000000, 0xFF0000, 0xFF00), TIG_OK);
+    }
+
+    void TearDown() override
+    {
+        tig_color_exit();
+
+        TigColorTest::TearDown();
+    }
+};
+
+TEST_F(TigColorTestRGBA8888, BatchMatchesScalar)
+{
+    expect_batch_matches_scalar();
+}
@@ -1,6 +1,13 @@
 #include "tig/database.h"
 
+#include <stdio.h>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
 #include <gtest/gtest.h>
+#include <zlib.h>
 
 #include "tig/memory.h"
 
@@ -133,3 +140,165 @@ TEST_F(TigDatabaseTest, FindFile)
 
     tig_database_close(database);
 }
+
+// Database written by the test itself, with plain and compressed entries.
+class TigDatabaseWrittenTest : public testing::Test {
+protected:
+    void SetUp() override
+    {
+        ASSERT_EQ(tig_memory_init(nullptr), 0);
+
+        path = testing::TempDir() + "tig_database_test.dat";
+    }
+
+    void TearDown() override
+    {
+        remove(path.c_str());
+
+        ASSERT_TRUE(tig_memory_validate_memory_leaks());
+        tig_memory_exit();
+    }
+
+    // Contents of the specified entry, large enough to take several
+    // decompression buffers.
+    static std::vector<unsigned char> contents(int index)
+    {
+        std::vector<unsigned char> data(40000 + index * 1000);
+        for (size_t pos = 0; pos < data.size(); pos++) {
+            data[pos] = (unsigned char)((pos * (index + 3) + pos / 251) % 256);
+        }
+        return data;
+    }
+
+    static std::string name(int index)
+    {
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), "art\\file%02d.art", index);
+        return buffer;
+    }
+
+    // Writes database with the specified number of entries, odd entries are
+    // compressed.
+    void write(int count)
+    {
+        FILE* stream = fopen(path.c_str(), "wb");
+        ASSERT_NE(stream, nullptr);
+
+        std::vector<int> offsets;
+        std::vector<int> compressed_sizes;
+        int data_size = 0;
+        for (int index = 0; index < count; index++) {
+            std::vector<unsigned char> data = contents(index);
+            if (index % 2 != 0) {
+                uLongf size = compressBound(data.size());
+                std::vector<unsigned char> compressed(size);
+                ASSERT_EQ(compress(compressed.data(), &size, data.data(), data.size()), Z_OK);
+                compressed.resize(size);
+                data = compressed;
+            }
+
+            fwrite(data.data(), 1, data.size(), stream);
+            offsets.push_back(data_size);
+            compressed_sizes.push_back((int)data.size());
+            data_size += (int)data.size();
+        }
+
+        // Entry offsets are biased by the difference between data size and
+        // entry table size, which makes them absolute.
+        int entry_table_size = data_size + 4;
+        fwrite(&entry_table_size, sizeof(entry_table_size), 1, stream);
+        fwrite(&count, sizeof(count), 1, stream);
+
+        int name_table_size = 0;
+        for (int index = 0; index < count; index++) {
+            std::string entry_name = name(index);
+            int name_size = (int)entry_name.size() + 1;
+            int unused = 0;
+            unsigned int flags = index % 2 != 0 ? TIG_DATABASE_ENTRY_COMPRESSED : TIG_DATABASE_ENTRY_PLAIN;
+            int size = (int)contents(index).size();
+
+            fwrite(&name_size, sizeof(name_size), 1, stream);
+            fwrite(entry_name.c_str(), 1, name_size, stream);
+            fwrite(&unused, sizeof(unused), 1, stream);
+            fwrite(&flags, sizeof(flags), 1, stream);
+            fwrite(&size, sizeof(size), 1, stream);
+            fwrite(&compressed_sizes[index], sizeof(compressed_sizes[index]), 1, stream);
+            fwrite(&offsets[index], sizeof(offsets[index]), 1, stream);
+
+            name_table_size += name_size;
+        }
+
+        int id = ' ' | ('T' << 8) | ('A' << 16) | ('D' << 24);
+        int entry_table_offset = (int)ftell(stream) + 12 - 4 - data_size;
+        fwrite(&id, sizeof(id), 1, stream);
+        fwrite(&name_table_size, sizeof(name_table_size), 1, stream);
+        fwrite(&entry_table_offset, sizeof(entry_table_offset), 1, stream);
+
+        fclose(stream);
+    }
+
+    std::string path;
+};
+
+TEST_F(TigDatabaseWrittenTest, ParallelRead)
+{
+    const int kEntries = 8;
+    const int kThreads = 4;
+
+    write(kEntries);
+
+    TigDatabase* database = tig_database_open(path.c_str());
+    ASSERT_NE(database, nullptr);
+    ASSERT_EQ(database->entries_count, (unsigned int)kEntries);
+
+    // Opening and closing files is serialized by the caller (see
+    // `tig_file_fopen`), reading is not.
+    std::mutex mutex;
+    std::vector<int> failures(kThreads);
+    std::vector<std::thread> threads;
+
+    for (int thread = 0; thread < kThreads; thread++) {
+        threads.emplace_back([&, thread]() {
+            for (int iteration = 0; iteration < 10; iteration++) {
+                int index = (thread + iteration) % kEntries;
+                std::vector<unsigned char> expected = contents(index);
+                std::vector<unsigned char> actual(expected.size());
+                int middle = (int)expected.size() / 2;
+
+                TigDatabaseFileHandle* stream;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    stream = tig_database_fopen(database, name(index).c_str(), "rb");
+                }
+
+                if (stream == nullptr) {
+                    failures[thread]++;
+                    continue;
+                }
+
+                // Seeking forward skips compressed data, seeking back restarts
+                // decompression.
+                if (tig_database_fseek(stream, middle, SEEK_SET) != 0
+                    || tig_database_fread(actual.data() + middle, 1, expected.size() - middle, stream) != expected.size() - middle
+                    || tig_database_fseek(stream, 0, SEEK_SET) != 0
+                    || tig_database_fread(actual.data(), 1, middle, stream) != (size_t)middle
+                    || actual != expected) {
+                    failures[thread]++;
+                }
+
+                std::lock_guard<std::mutex> lock(mutex);
+                tig_database_fclose(stream);
+            }
+        });
+    }
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    for (int thread = 0; thread < kThreads; thread++) {
+        EXPECT_EQ(failures[thread], 0) << "thread " << thread;
+    }
+
+    tig_database_close(database);
+}
@@ -91,3 +91,92 @@ TEST_F(TigPaletteTest, ModifyTint)
     tig_palette_destroy(src_palette);
     tig_palette_destroy(dst_palette);
 }
+
+TEST_F(TigPaletteTest, AcquireShares)
+{
+    TigPalette palette = tig_palette_create();
+    tig_palette_fill(palette, tig_color_make(64, 128, 192));
+
+    TigPalette shared1 = tig_palette_acquire(palette);
+    TigPalette shared2 = tig_palette_acquire(palette);
+    EXPECT_NE(shared1, palette);
+    EXPECT_EQ(shared1, shared2);
+
+    tig_palette_fill(palette, tig_color_make(192, 128, 64));
+    TigPalette shared3 = tig_palette_acquire(palette);
+    EXPECT_NE(shared3, shared1);
+    EXPECT_EQ(((uint16_t*)shared1)[0], tig_color_make(64, 128, 192));
+    EXPECT_EQ(((uint16_t*)shared3)[0], tig_color_make(192, 128, 64));
+
+    tig_palette_release(shared1);
+    tig_palette_release(shared2);
+    tig_palette_release(shared3);
+    tig_palette_destroy(palette);
+}
+
+TEST_F(TigPaletteTest, AcquireRgb)
+{
+    uint32_t colors[256];
+    for (int index = 0; index < 256; index++) {
+        colors[index] = (index << 16) | ((255 - index) << 8) | (index / 2);
+    }
+
+    TigPalette shared1 = tig_palette_acquire_rgb(colors);
+    for (int index = 0; index < 256; index++) {
+        ASSERT_EQ(((uint16_t*)shared1)[index], tig_color_index_of(colors[index]));
+    }
+
+    // Same colors, as well as colors which are indistinguishable in 16 bpp,
+    // result in the same palette.
+    TigPalette shared2 = tig_palette_acquire_rgb(colors);
+    colors[0] ^= 1;
+    TigPalette shared3 = tig_palette_acquire_rgb(colors);
+    EXPECT_EQ(shared1, shared2);
+    EXPECT_EQ(shared1, shared3);
+
+    TigPalette shared4 = tig_palette_acquire(shared1);
+    EXPECT_EQ(shared1, shared4);
+
+    tig_palette_release(shared1);
+    tig_palette_release(shared2);
+    tig_palette_release(shared3);
+    tig_palette_release(shared4);
+
+    // Released palettes are no longer shared.
+    TigPalette shared5 = tig_palette_acquire_rgb(colors);
+    EXPECT_EQ(((uint16_t*)shared5)[0], tig_color_index_of(colors[0]));
+    tig_palette_release(shared5);
+}
+
+TEST_F(TigPaletteTest, AcquireRgbKeysReleased)
+{
+    uint32_t colors1[256];
+    uint32_t colors2[256];
+    for (int index = 0; index < 256; index++) {
+        colors1[index] = (index << 16) | ((255 - index) << 8) | (index / 2);
+        colors2[index] = colors1[index] ^ 1;
+    }
+
+    // Both colors are remembered by the same shared palette.
+    TigPalette shared1 = tig_palette_acquire_rgb(colors1);
+    TigPalette shared2 = tig_palette_acquire_rgb(colors2);
+    TigPalette shared3 = tig_palette_acquire_rgb(colors2);
+    EXPECT_EQ(shared1, shared2);
+    EXPECT_EQ(shared1, shared3);
+
+    tig_palette_release(shared1);
+    tig_palette_release(shared2);
+    tig_palette_release(shared3);
+
+    // Neither of the colors refers to the released palette.
+    for (int index = 0; index < 256; index++) {
+        colors1[index] = 0xFF0000;
+    }
+    TigPalette shared4 = tig_palette_acquire_rgb(colors1);
+    TigPalette shared5 = tig_palette_acquire_rgb(colors2);
+    EXPECT_NE(shared4, shared5);
+    EXPECT_EQ(((uint16_t*)shared4)[1], tig_color_index_of(0xFF0000));
+    EXPECT_EQ(((uint16_t*)shared5)[1], tig_color_index_of(colors2[1]));
+    tig_palette_release(shared4);
+    tig_palette_release(shared5);
+}
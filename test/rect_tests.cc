@@ -486,3 +486,123 @@ TEST(TigLineTest, LineBoundingBoxPositive)
     EXPECT_EQ(b.width, 10);
     EXPECT_EQ(b.height, 10);
 }
+
+class TigDirtyRectsTest : public testing::Test {
+protected:
+    void SetUp() override
+    {
+        TigRect bounds = { 0, 0, 100, 100 };
+        tig_dirty_rects_init(&dirty_rects, &bounds, 50);
+    }
+
+    void add(int x, int y, int width, int height)
+    {
+        TigRect rect = { x, y, width, height };
+        tig_dirty_rects_add(&dirty_rects, &rect);
+    }
+
+    TigDirtyRects dirty_rects;
+};
+
+TEST_F(TigDirtyRectsTest, DisjointRectsAreKept)
+{
+    add(0, 0, 10, 10);
+    add(10, 0, 10, 10);
+    add(50, 50, 5, 5);
+
+    ASSERT_FALSE(dirty_rects.full);
+    ASSERT_EQ(dirty_rects.count, 3);
+    EXPECT_EQ(dirty_rects.area, 225);
+}
+
+TEST_F(TigDirtyRectsTest, OverlappingRectsAreMerged)
+{
+    add(0, 0, 10, 10);
+    add(5, 5, 10, 10);
+
+    ASSERT_FALSE(dirty_rects.full);
+    ASSERT_EQ(dirty_rects.count, 1);
+    EXPECT_EQ(dirty_rects.rects[0].x, 0);
+    EXPECT_EQ(dirty_rects.rects[0].y, 0);
+    EXPECT_EQ(dirty_rects.rects[0].width, 15);
+    EXPECT_EQ(dirty_rects.rects[0].height, 15);
+    EXPECT_EQ(dirty_rects.area, 225);
+}
+
+TEST_F(TigDirtyRectsTest, MergedRectIsMergedAgain)
+{
+    // The union of the last two rects covers the first one, which does not
+    // overlap the last rect itself.
+    add(0, 10, 5, 3);
+    add(0, 15, 12, 5);
+    add(10, 10, 10, 10);
+
+    ASSERT_FALSE(dirty_rects.full);
+    ASSERT_EQ(dirty_rects.count, 1);
+    EXPECT_EQ(dirty_rects.rects[0].x, 0);
+    EXPECT_EQ(dirty_rects.rects[0].y, 10);
+    EXPECT_EQ(dirty_rects.rects[0].width, 20);
+    EXPECT_EQ(dirty_rects.rects[0].height, 10);
+    EXPECT_EQ(dirty_rects.area, 200);
+}
+
+TEST_F(TigDirtyRectsTest, RectsAreClippedToBounds)
+{
+    add(-5, -5, 10, 10);
+    add(100, 0, 10, 10);
+    add(0, -20, 10, 10);
+
+    ASSERT_EQ(dirty_rects.count, 1);
+    EXPECT_EQ(dirty_rects.rects[0].x, 0);
+    EXPECT_EQ(dirty_rects.rects[0].y, 0);
+    EXPECT_EQ(dirty_rects.rects[0].width, 5);
+    EXPECT_EQ(dirty_rects.rects[0].height, 5);
+}
+
+TEST_F(TigDirtyRectsTest, TooManyRectsMakeFull)
+{
+    for (int index = 0; index < TIG_DIRTY_RECTS_MAX; index++) {
+        add((index % 16) * 6, (index / 16) * 6, 1, 1);
+    }
+
+    ASSERT_FALSE(dirty_rects.full);
+    ASSERT_EQ(dirty_rects.count, TIG_DIRTY_RECTS_MAX);
+
+    // Overlapping rect still fits.
+    add(0, 0, 1, 1);
+    ASSERT_FALSE(dirty_rects.full);
+
+    add(99, 99, 1, 1);
+    EXPECT_TRUE(dirty_rects.full);
+}
+
+TEST_F(TigDirtyRectsTest, CoverageThresholdMakesFull)
+{
+    // Exactly half of the bounds.
+    add(0, 0, 50, 100);
+    ASSERT_FALSE(dirty_rects.full);
+
+    add(50, 0, 1, 1);
+    EXPECT_TRUE(dirty_rects.full);
+}
+
+TEST_F(TigDirtyRectsTest, NullMakesFull)
+{
+    add(0, 0, 10, 10);
+    tig_dirty_rects_add(&dirty_rects, NULL);
+    EXPECT_TRUE(dirty_rects.full);
+}
+
+TEST_F(TigDirtyRectsTest, Clear)
+{
+    add(0, 0, 10, 10);
+    tig_dirty_rects_add(&dirty_rects, NULL);
+    tig_dirty_rects_clear(&dirty_rects);
+
+    EXPECT_FALSE(dirty_rects.full);
+    EXPECT_EQ(dirty_rects.count, 0);
+    EXPECT_EQ(dirty_rects.area, 0);
+
+    add(0, 0, 10, 10);
+    EXPECT_EQ(dirty_rects.count, 1);
+}